@@ -2,6 +2,7 @@
 #define AXIS_HELPER_H
 
 #include "ini.h"
+#include "drive_pool.h"
 #include<stddef.h>
 
 /* Axis identifier */
@@ -13,17 +14,17 @@ typedef enum
 } Axis_t;
 
 /* -------------------------------------------------------
- * Get axis configuration from config.ini
+ * Get axis configuration of the selected drive from config.ini
  * ------------------------------------------------------- */
 static inline AXIS_CONFIG *GetAxisCfg(Axis_t axis)
 {
     switch (axis)
     {
         case AXIS_TILT:
-            return &axis1_cfg;   /* PAN */
+            return POOL_AxisMap(1);   /* PAN */
 
         case AXIS_PAN:
-            return &axis2_cfg;   /* TILT */
+            return POOL_AxisMap(2);   /* TILT */
 
         default:
             return NULL;         /* Invalid axis */
@@ -0,0 +1,563 @@
+/*
+ * bench.c - micro-benchmarks for LCU hot paths
+ *
+ * Build:  make bench
+ * Run:    bin/bench.exe [suite]      (no argument = all suites)
+ */
+#include "platform.h"
+#include "modbus_crc.h"
+#include "latency_hist.h"
+#include "signal_codec.h"
+#include "telemetry_bin.h"
+#include "json_writer.h"
+#include "cJSON.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Keeps results alive so the compiler cannot drop the work */
+static volatile uint32_t bench_sink;
+
+static void bench_report(const char *name, uint64_t elapsed_us,
+                         uint32_t iterations, size_t bytes_per_iter)
+{
+    double ns_per_iter = (double)elapsed_us * 1000.0 / (double)iterations;
+    double mb_per_s = 0.0;
+
+    if (elapsed_us > 0)
+        mb_per_s = ((double)bytes_per_iter * iterations) / (double)elapsed_us;
+
+    printf("  %-28s %10.1f ns/op %10.1f MB/s\n", name, ns_per_iter, mb_per_s);
+}
+
+/*----------------------------------------------------------
+ * CRC16: bitwise loop vs table vs slice-by-8
+ *----------------------------------------------------------*/
+typedef uint16_t (*crc_fn_t)(const uint8_t *, size_t);
+
+static void bench_crc_one(const char *name, crc_fn_t fn,
+                          const uint8_t *frame, size_t len, uint32_t iterations)
+{
+    uint32_t acc = 0;
+    uint64_t t0 = PLAT_TimeUs();
+
+    for (uint32_t i = 0; i < iterations; i++)
+        acc += fn(frame, len);
+
+    bench_report(name, PLAT_TimeUs() - t0, iterations, len);
+    bench_sink = acc;
+}
+
+static void bench_crc(void)
+{
+    /* 9 bytes = 2-register reply, 255 bytes = 125-register block read */
+    static const size_t sizes[] = { 6U, 9U, 29U, 255U };
+    uint8_t frame[256];
+
+    MODBUS_CRC_Init();
+    for (size_t i = 0; i < sizeof(frame); i++)
+        frame[i] = (uint8_t)(i * 31U + 7U);
+
+    printf("[CRC16]\n");
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+        size_t len = sizes[s];
+        uint32_t iterations = (uint32_t)(64U * 1024U * 1024U / len);
+
+        if (MODBUS_CRC16_Bitwise(frame, len) != MODBUS_CRC16_Slice8(frame, len))
+        {
+            printf("  CRC variants disagree at len=%u!\n", (unsigned)len);
+            return;
+        }
+
+        printf(" frame %u bytes\n", (unsigned)len);
+        bench_crc_one("bitwise",    MODBUS_CRC16_Bitwise, frame, len, iterations);
+        bench_crc_one("table",      MODBUS_CRC16_Table,   frame, len, iterations);
+        bench_crc_one("slice-by-8", MODBUS_CRC16_Slice8,  frame, len, iterations);
+    }
+}
+
+/*----------------------------------------------------------
+ * Latency histogram: cost of one record, percentile accuracy
+ *----------------------------------------------------------*/
+static void bench_hist(void)
+{
+    static HIST_t h;
+    static HIST_Snapshot_t snap;
+    const uint32_t iterations = 16U * 1024U * 1024U;
+    uint32_t x = 0x2545F491U;
+
+    printf("[HIST]\n");
+
+    /* spread of 1 us .. 1 s, like real replies plus timeouts */
+    uint64_t t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        HIST_Add(&h, x >> (12U + (x & 7U)));
+    }
+    bench_report("HIST_Add", PLAT_TimeUs() - t0, iterations, 0);
+
+    /* what the engine does per transaction: two series */
+    t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        HIST_Record((i & 1U) ? 0x03 : 0x04, (uint16_t)(282U + (i & 3U) * 130U),
+                    x >> 20, 0);
+    }
+    bench_report("HIST_Record", PLAT_TimeUs() - t0, iterations, 0);
+    HIST_Snapshot(&snap);
+
+    /* bucket error: uniform 1000..1999 us, p50 should be ~1500 */
+    memset(&h, 0, sizeof(h));
+    for (uint32_t v = 1000U; v < 2000U; v++)
+        HIST_Add(&h, v);
+    printf("  uniform 1000..1999 us: p50=%u p90=%u p99=%u max=%u\n",
+           HIST_Percentile(&h, 50.0), HIST_Percentile(&h, 90.0),
+           HIST_Percentile(&h, 99.0), h.max_us);
+    bench_sink = snap.func_count;
+}
+
+/*----------------------------------------------------------
+ * Signal codec: one block reply into a snapshot
+ *----------------------------------------------------------*/
+static void bench_codec_one(const char *name, uint32_t signals)
+{
+    static DriveSnapshot_t snap;
+    ReadPlan_t plan;
+    uint8_t reply[PLAN_MAX_REGS * 2U];
+    const uint8_t *data[1] = { reply };
+    const uint32_t iterations = 4U * 1024U * 1024U;
+    uint16_t regs = 0;
+
+    /* every signal back to back in one block, as the planner lays
+     * out a contiguous register map */
+    memset(&plan, 0, sizeof(plan));
+    plan.signals     = signals;
+    plan.block_count = 1;
+    for (int s = 0; s < SIG_COUNT; s++)
+    {
+        if (!(signals & SIG_MASK(s)))
+            continue;
+        plan.sig_block[s]  = 0;
+        plan.sig_offset[s] = regs;
+        regs = (uint16_t)(regs + CODEC_Describe((Signal_t)s)->regs);
+    }
+    plan.blocks[0].func  = 0x04;
+    plan.blocks[0].count = regs;
+
+    for (size_t i = 0; i < sizeof(reply); i++)
+        reply[i] = (uint8_t)(i * 13U + 1U);
+
+    uint64_t t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        reply[1] = (uint8_t)i;
+        snap.valid = 0;
+        CODEC_Decode(&plan, data, &snap);
+    }
+    bench_report(name, PLAT_TimeUs() - t0, iterations, regs * 2U);
+    bench_sink = snap.valid;
+}
+
+static void bench_codec(void)
+{
+    printf("[CODEC]\n");
+    bench_codec_one("continuous set", SIGSET_CONTINUOUS);
+    bench_codec_one("periodic set",   SIGSET_PERIODIC);
+    bench_codec_one("all signals",    SIG_MASK(SIG_COUNT) - 1U);
+}
+
+/*----------------------------------------------------------
+ * Telemetry encoding: JSON text vs CBOR, per message
+ *----------------------------------------------------------*/
+static void bench_tlm_sample(TLM_Msg_t *msg, TLM_Kind_t kind)
+{
+    memset(msg, 0, sizeof(*msg));
+    msg->kind = (uint8_t)kind;
+    msg->axis = 2;
+    snprintf(msg->drive, sizeof(msg->drive), "MAST");
+
+    if (kind == TLM_KIND_CONTINUOUS)
+    {
+        msg->values[SIG_ABS_POSITION] = 1234.56;
+        msg->values[SIG_POS_DEG]      = 87.25;
+        msg->values[SIG_POS_MM]       = 1234.5;
+        msg->values[SIG_RPM]          = 1450.0;
+        msg->values[SIG_IO_STATUS]    = 0x0013;
+        msg->present = SIGSET_CONTINUOUS;
+        return;
+    }
+
+    msg->has      |= TLM_HAS_CONNECTED | TLM_HAS_FAULTS;
+    msg->connected = 1;
+    msg->faults    = 0x2002;
+    msg->values[SIG_CURRENT]      = 3.27;
+    msg->values[SIG_DCBUS_VOLT]   = 48.0;
+    msg->values[SIG_FAULT_STATUS] = 0x0002;
+    msg->present = SIGSET_PERIODIC;
+    for (int m = 0; m < TLM_META_COUNT; m++)
+        msg->meta[m] = (m == TLM_META_SYSCALLS_PER_CYCLE) ? 1.5 : 100.0 * m + 17.0;
+    msg->meta_present = (1U << TLM_META_COUNT) - 1U;
+}
+
+/* The tree telemetry.c built for the message before it moved to
+ * the streaming writer; 'out' (optional) receives the text */
+static size_t bench_tlm_json(const TLM_Msg_t *msg, char *out, size_t cap)
+{
+    cJSON *root = cJSON_CreateObject();
+    cJSON *obj  = root;
+    size_t len  = 0;
+
+    if (msg->kind == TLM_KIND_PERIODIC)
+    {
+        cJSON_AddNumberToObject(root, "v", 1);
+        cJSON_AddStringToObject(root, "id", "periodic");
+        cJSON_AddStringToObject(root, "type", "Event");
+        cJSON_AddStringToObject(root, "name", "TelemetryPeriodic");
+        cJSON_AddStringToObject(root, "src", "middleware");
+        obj = cJSON_AddObjectToObject(root, "body");
+        cJSON_AddBoolToObject(obj, "drive_connected", msg->connected);
+    }
+    else
+        cJSON_AddStringToObject(root, "type", "continuous");
+
+    cJSON_AddStringToObject(obj, "drive", msg->drive);
+    cJSON_AddNumberToObject(obj, "axis", msg->axis);
+    for (uint32_t todo = msg->present; todo; todo &= todo - 1U)
+    {
+        int sig = __builtin_ctz(todo);
+        cJSON_AddNumberToObject(obj, CODEC_Describe((Signal_t)sig)->name,
+                                msg->values[sig]);
+    }
+
+    if (msg->has & TLM_HAS_FAULTS)
+    {
+        cJSON *bits = cJSON_AddObjectToObject(obj, "fault_bits");
+        for (int i = 0; i < TLM_FAULT_COUNT; i++)
+            cJSON_AddBoolToObject(bits, TLM_FaultName((TLM_Fault_t)i),
+                                  (msg->faults >> i) & 1U);
+    }
+    if (msg->meta_present)
+    {
+        cJSON *meta = cJSON_AddObjectToObject(root, "meta");
+        for (int m = 0; m < TLM_META_COUNT; m++)
+            cJSON_AddNumberToObject(meta, TLM_MetaName((TLM_Meta_t)m), msg->meta[m]);
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    if (json)
+    {
+        len = strlen(json);
+        if (out)
+            snprintf(out, cap, "%s", json);
+        cJSON_free(json);
+    }
+    cJSON_Delete(root);
+    return len;
+}
+
+static void bench_tlm_one(const char *name, TLM_Kind_t kind)
+{
+    TLM_Msg_t msg, back;
+    uint8_t   buf[TLM_MAX_BYTES];
+    const uint32_t iterations = 256U * 1024U;
+    size_t json_len = 0, cbor_len = 0;
+    char   label[40];
+
+    bench_tlm_sample(&msg, kind);
+
+    uint64_t t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        msg.seq  = i;
+        json_len = bench_tlm_json(&msg, NULL, 0);
+    }
+    snprintf(label, sizeof(label), "%s json   %3u B", name, (unsigned)json_len);
+    bench_report(label, PLAT_TimeUs() - t0, iterations, json_len);
+
+    t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        msg.seq  = i;
+        cbor_len = TLM_Encode(&msg, buf, sizeof(buf));
+    }
+    snprintf(label, sizeof(label), "%s cbor   %3u B", name, (unsigned)cbor_len);
+    bench_report(label, PLAT_TimeUs() - t0, iterations, cbor_len);
+
+    t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+        (void)TLM_Decode(buf, cbor_len, &back);
+    snprintf(label, sizeof(label), "%s decode", name);
+    bench_report(label, PLAT_TimeUs() - t0, iterations, cbor_len);
+
+    /* round trip: values come back within float32 precision */
+    int same = (back.present == msg.present && back.meta_present == msg.meta_present &&
+                back.faults == msg.faults && strcmp(back.drive, msg.drive) == 0);
+    for (int s = 0; same && s < SIG_COUNT; s++)
+    {
+        double d = back.values[s] - msg.values[s];
+        same = (d < 1e-3 && d > -1e-3);
+    }
+    if (!same)
+        printf("  %s: CBOR round trip differs!\n", name);
+    bench_sink = (uint32_t)(json_len + cbor_len);
+}
+
+static void bench_tlm(void)
+{
+    printf("[TELEMETRY]\n");
+    bench_tlm_one("continuous", TLM_KIND_CONTINUOUS);
+    bench_tlm_one("periodic",   TLM_KIND_PERIODIC);
+}
+
+/*----------------------------------------------------------
+ * JSON: cJSON tree vs streaming writer, same bytes
+ *----------------------------------------------------------*/
+static uint32_t bench_allocs;
+
+static void *bench_malloc(size_t size)
+{
+    bench_allocs++;
+    return malloc(size);
+}
+
+/* Same members as bench_tlm_json, through the writer */
+static size_t bench_tlm_jsonw(const TLM_Msg_t *msg, char *out, size_t cap)
+{
+    JSONW_t w;
+
+    JSONW_Init(&w, out, cap);
+    JSONW_ObjectBegin(&w, NULL);
+    if (msg->kind == TLM_KIND_PERIODIC)
+    {
+        JSONW_Num(&w, "v", 1);
+        JSONW_Str(&w, "id", "periodic");
+        JSONW_Str(&w, "type", "Event");
+        JSONW_Str(&w, "name", "TelemetryPeriodic");
+        JSONW_Str(&w, "src", "middleware");
+        JSONW_ObjectBegin(&w, "body");
+        JSONW_Bool(&w, "drive_connected", msg->connected);
+    }
+    else
+        JSONW_Str(&w, "type", "continuous");
+
+    JSONW_Str(&w, "drive", msg->drive);
+    JSONW_Num(&w, "axis", msg->axis);
+    for (uint32_t todo = msg->present; todo; todo &= todo - 1U)
+    {
+        int sig = __builtin_ctz(todo);
+        JSONW_Num(&w, CODEC_Describe((Signal_t)sig)->name, msg->values[sig]);
+    }
+
+    if (msg->has & TLM_HAS_FAULTS)
+    {
+        JSONW_ObjectBegin(&w, "fault_bits");
+        for (int i = 0; i < TLM_FAULT_COUNT; i++)
+            JSONW_Bool(&w, TLM_FaultName((TLM_Fault_t)i), (msg->faults >> i) & 1U);
+        JSONW_ObjectEnd(&w);
+    }
+    if (msg->kind == TLM_KIND_PERIODIC)
+        JSONW_ObjectEnd(&w);
+    if (msg->meta_present)
+    {
+        JSONW_ObjectBegin(&w, "meta");
+        for (int m = 0; m < TLM_META_COUNT; m++)
+            JSONW_Num(&w, TLM_MetaName((TLM_Meta_t)m), msg->meta[m]);
+        JSONW_ObjectEnd(&w);
+    }
+    JSONW_ObjectEnd(&w);
+
+    return JSONW_Finish(&w) ? w.len : 0U;
+}
+
+/* Numbers and strings the writer must print exactly as cJSON */
+static int bench_json_same(void)
+{
+    static const double nums[] =
+    {
+        0.0, -0.0, 1.0, -1.0, 0.01, 12.34, 1234.56, -5.5, 1e-7, 3.27F,
+        48.1F, 1450.0, 2147483647.0, 2147483648.0, -2147483649.0,
+        1e21, 1.0 / 3.0, 100000.5, 65535.0
+    };
+    static const char *const strs[] =
+    {
+        "plain", "quo\"te", "back\\slash", "tab\tnl\ncr\r", "ctl\x01\x1f", "utf8 \xc3\xa9"
+    };
+    char mine[64];
+    int  bad = 0;
+
+    for (size_t i = 0; i < sizeof(nums) / sizeof(nums[0]); i++)
+    {
+        cJSON *n = cJSON_CreateNumber(nums[i]);
+        char  *ref = cJSON_PrintUnformatted(n);
+        JSONW_t w;
+
+        JSONW_Init(&w, mine, sizeof(mine));
+        JSONW_Num(&w, NULL, nums[i]);
+        if (!JSONW_Finish(&w) || strcmp(ref, mine) != 0)
+        {
+            printf("  number differs: cJSON %s writer %s\n", ref, mine);
+            bad++;
+        }
+        cJSON_free(ref);
+        cJSON_Delete(n);
+    }
+    for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++)
+    {
+        cJSON *s = cJSON_CreateString(strs[i]);
+        char  *ref = cJSON_PrintUnformatted(s);
+        JSONW_t w;
+
+        JSONW_Init(&w, mine, sizeof(mine));
+        JSONW_Str(&w, NULL, strs[i]);
+        if (!JSONW_Finish(&w) || strcmp(ref, mine) != 0)
+        {
+            printf("  string differs: cJSON %s writer %s\n", ref, mine);
+            bad++;
+        }
+        cJSON_free(ref);
+        cJSON_Delete(s);
+    }
+    return bad == 0;
+}
+
+static void bench_json_one(const char *name, TLM_Kind_t kind)
+{
+    TLM_Msg_t msg;
+    char      out[1024], ref[1024];
+    const uint32_t iterations = 256U * 1024U;
+    size_t    len = 0;
+    char      label[40];
+
+    bench_tlm_sample(&msg, kind);
+
+    bench_allocs = 0;
+    uint64_t t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+        len = bench_tlm_json(&msg, NULL, 0);
+    uint64_t dt = PLAT_TimeUs() - t0;
+    snprintf(label, sizeof(label), "%s cJSON", name);
+    bench_report(label, dt, iterations, len);
+    printf("  %-28s %10.1f allocs/op\n", "", (double)bench_allocs / iterations);
+
+    bench_allocs = 0;
+    t0 = PLAT_TimeUs();
+    for (uint32_t i = 0; i < iterations; i++)
+        len = bench_tlm_jsonw(&msg, out, sizeof(out));
+    dt = PLAT_TimeUs() - t0;
+    snprintf(label, sizeof(label), "%s writer", name);
+    bench_report(label, dt, iterations, len);
+    printf("  %-28s %10.1f allocs/op\n", "", (double)bench_allocs / iterations);
+
+    /* both must print the same message */
+    bench_tlm_json(&msg, ref, sizeof(ref));
+    if (strcmp(ref, out) != 0)
+        printf("  %s: writer output differs from cJSON!\n", name);
+    bench_sink = (uint32_t)len;
+}
+
+static void bench_json(void)
+{
+    cJSON_Hooks counting = { bench_malloc, free };
+
+    printf("[JSON]\n");
+    cJSON_InitHooks(&counting);
+    printf("  numbers and strings as cJSON: %s\n", bench_json_same() ? "yes" : "NO");
+    bench_json_one("continuous", TLM_KIND_CONTINUOUS);
+    bench_json_one("periodic",   TLM_KIND_PERIODIC);
+    cJSON_InitHooks(NULL);
+}
+
+/*----------------------------------------------------------
+ * Number formatting: cJSON print_number vs fixed-point, for
+ * 0.01-scaled register values as telemetry carries them
+ *----------------------------------------------------------*/
+#define BENCH_FIXED_VALUES  1024U
+
+static void bench_fixed(void)
+{
+    static double values[BENCH_FIXED_VALUES];
+    const uint32_t rounds = 512U;
+    uint32_t x = 0x9E3779B9U;
+    char     out[64];
+    size_t   chars = 0;
+
+    /* signed 16-bit counts, decoded as the codec does */
+    for (uint32_t i = 0; i < BENCH_FIXED_VALUES; i++)
+    {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        values[i] = (float)(int16_t)x * 0.01F;
+    }
+
+    printf("[FIXED]\n");
+
+    cJSON *item = cJSON_CreateNumber(0.0);
+    uint64_t t0 = PLAT_TimeUs();
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        for (uint32_t i = 0; i < BENCH_FIXED_VALUES; i++)
+        {
+            cJSON_SetNumberValue(item, values[i]);
+            (void)cJSON_PrintPreallocated(item, out, sizeof(out), 0);
+            if (r == 0)
+                chars += strlen(out);
+        }
+    }
+    bench_report("print_number", PLAT_TimeUs() - t0, rounds * BENCH_FIXED_VALUES, 0);
+    printf("  %-28s %10.1f chars/value (e.g. %s)\n", "",
+           (double)chars / BENCH_FIXED_VALUES, out);
+    cJSON_Delete(item);
+
+    chars = 0;
+    t0 = PLAT_TimeUs();
+    for (uint32_t r = 0; r < rounds; r++)
+    {
+        for (uint32_t i = 0; i < BENCH_FIXED_VALUES; i++)
+        {
+            JSONW_t w;
+            JSONW_Init(&w, out, sizeof(out));
+            JSONW_Fixed(&w, NULL, values[i], 2);
+            (void)JSONW_Finish(&w);
+            if (r == 0)
+                chars += w.len;
+        }
+    }
+    bench_report("JSONW_Fixed", PLAT_TimeUs() - t0, rounds * BENCH_FIXED_VALUES, 0);
+    printf("  %-28s %10.1f chars/value (e.g. %s)\n", "",
+           (double)chars / BENCH_FIXED_VALUES, out);
+    bench_sink = (uint32_t)chars;
+}
+
+/*----------------------------------------------------------
+ * Suite table
+ *----------------------------------------------------------*/
+typedef struct
+{
+    const char *name;
+    void (*run)(void);
+} BenchSuite_t;
+
+static const BenchSuite_t suites[] =
+{
+    { "crc",   bench_crc   },
+    { "hist",  bench_hist  },
+    { "codec", bench_codec },
+    { "tlm",   bench_tlm   },
+    { "json",  bench_json  },
+    { "fixed", bench_fixed },
+};
+
+int main(int argc, char **argv)
+{
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); i++)
+    {
+        if (argc > 1 && strcmp(argv[1], suites[i].name) != 0)
+            continue;
+        suites[i].run();
+    }
+    return 0;
+}
@@ -0,0 +1,308 @@
+#include "cbor.h"
+#include <math.h>
+#include <string.h>
+
+#define CBOR_MAJOR_UINT    0U
+#define CBOR_MAJOR_NEGINT  1U
+#define CBOR_MAJOR_TEXT    3U
+#define CBOR_MAJOR_ARRAY   4U
+#define CBOR_MAJOR_MAP     5U
+#define CBOR_MAJOR_SIMPLE  7U
+
+#define CBOR_FALSE         0xF4U
+#define CBOR_TRUE          0xF5U
+#define CBOR_NULL_BYTE     0xF6U
+#define CBOR_FLOAT16       0xF9U
+#define CBOR_FLOAT32       0xFAU
+#define CBOR_FLOAT64       0xFBU
+
+#define CBOR_SKIP_DEPTH    8
+
+/*----------------------------------------------------------
+ * Writer
+ *----------------------------------------------------------*/
+void CBOR_WriterInit(CBOR_Writer_t *w, uint8_t *buf, size_t cap)
+{
+    w->buf      = buf;
+    w->cap      = cap;
+    w->len      = 0;
+    w->overflow = 0;
+}
+
+static void CBOR_Put(CBOR_Writer_t *w, const uint8_t *bytes, size_t n)
+{
+    if (w->overflow || w->len + n > w->cap)
+    {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->buf + w->len, bytes, n);
+    w->len += n;
+}
+
+/* Major type and argument in the shortest form */
+static void CBOR_Head(CBOR_Writer_t *w, uint8_t major, uint64_t v)
+{
+    uint8_t b[9];
+    size_t  n;
+
+    major = (uint8_t)(major << 5);
+    if (v < 24U)
+    {
+        b[0] = (uint8_t)(major | v);
+        n = 1;
+    }
+    else if (v <= 0xFFU)
+    {
+        b[0] = (uint8_t)(major | 24U);
+        b[1] = (uint8_t)v;
+        n = 2;
+    }
+    else if (v <= 0xFFFFU)
+    {
+        b[0] = (uint8_t)(major | 25U);
+        b[1] = (uint8_t)(v >> 8);
+        b[2] = (uint8_t)v;
+        n = 3;
+    }
+    else if (v <= 0xFFFFFFFFU)
+    {
+        b[0] = (uint8_t)(major | 26U);
+        for (int i = 0; i < 4; i++)
+            b[1 + i] = (uint8_t)(v >> (24 - 8 * i));
+        n = 5;
+    }
+    else
+    {
+        b[0] = (uint8_t)(major | 27U);
+        for (int i = 0; i < 8; i++)
+            b[1 + i] = (uint8_t)(v >> (56 - 8 * i));
+        n = 9;
+    }
+    CBOR_Put(w, b, n);
+}
+
+void CBOR_Map(CBOR_Writer_t *w, uint32_t pairs)
+{
+    CBOR_Head(w, CBOR_MAJOR_MAP, pairs);
+}
+
+void CBOR_Array(CBOR_Writer_t *w, uint32_t items)
+{
+    CBOR_Head(w, CBOR_MAJOR_ARRAY, items);
+}
+
+void CBOR_Uint(CBOR_Writer_t *w, uint64_t v)
+{
+    CBOR_Head(w, CBOR_MAJOR_UINT, v);
+}
+
+void CBOR_Int(CBOR_Writer_t *w, int64_t v)
+{
+    if (v >= 0)
+        CBOR_Head(w, CBOR_MAJOR_UINT, (uint64_t)v);
+    else
+        CBOR_Head(w, CBOR_MAJOR_NEGINT, (uint64_t)(-1 - v));
+}
+
+void CBOR_Float(CBOR_Writer_t *w, float v)
+{
+    uint32_t bits;
+    uint8_t  b[5];
+
+    memcpy(&bits, &v, sizeof(bits));
+    b[0] = CBOR_FLOAT32;
+    b[1] = (uint8_t)(bits >> 24);
+    b[2] = (uint8_t)(bits >> 16);
+    b[3] = (uint8_t)(bits >> 8);
+    b[4] = (uint8_t)bits;
+    CBOR_Put(w, b, sizeof(b));
+}
+
+void CBOR_Bool(CBOR_Writer_t *w, int v)
+{
+    uint8_t b = v ? CBOR_TRUE : CBOR_FALSE;
+    CBOR_Put(w, &b, 1);
+}
+
+void CBOR_Null(CBOR_Writer_t *w)
+{
+    uint8_t b = CBOR_NULL_BYTE;
+    CBOR_Put(w, &b, 1);
+}
+
+void CBOR_Text(CBOR_Writer_t *w, const char *s)
+{
+    size_t n = strlen(s);
+    CBOR_Head(w, CBOR_MAJOR_TEXT, n);
+    CBOR_Put(w, (const uint8_t *)s, n);
+}
+
+void CBOR_Number(CBOR_Writer_t *w, double v)
+{
+    /* register values are whole counts or 0.01 steps */
+    if (v >= -4294967296.0 && v <= 4294967295.0 && (double)(int64_t)v == v)
+        CBOR_Int(w, (int64_t)v);
+    else
+        CBOR_Float(w, (float)v);
+}
+
+/*----------------------------------------------------------
+ * Reader
+ *----------------------------------------------------------*/
+void CBOR_ReaderInit(CBOR_Reader_t *r, const uint8_t *buf, size_t len)
+{
+    r->buf = buf;
+    r->len = len;
+    r->pos = 0;
+}
+
+/* Big-endian unsigned of 'n' bytes at the read position */
+static int CBOR_Take(CBOR_Reader_t *r, size_t n, uint64_t *v)
+{
+    if (r->len - r->pos < n)
+        return -1;
+
+    *v = 0;
+    for (size_t i = 0; i < n; i++)
+        *v = (*v << 8) | r->buf[r->pos + i];
+    r->pos += n;
+    return 0;
+}
+
+/* IEEE half to double without libm */
+static double CBOR_Half(uint16_t h)
+{
+    uint32_t exp  = (h >> 10) & 0x1FU;
+    uint32_t mant = h & 0x3FFU;
+    double   v;
+
+    if (exp == 0U)
+        v = (double)mant / 16777216.0;      /* subnormal: mant * 2^-24 */
+    else if (exp == 31U)
+        v = (mant == 0U) ? INFINITY : NAN;
+    else
+    {
+        uint32_t bits = ((exp + 112U) << 23) | (mant << 13);
+        float    f;
+        memcpy(&f, &bits, sizeof(f));
+        v = f;
+    }
+    return (h & 0x8000U) ? -v : v;
+}
+
+int CBOR_Next(CBOR_Reader_t *r, CBOR_Item_t *item)
+{
+    uint64_t arg;
+
+    if (r->pos >= r->len)
+        return -1;
+
+    uint8_t ib    = r->buf[r->pos++];
+    uint8_t major = (uint8_t)(ib >> 5);
+    uint8_t info  = (uint8_t)(ib & 0x1FU);
+
+    memset(item, 0, sizeof(*item));
+
+    if (major == CBOR_MAJOR_SIMPLE)
+    {
+        switch (ib)
+        {
+            case CBOR_FALSE:
+            case CBOR_TRUE:
+                item->type = CBOR_BOOL;
+                item->u    = (ib == CBOR_TRUE);
+                return 0;
+
+            case CBOR_NULL_BYTE:
+                item->type = CBOR_NULL;
+                return 0;
+
+            case CBOR_FLOAT16:
+                if (CBOR_Take(r, 2, &arg) != 0)
+                    return -1;
+                item->type = CBOR_FLOAT;
+                item->f    = CBOR_Half((uint16_t)arg);
+                return 0;
+
+            case CBOR_FLOAT32:
+            {
+                uint32_t bits;
+                float    f;
+                if (CBOR_Take(r, 4, &arg) != 0)
+                    return -1;
+                bits = (uint32_t)arg;
+                memcpy(&f, &bits, sizeof(f));
+                item->type = CBOR_FLOAT;
+                item->f    = f;
+                return 0;
+            }
+
+            case CBOR_FLOAT64:
+                if (CBOR_Take(r, 8, &arg) != 0)
+                    return -1;
+                item->type = CBOR_FLOAT;
+                memcpy(&item->f, &arg, sizeof(item->f));
+                return 0;
+
+            default:
+                return -1;
+        }
+    }
+
+    if (info < 24U)
+        arg = info;
+    else if (info <= 27U)
+    {
+        if (CBOR_Take(r, (size_t)1U << (info - 24U), &arg) != 0)
+            return -1;
+    }
+    else
+        return -1;  /* indefinite length or reserved */
+
+    item->u = arg;
+    switch (major)
+    {
+        case CBOR_MAJOR_UINT:   item->type = CBOR_UINT;   return 0;
+        case CBOR_MAJOR_NEGINT: item->type = CBOR_NEGINT; return 0;
+        case CBOR_MAJOR_ARRAY:  item->type = CBOR_ARRAY;  return 0;
+        case CBOR_MAJOR_MAP:    item->type = CBOR_MAP;    return 0;
+
+        case CBOR_MAJOR_TEXT:
+            if (r->len - r->pos < arg)
+                return -1;
+            item->type = CBOR_TEXT;
+            item->text = (const char *)r->buf + r->pos;
+            r->pos += (size_t)arg;
+            return 0;
+
+        default:
+            return -1;  /* byte strings, tags */
+    }
+}
+
+static int CBOR_SkipDepth(CBOR_Reader_t *r, int depth)
+{
+    CBOR_Item_t item;
+
+    if (depth > CBOR_SKIP_DEPTH || CBOR_Next(r, &item) != 0)
+        return -1;
+
+    uint64_t entries = 0;
+    if (item.type == CBOR_ARRAY)
+        entries = item.u;
+    else if (item.type == CBOR_MAP)
+        entries = item.u * 2U;
+
+    for (uint64_t i = 0; i < entries; i++)
+    {
+        if (CBOR_SkipDepth(r, depth + 1) != 0)
+            return -1;
+    }
+    return 0;
+}
+
+int CBOR_Skip(CBOR_Reader_t *r)
+{
+    return CBOR_SkipDepth(r, 0);
+}
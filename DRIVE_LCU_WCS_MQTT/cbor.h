@@ -0,0 +1,94 @@
+#ifndef CBOR_H
+#define CBOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*===========================================================
+ * Minimal CBOR (RFC 8949) writer and reader
+ *
+ * Only what the binary telemetry needs: unsigned and negative
+ * integers, float32, bool, text and definite-length maps and
+ * arrays. Numbers are written as the shortest integer when they
+ * are whole and as float32 otherwise. The reader also accepts
+ * half and double floats; indefinite lengths, byte strings and
+ * tags are reported as errors.
+ *
+ * Neither side allocates: the writer fills a caller buffer and
+ * flags overflow, the reader points into the caller's bytes.
+ *===========================================================*/
+
+/**
+ * @brief Output buffer; 'overflow' is set instead of writing past 'cap'
+ */
+typedef struct
+{
+    uint8_t *buf;
+    size_t   cap;
+    size_t   len;
+    int      overflow;
+} CBOR_Writer_t;
+
+typedef enum
+{
+    CBOR_UINT = 0,
+    CBOR_NEGINT,
+    CBOR_TEXT,
+    CBOR_ARRAY,
+    CBOR_MAP,
+    CBOR_BOOL,
+    CBOR_NULL,
+    CBOR_FLOAT
+} CBOR_Type_t;
+
+/**
+ * @brief One decoded item; a map or array item is just its header,
+ *        its entries follow as further items
+ */
+typedef struct
+{
+    uint8_t     type;       /**< CBOR_Type_t                        */
+    uint64_t    u;          /**< UINT value, NEGINT -1-value, BOOL,
+                                 or TEXT / ARRAY / MAP count        */
+    double      f;          /**< FLOAT value                        */
+    const char *text;       /**< TEXT bytes (not NUL-terminated)    */
+} CBOR_Item_t;
+
+typedef struct
+{
+    const uint8_t *buf;
+    size_t         len;
+    size_t         pos;
+} CBOR_Reader_t;
+
+void CBOR_WriterInit(CBOR_Writer_t *w, uint8_t *buf, size_t cap);
+
+void CBOR_Map(CBOR_Writer_t *w, uint32_t pairs);
+void CBOR_Array(CBOR_Writer_t *w, uint32_t items);
+void CBOR_Uint(CBOR_Writer_t *w, uint64_t v);
+void CBOR_Int(CBOR_Writer_t *w, int64_t v);
+void CBOR_Float(CBOR_Writer_t *w, float v);
+void CBOR_Bool(CBOR_Writer_t *w, int v);
+void CBOR_Null(CBOR_Writer_t *w);
+void CBOR_Text(CBOR_Writer_t *w, const char *s);
+
+/**
+ * @brief Whole numbers as the shortest integer, others as float32
+ */
+void CBOR_Number(CBOR_Writer_t *w, double v);
+
+void CBOR_ReaderInit(CBOR_Reader_t *r, const uint8_t *buf, size_t len);
+
+/**
+ * @brief  Read the next item
+ * @return 0 on success, -1 on truncated or unsupported input
+ */
+int CBOR_Next(CBOR_Reader_t *r, CBOR_Item_t *item);
+
+/**
+ * @brief  Skip the next item, including a map's or array's entries
+ * @return 0 on success, -1 on error
+ */
+int CBOR_Skip(CBOR_Reader_t *r);
+
+#endif /* CBOR_H */
@@ -6,16 +6,37 @@
 #include "mqtt_client.h"
 #include "drive_command.h"
 #include "drive_parameters.h"
-#include"cJSON.h"
+#include "drive_pool.h"
+#include "json_writer.h"
+#include "flight_recorder.h"
+#include "platform.h"
+#include "lcu_log.h"
 
 #include <string.h>
 #include <stdio.h>
 #include <stdint.h>
 /*----------------------------------------------------------
- * Execute command on ONE axis
+ * Axis field: "1"/"TILT", "2"/"PAN", "3"/"BOTH"; 0 if unknown
  *----------------------------------------------------------*/
-static void execute_on_axis(Axis_t axis, const ParsedCommand_t *cmd)
+static Axis_t parse_axis(const char *axis)
 {
+    if (strcmp(axis, "1") == 0 || strcmp(axis, "TILT") == 0)
+        return AXIS_TILT;
+    if (strcmp(axis, "2") == 0 || strcmp(axis, "PAN") == 0)
+        return AXIS_PAN;
+    if (strcmp(axis, "3") == 0 || strcmp(axis, "BOTH") == 0)
+        return AXIS_BOTH;
+    return (Axis_t)0;
+}
+
+/*----------------------------------------------------------
+ * Execute command on ONE axis (commands also take AXIS_BOTH)
+ * Returns 0, or -1 when a parameter upload failed
+ *----------------------------------------------------------*/
+static int execute_on_axis(Axis_t axis, const ParsedCommand_t *cmd)
+{
+    int res = 0;
+
     switch (cmd->cmd)
     {
     case CMD_ENABLE:
@@ -35,26 +56,15 @@ static void execute_on_axis(Axis_t axis, const ParsedCommand_t *cmd)
         break;
 
     case CMD_SET_ANGLE:
-        Set_Velocity(axis,     cmd->velocity);
-        Set_Acceleration(axis, cmd->accel);
-        Set_Deceleration(axis, cmd->decel);
-        if(cmd->target_deg>=0){
-            Set_DegPosition_Positive(axis,  cmd->target_deg);
-        }else{
-            Set_DegPosition_Negative(axis,  cmd->target_deg);
-        }
+        /* target + velocity/accel/decel in one upload */
+        res = Set_MotionParameters_Deg(axis, cmd->target_deg,
+                                       cmd->velocity, cmd->accel, cmd->decel);
         //CMD_PositionMove_Deg(axis);
         break;
 
     case CMD_SET_POS:
-        Set_Velocity(axis,     cmd->velocity);
-        Set_Acceleration(axis, cmd->accel);
-        Set_Deceleration(axis, cmd->decel);
-        if(cmd->target_pos >=0){
-            Set_Position_Positive(axis,  cmd->target_pos);
-        }else{
-            Set_Position_Negative(axis,  cmd->target_pos);
-        }
+        res = Set_MotionParameters(axis, cmd->target_pos,
+                                   cmd->velocity, cmd->accel, cmd->decel);
         //CMD_PositionMove(axis);
         break;
 
@@ -85,6 +95,49 @@ static void execute_on_axis(Axis_t axis, const ParsedCommand_t *cmd)
     default:
         break;
     }
+    return res;
+}
+
+/*
+ * Stop commands skip POOL_Lock on the way out: the acquisition
+ * thread may hold the pool for a whole multi-drive read. Returns 1
+ * if 'cmd' was one.
+ */
+static int execute_safety(int drive, Axis_t axis, const ParsedCommand_t *cmd,
+                          uint64_t issued_us)
+{
+    switch (cmd->cmd)
+    {
+    case CMD_ESTOP:
+        CMD_EStopPosted(drive, axis, issued_us);
+        return 1;
+
+    case CMD_HALT:
+        CMD_HaltPosted(drive, axis, issued_us);
+        return 1;
+
+    case CMD_DISABLE:
+        CMD_DisablePosted(drive, axis, issued_us);
+        return 1;
+
+    default:
+        return 0;
+    }
+}
+
+/* Parameters live per axis: BOTH uploads to each in turn */
+static int execute_command(Axis_t axis, const ParsedCommand_t *cmd)
+{
+    int per_axis = (cmd->cmd == CMD_SET_ANGLE || cmd->cmd == CMD_SET_POS);
+
+    if (axis == AXIS_BOTH && per_axis)
+    {
+        int res = execute_on_axis(AXIS_TILT, cmd);
+        if (execute_on_axis(AXIS_PAN, cmd) != 0)
+            res = -1;
+        return res;
+    }
+    return execute_on_axis(axis, cmd);
 }
 
 /*----------------------------------------------------------
@@ -94,37 +147,37 @@ static void send_ack(const ParsedCommand_t *cmd,
                      const char *code,
                      const char *msg)
 {
-    /* Root object */
-    cJSON *root = cJSON_CreateObject();
-
-    cJSON_AddNumberToObject(root, "v", 1);
-    cJSON_AddStringToObject(root, "id", cmd->id);
-    cJSON_AddStringToObject(root, "type", "Reply");
-    cJSON_AddStringToObject(root, "name", cmd->name);
-    cJSON_AddStringToObject(root, "src", "lcu");
+    /* id and name may need escaping: room for the worst case */
+    char    json[768];
+    JSONW_t w;
 
-    /* body */
-    cJSON *body = cJSON_AddObjectToObject(root, "body");
-
-    /* result */
-    cJSON *result = cJSON_AddObjectToObject(body, "result");
-    cJSON_AddBoolToObject(result,
-                          "ok",
-                          (strcmp(code, "OK") == 0));
-    cJSON_AddStringToObject(result, "code", code);
-    cJSON_AddStringToObject(result, "message", msg);
+    /* Root object */
+    JSONW_Init(&w, json, sizeof(json));
+    JSONW_ObjectBegin(&w, NULL);
+    JSONW_Num(&w, "v", 1);
+    JSONW_Str(&w, "id", cmd->id);
+    JSONW_Str(&w, "type", "Reply");
+    JSONW_Str(&w, "name", cmd->name);
+    JSONW_Str(&w, "src", "lcu");
 
-    /* Convert to string */
-    char *json_str = cJSON_PrintUnformatted(root);
+    /* body.result */
+    JSONW_ObjectBegin(&w, "body");
+    JSONW_ObjectBegin(&w, "result");
+    JSONW_Bool(&w, "ok", (strcmp(code, "OK") == 0));
+    JSONW_Str(&w, "code", code);
+    JSONW_Str(&w, "message", msg);
+    JSONW_ObjectEnd(&w);
+    JSONW_ObjectEnd(&w);
+    JSONW_ObjectEnd(&w);
 
     /* Publish */
     //extra line this below testing purpose
-    //printf("[LCU] MQTT ACK: %s\n", json_str);
-    mqtt_publish("lcu/ack", json_str, strlen(json_str));
-
-    /* Cleanup */
-    cJSON_free(json_str);
-    cJSON_Delete(root);
+    //printf("[LCU] MQTT ACK: %s\n", json);
+    if (JSONW_Finish(&w))
+        mqtt_publish("lcu/ack", json, w.len);
+    else
+        LOG_WARN("[LCU] ACK for %s over %zu bytes dropped (%u so far)\n",
+                 code, sizeof(json), JSONW_Dropped());
 }
 
 
@@ -140,40 +193,75 @@ void Receive_Command_From_WCS(void)
     if (json_len <= 0)
         return;
 
+    /* safety latency counts from here, not from the Modbus submit */
+    uint64_t issued_us = PLAT_TimeUs();
+
     //printf("[LCU] RAW JSON: %s\n", json_buf);
 
     ParsedCommand_t cmd;
     if (!Parse_Command_JSON(json_buf, &cmd))
     {
-        printf("[LCU] JSON parse FAILED\n");
+        LOG_WARN("[LCU] JSON parse FAILED\n");
+        return;
+    }
+
+    /* one record: the writer keeps the block together */
+    LOG_INFO("[LCU] Parsed Command:\n"
+             "  ID        : %s\n"
+             "  TYPE      : %s\n"
+             "  NAME      : %s\n"
+             "  DRIVE     : %s\n"
+             "  AXIS      : %s\n"
+             "  CMD ENUM  : %d\n"
+             "  TARGET_DEG: %.2f\n"
+             "  VELOCITY  : %.2f\n"
+             "  ACCEL     : %.2f\n"
+             "  DECEL     : %.2f\n"
+             "  TARGET_POS: %.2f\n",
+             cmd.id, cmd.type, cmd.name, cmd.drive, cmd.axis, cmd.cmd,
+             cmd.target_deg, cmd.velocity, cmd.accel, cmd.decel,
+             cmd.target_pos);
+
+    /* Drive dispatch: the axis calls below act on the selected drive */
+    int drive = POOL_Find(cmd.drive);
+    if (drive < 0)
+    {
+        send_ack(&cmd, "INVALID_DRIVE", "Unknown drive");
         return;
     }
 
-    printf("[LCU] Parsed Command:\n");
-    printf("  ID        : %s\n", cmd.id);
-    printf("  TYPE      : %s\n", cmd.type);
-    printf("  NAME      : %s\n", cmd.name);
-    printf("  AXIS      : %s\n", cmd.axis);
-    printf("  CMD ENUM  : %d\n", cmd.cmd);
-    printf("  TARGET_DEG: %.2f\n", cmd.target_deg);
-    printf("  VELOCITY  : %.2f\n", cmd.velocity);
-    printf("  ACCEL     : %.2f\n", cmd.accel);
-    printf("  DECEL     : %.2f\n", cmd.decel);
-    printf("  TARGET_POS: %.2f\n", cmd.target_pos);
+    /* operator snapshot: no drive traffic, the recorder does the rest */
+    if (cmd.cmd == CMD_RECORDER_DUMP)
+    {
+        if (REC_Trigger(REC_CAUSE_OPERATOR, drive, AXIS_BOTH, 0) != 0)
+            send_ack(&cmd, "BUSY", "Recorder off or capture in progress");
+        else
+            send_ack(&cmd, "OK", "Capture started");
+        return;
+    }
 
     /* Axis dispatch */
-    // if (strcmp(cmd.axis, "1") == 0)
-    //     execute_on_axis(AXIS_TILT, &cmd);
-    // else if (strcmp(cmd.axis, "2") == 0)
-    //     execute_on_axis(AXIS_PAN, &cmd);
-    // else if (strcmp(cmd.axis, "3") == 0)
-    // {
-    //     execute_on_axis(AXIS_BOTH, &cmd);
-    // }
-    // else
-    // {
-    //     send_ack(&cmd, "INVALID_AXIS", "Unknown axis");
-    //     return;
-    // }
-    send_ack(&cmd, "OK", "Command executed");
+    Axis_t axis = parse_axis(cmd.axis);
+    if (axis == 0)
+    {
+        send_ack(&cmd, "INVALID_AXIS", "Unknown axis");
+        return;
+    }
+
+    if (execute_safety(drive, axis, &cmd, issued_us))
+    {
+        send_ack(&cmd, "OK", "Command executed");
+        return;
+    }
+
+    /* the acquisition thread shares the drive links */
+    POOL_Lock();
+    (void)POOL_Select(drive);
+    int res = execute_command(axis, &cmd);
+    POOL_Unlock();
+
+    if (res != 0)
+        send_ack(&cmd, "FAILED", "Parameter upload failed");
+    else
+        send_ack(&cmd, "OK", "Command executed");
 }
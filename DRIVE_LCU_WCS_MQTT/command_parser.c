@@ -47,6 +47,7 @@ bool Parse_Command_JSON(const char *json, ParsedCommand_t *out)
     else if (strcmp(out->name, "JogRev") == 0) out->cmd = CMD_VELOCITY_REV;
     else if (strcmp(out->name, "Halt") == 0) out->cmd = CMD_HALT;
     else if (strcmp(out->name, "Solenoid") == 0) out->cmd = CMD_SOLENOID;
+    else if (strcmp(out->name, "RecorderDump") == 0) out->cmd = CMD_RECORDER_DUMP;
     else if (strcmp(out->name, "Jog") == 0) out->cmd = CMD_VELOCITY_FWD;
     else if (strcmp(out->name, "MovePosition") == 0) out->cmd = CMD_MOVE;
     else if (strcmp(out->name, "MoveToPositionDeg") == 0) out->cmd = CMD_MOVE_DEG;
@@ -62,6 +63,12 @@ bool Parse_Command_JSON(const char *json, ParsedCommand_t *out)
     if (cJSON_IsString(axis))
         strncpy(out->axis, axis->valuestring, sizeof(out->axis)-1);
 
+    cJSON *drive = cJSON_GetObjectItem(body, "drive");
+    if (cJSON_IsString(drive))
+        strncpy(out->drive, drive->valuestring, sizeof(out->drive)-1);
+    else if (cJSON_IsNumber(drive))
+        snprintf(out->drive, sizeof(out->drive), "%d", drive->valueint);
+
     cJSON *tdeg = cJSON_GetObjectItem(body, "target_deg");
     if (cJSON_IsNumber(tdeg))
         out->target_deg = (float)tdeg->valuedouble;
@@ -18,7 +18,8 @@ typedef enum
     CMD_MOVE_DEG,
     CMD_VELOCITY_FWD,
     CMD_VELOCITY_REV,
-    CMD_SOLENOID
+    CMD_SOLENOID,
+    CMD_RECORDER_DUMP
 } CommandType_t;
 
 /* Parsed command (axis as STRING) */
@@ -32,7 +33,8 @@ typedef struct
 
     /* Body */
     CommandType_t cmd;
-    char axis[8];          /* "PAN" | "TILT" | "BOTH" */
+    char axis[8];          /* "TILT" | "PAN" | "BOTH", or "1" | "2" | "3" */
+    char drive[32];        /* [DRIVE] NAME or index; "" = first drive */
 
     float target_deg;
     float target_pos;
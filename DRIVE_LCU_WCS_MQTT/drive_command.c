@@ -3,6 +3,8 @@
 #include "drive_command.h"
 #include "modbus_functions.h"
 #include "drive_feedback.h"
+#include "register_shadow.h"
+#include "lcu_log.h"
 #include <stdio.h>
 #include <stdint.h>
 
@@ -12,7 +14,7 @@ static uint16_t GetSolenoidReg(Axis_t axis);
 /*----------------------------------------------------------
  * Internal helper to issue a single register write command
  *----------------------------------------------------------*/
-static void WriteCommand(uint16_t reg_addr, Axis_t axis)
+static uint16_t CommandValue(Axis_t axis)
 {
     /* Example: Writing 1U for command execution */
     uint16_t value;
@@ -24,8 +26,58 @@ static void WriteCommand(uint16_t reg_addr, Axis_t axis)
         value = 3U;
     else 
         value = 0U;
-    (void)MODBUS_WriteSingle(modbus_cfg.UNIT_ID, reg_addr, value);
-    printf("Command 0x%X executed for Axis %u\n", reg_addr, axis);
+    return value;
+}
+
+static void WriteCommandPrio(uint16_t reg_addr, Axis_t axis, MODBUS_Prio_t prio)
+{
+    (void)MODBUS_WriteSinglePrio(POOL_UnitId(), reg_addr, CommandValue(axis), prio);
+    LOG_INFO("Command 0x%X executed for Axis %u\n", reg_addr, axis);
+}
+
+static void WriteCommand(uint16_t reg_addr, Axis_t axis)
+{
+    WriteCommandPrio(reg_addr, axis, MODBUS_PRIO_NORMAL);
+}
+
+/* Stop commands jump the Modbus queue (limit trips land here too) */
+static void WriteSafetyCommand(uint16_t reg_addr, Axis_t axis)
+{
+    WriteCommandPrio(reg_addr, axis, MODBUS_PRIO_SAFETY);
+}
+
+/*
+ * Stop command from a thread that does not hold the pool: it is
+ * posted to the drive's link and goes on the wire at the holder's
+ * next poll; POOL_Lock is only taken to collect the reply.
+ */
+static void PostSafetyCommand(int drive, uint16_t reg_addr, Axis_t axis,
+                              uint64_t issued_us)
+{
+    const DRIVE_CONFIG *drv = POOL_Drive(drive);
+    if (!drv)
+        return;
+
+    int post = MODBUS_PostSafetyWrite((uint8_t)drive, (uint8_t)drv->UNIT_ID,
+                                      reg_addr, CommandValue(axis), issued_us);
+
+    POOL_Lock();
+    if (post >= 0)
+    {
+        (void)MODBUS_WaitPosted((uint8_t)drive, post);
+    }
+    else
+    {
+        /* every post slot busy: send it the locked way */
+        int prev = POOL_Selected();
+        (void)POOL_Select(drive);
+        (void)MODBUS_WriteSinglePrio(POOL_UnitId(), reg_addr, CommandValue(axis),
+                                     MODBUS_PRIO_SAFETY);
+        (void)POOL_Select(prev);
+    }
+    POOL_Unlock();
+
+    LOG_INFO("Command 0x%X executed for Drive %d Axis %u\n", reg_addr, drive, axis);
 }
 /*----------------------------------------------------------
  * CMD_Enable - Enable Drive
@@ -39,7 +91,12 @@ void CMD_Enable(Axis_t axis)
  *----------------------------------------------------------*/
 void CMD_Disable(Axis_t axis)
 {
-    WriteCommand(cmd_regs.CMD_DISABLE, axis);
+    WriteSafetyCommand(cmd_regs.CMD_DISABLE, axis);
+}
+
+void CMD_DisablePosted(int drive, Axis_t axis, uint64_t issued_us)
+{
+    PostSafetyCommand(drive, cmd_regs.CMD_DISABLE, axis, issued_us);
 }
 
 /*----------------------------------------------------------
@@ -48,6 +105,9 @@ void CMD_Disable(Axis_t axis)
 void CMD_Reset(Axis_t axis)
 {
     WriteCommand(cmd_regs.CMD_RESET, axis);
+
+    /* a reset may reload parameters from the drive's EEPROM */
+    SHADOW_Invalidate(axis);
 }
 
 /*----------------------------------------------------------
@@ -55,7 +115,12 @@ void CMD_Reset(Axis_t axis)
  *----------------------------------------------------------*/
 void CMD_Halt(Axis_t axis)
 {
-    WriteCommand(cmd_regs.CMD_HALT, axis);
+    WriteSafetyCommand(cmd_regs.CMD_HALT, axis);
+}
+
+void CMD_HaltPosted(int drive, Axis_t axis, uint64_t issued_us)
+{
+    PostSafetyCommand(drive, cmd_regs.CMD_HALT, axis, issued_us);
 }
 
 /*----------------------------------------------------------
@@ -63,7 +128,12 @@ void CMD_Halt(Axis_t axis)
  *----------------------------------------------------------*/
 void CMD_EStop(Axis_t axis)
 {
-    WriteCommand(cmd_regs.CMD_EMG_STOP, axis);
+    WriteSafetyCommand(cmd_regs.CMD_EMG_STOP, axis);
+}
+
+void CMD_EStopPosted(int drive, Axis_t axis, uint64_t issued_us)
+{
+    PostSafetyCommand(drive, cmd_regs.CMD_EMG_STOP, axis, issued_us);
 }
 
 /*----------------------------------------------------------
@@ -161,9 +231,9 @@ static uint16_t GetSolenoidReg(Axis_t axis)
 
 static void WriteSolenoidCommand(Axis_t axis, uint16_t value)
 {
-    (void)MODBUS_WriteSingle(modbus_cfg.UNIT_ID,
+    (void)MODBUS_WriteSingle(POOL_UnitId(),
                              GetSolenoidReg(axis),
                              value);
 
-    printf("Solenoid toggled | Axis=%u Value=0x%04X\n", axis, value);
+    LOG_INFO("Solenoid toggled | Axis=%u Value=0x%04X\n", axis, value);
 }
\ No newline at end of file
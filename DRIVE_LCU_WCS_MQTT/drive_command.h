@@ -32,6 +32,17 @@ void CMD_Halt(Axis_t axis);
  */
 void CMD_EStop(Axis_t axis);
 
+/**
+ * @brief Stop commands for a thread that does NOT hold POOL_Lock:
+ *        posted to drive 'drive' so they reach the wire while
+ *        another thread holds the pool; return once the drive has
+ *        answered
+ * @param issued_us When the command was issued (PLAT_TimeUs)
+ */
+void CMD_EStopPosted(int drive, Axis_t axis, uint64_t issued_us);
+void CMD_HaltPosted(int drive, Axis_t axis, uint64_t issued_us);
+void CMD_DisablePosted(int drive, Axis_t axis, uint64_t issued_us);
+
 /**
  * @brief Command for position move
  */
@@ -5,8 +5,13 @@
 #include "drive_feedback.h"
 #include "drive_command.h"
 #include "modbus_functions.h"
+#include "read_planner.h"
+#include "signal_codec.h"
+#include "flight_recorder.h"
+#include "lcu_log.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 
 /*----------------------------------------------------------
  * Internal helper to get register address based on axis and type
@@ -16,286 +21,371 @@
     return (axis == AXIS_PAN) ? pan_addr : tilt_addr;
 }*/
 
-/* Helper to extract a single 16-bit register from a validated modbus response */
-static int extract_reg16_from_resp(const uint8_t *rx_buf, int rx_len, uint16_t *out)
-{
-    /* minimal frame for single reg = 1+1+1 + 2 + 2 = 7 bytes */
-    if (rx_len < 7) return -1;
-    /* byte 2 is bytecount */
-    uint8_t byte_count = rx_buf[2];
-    if (byte_count < 2) return -1;
-    /* data starts at index 3 */
-    *out = (uint16_t)((rx_buf[3] << 8) | rx_buf[4]);
-    return 0;
-}
-/*----------------------------------------------------------
- * Read firmware version number from drive
- * Uses Input Register (0x04)
- *----------------------------------------------------------*/
+/* Edge state of the checks below, per drive and axis; both run
+ * in the decode, with the pool locked */
+#define TRIP_SLOT_OK(drv, axis) \
+    ((drv) >= 0 && (drv) < MAX_DRIVES && ((axis) == AXIS_TILT || (axis) == AXIS_PAN))
 
-int Read_Version(Axis_t axis, uint16_t *value)
+/* Limit switch check shared by Read_IO_Status and snapshots */
+static void Check_LimitSwitches(Axis_t axis, uint16_t io_raw)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_VERSION, REG_TILT_VERSION);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->VERSION);
+    static uint8_t was_hit[MAX_DRIVES][2];
+    uint8_t hit = 0;
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+    /* ---------------- LIMIT SWITCH CHECK (LCU SAFETY) ---------------- */
+
+    uint8_t inputs = io_raw & 0xFF;   /* DD byte */
+
+    if (axis == AXIS_TILT)
+    {
+        /* PAN: Input-1 & Input-2 */
+        if (inputs & ((1 << 0) | (1 << 1)))
+        {
+            LOG_WARN("[LIMIT] PAN axis limit hit → E-STOP\n");
+            CMD_EStop(axis);
+            hit = 1;
+        }
+    }
+    else /* AXIS_PAN */
+    {
+        /* TILT: Input-4 & Input-5 */
+        if (inputs & ((1 << 3) | (1 << 4)))
+        {
+            LOG_WARN("[LIMIT] TILT axis limit hit → E-STOP\n");
+            CMD_EStop(axis);
+            hit = 1;
+        }
+    }
 
-    return extract_reg16_from_resp(rx_buf, len, value);
+    /* a new trip keeps the flight recorder window around it */
+    int drv = POOL_Selected();
+    if (!TRIP_SLOT_OK(drv, axis))
+        return;
+    if (hit && !was_hit[drv][axis - 1])
+        (void)REC_Trigger(REC_CAUSE_LIMIT, drv, axis, io_raw);
+    was_hit[drv][axis - 1] = hit;
 }
 
-/*----------------------------------------------------------
- * Read firmware revision number
- * Uses Input Register (0x04)
- *----------------------------------------------------------*/
-int Read_Revision(Axis_t axis, uint16_t *value)
+/* Fault flags rising (or system_ok falling) between two decoded
+ * fault words trigger a flight recorder capture; the first word
+ * seen only sets the baseline */
+static void Check_FaultTrip(Axis_t axis, const FaultStatus_t *f)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_REVISION, REG_TILT_REVISION);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->REVISION);
+    static uint16_t last[MAX_DRIVES][2];
+    static uint8_t  seen[MAX_DRIVES][2];
+    const uint8_t trips[] =
+    {
+        f->short_circuit, f->rated_current, f->over_temp, f->over_volt,
+        f->under_volt, f->motion_error, f->eeprom_error, f->commutation_err,
+        f->lock_rotor, f->emergency_err, f->command_error, !f->system_ok
+    };
+    uint16_t now = 0;
+    int      drv = POOL_Selected();
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+    if (!TRIP_SLOT_OK(drv, axis))
+        return;
 
-    return extract_reg16_from_resp(rx_buf, len, value);
+    for (uint8_t i = 0; i < sizeof(trips); i++)
+        now |= (uint16_t)((trips[i] != 0U) << i);
+
+    if (seen[drv][axis - 1] && (now & ~last[drv][axis - 1]))
+    {
+        LOG_WARN("[FAULT] Drive %d axis %u fault word 0x%04X\n", drv, axis, f->raw_code);
+        (void)REC_Trigger(REC_CAUSE_FAULT, drv, axis, f->raw_code);
+    }
+    last[drv][axis - 1] = now;
+    seen[drv][axis - 1] = 1;
 }
 
 /*----------------------------------------------------------
- * Read firmware release date code
- * Uses Input Register (0x04)
+ * Snapshot: every requested signal from one coalesced plan
  *----------------------------------------------------------*/
-int Read_ReleaseDate(Axis_t axis, uint16_t *value)
+#define SNAPSHOT_PLAN_CACHE 4U
+
+/* Plans only depend on config.ini, so build each (drive, axis, set) once */
+static const ReadPlan_t *GetReadPlan(Axis_t axis, uint32_t signals)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_RELEASE_DATE, REG_TILT_RELEASE_DATE);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->RELEASE_DATE);
+    static ReadPlan_t cache[MAX_DRIVES][SNAPSHOT_PLAN_CACHE];
+    static uint8_t next_slot[MAX_DRIVES];
+    int drv = POOL_Selected();
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+    for (uint8_t i = 0; i < SNAPSHOT_PLAN_CACHE; i++)
+    {
+        if (cache[drv][i].block_count > 0 &&
+            cache[drv][i].axis == axis && cache[drv][i].signals == signals)
+            return &cache[drv][i];
+    }
 
-    return extract_reg16_from_resp(rx_buf, len, value);
+    ReadPlan_t *plan = &cache[drv][next_slot[drv]];
+    if (PLAN_Build(plan, axis, signals) != 0)
+    {
+        plan->block_count = 0;
+        return NULL;
+    }
+    next_slot[drv] = (uint8_t)((next_slot[drv] + 1U) % SNAPSHOT_PLAN_CACHE);
+    return plan;
 }
-/*----------------------------------------------------------
- * Read Actual Absolute Position(Encoder value MM)
- *----------------------------------------------------------*/
-int Read_Actual_Absolute_Pos_MM(Axis_t axis, float *value)
-{
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_POS_DEG, REG_TILT_POS_DEG);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->ABS_POSITION);
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+/* One snapshot's block reads, from submit to decode */
+typedef struct
+{
+    const ReadPlan_t *plan;
+    MODBUS_Txn_t      txn[PLAN_MAX_BLOCKS];
+    uint8_t           rx_buf[PLAN_MAX_BLOCKS][MODBUS_MAX_ADU];
+} SnapshotReq_t;
 
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+/* Queue every block of 'plan' on the selected drive's link */
+static int Snapshot_Submit(SnapshotReq_t *req, const ReadPlan_t *plan)
+{
+    req->plan = plan;
+    if (!plan)
+        return -1;
 
-    *value = ((float)raw) / 100.0F; /* scaled by *100  */
+    /* all blocks go out together, the engine pipelines them */
+    for (uint8_t b = 0; b < req->plan->block_count; b++)
+    {
+        const ReadBlock_t *blk = &req->plan->blocks[b];
+        if (MODBUS_TxnRead(&req->txn[b], POOL_UnitId(), blk->func,
+                           blk->start, blk->count,
+                           req->rx_buf[b], sizeof(req->rx_buf[b])) != 0 ||
+            MODBUS_Submit(&req->txn[b]) != 0)
+        {
+            req->txn[b].state = MODBUS_TXN_TIMEOUT;
+        }
+    }
     return 0;
 }
-/*----------------------------------------------------------
- * Read Position (Degrees)
- *----------------------------------------------------------*/
-int Read_Position_Deg(Axis_t axis, float *value)
-{
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_POS_DEG, REG_TILT_POS_DEG);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->POS_DEG);
-
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
 
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+static void Snapshot_Wait(SnapshotReq_t *req)
+{
+    for (uint8_t b = 0; b < req->plan->block_count; b++)
+        (void)MODBUS_Wait(&req->txn[b]);
+}
 
-    *value = ((float)raw) / 100.0F; /* scaled by *100  */
-    return 0;
+/* Every block answered or failed? */
+static int Snapshot_Done(const SnapshotReq_t *req)
+{
+    for (uint8_t b = 0; b < req->plan->block_count; b++)
+    {
+        MODBUS_TxnState_t st = req->txn[b].state;
+        if (st == MODBUS_TXN_QUEUED || st == MODBUS_TXN_INFLIGHT)
+            return 0;
+    }
+    return 1;
 }
 
-/*----------------------------------------------------------
- * Read Position (Millimeters)
- *----------------------------------------------------------*/
-int Read_Position_MM(Axis_t axis, float *value)
+/* Decode the replies; the request's drive must be selected */
+static int Snapshot_Decode(const SnapshotReq_t *req, DriveSnapshot_t *snap)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_POS_MM, REG_TILT_POS_MM);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->POS_MM);
+    const ReadPlan_t *plan = req->plan;
+    const uint8_t *data[PLAN_MAX_BLOCKS];
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+    /* exception replies or short frames leave their fields invalid */
+    for (uint8_t b = 0; b < plan->block_count; b++)
+    {
+        uint16_t bytes = (uint16_t)(plan->blocks[b].count * 2U);
+        int ok = req->txn[b].state == MODBUS_TXN_DONE &&
+                 req->txn[b].rx_len >= (int32_t)(3U + bytes) &&
+                 req->rx_buf[b][2] == (uint8_t)bytes;
+        data[b] = ok ? &req->rx_buf[b][3] : NULL;
+    }
 
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+    CODEC_Decode(plan, data, snap);
 
-    *value = ((float)raw) / 100.0F;
-    return 0;
+    if (snap->valid & SIG_MASK(SIG_IO_STATUS))
+        Check_LimitSwitches(plan->axis, snap->io_status);
+    if (snap->valid & SIG_MASK(SIG_FAULT_STATUS))
+        Check_FaultTrip(plan->axis, &snap->fault);
+
+    return (snap->valid == plan->signals) ? 0 : -1;
 }
-/*----------------------------------------------------------
- * Read RPM
- *----------------------------------------------------------*/
-int Read_RPM(Axis_t axis, float *value)
-{
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_RPM, REG_TILT_RPM);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->RPM);
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+int Read_Snapshot(Axis_t axis, uint32_t signals, DriveSnapshot_t *snap)
+{
+    SnapshotReq_t req;
 
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+    if (!snap)
+        return -1;
+    memset(snap, 0, sizeof(*snap));
 
-    *value = (float)raw;
-    return 0;
+    if (Snapshot_Submit(&req, GetReadPlan(axis, signals)) != 0)
+        return -1;
+    Snapshot_Wait(&req);
+    return Snapshot_Decode(&req, snap);
 }
 
-/*----------------------------------------------------------
- * Read Actual Current
- *----------------------------------------------------------*/
-int Read_Current(Axis_t axis, float *value)
+/* One signal, with a throwaway plan so single reads do not evict
+ * the cached telemetry plans */
+static int Read_One(Axis_t axis, Signal_t sig, DriveSnapshot_t *snap)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_MOTOR_CURRENT, REG_TILT_MOTOR_CURRENT);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->ACTUAL_CURRENT);
-
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
-
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+    SnapshotReq_t req;
+    ReadPlan_t    plan;
 
-    *value = ((float)raw) / 100.0F; /* Example scale factor used previously */
-    return 0;
+    memset(snap, 0, sizeof(*snap));
+    if (PLAN_Build(&plan, axis, SIG_MASK(sig)) != 0 ||
+        Snapshot_Submit(&req, &plan) != 0)
+        return -1;
+    Snapshot_Wait(&req);
+    return Snapshot_Decode(&req, snap);
 }
-/*----------------------------------------------------------
- * Read I/O Status (Holding Register used for ApplicationReadPara)
- *----------------------------------------------------------*/
-/* Console IO status print (unchanged except now uses ReadHolding inside above helpers) */
-int Read_IO_Status(Axis_t axis, uint16_t *raw_io)
+
+int Read_SnapshotAll(Axis_t axis, uint32_t signals,
+                     DriveSnapshot_t *snaps, int count)
 {
-    if (!raw_io)
+    static SnapshotReq_t req[MAX_DRIVES];
+    int8_t submitted[MAX_DRIVES];
+    int8_t decoded[MAX_DRIVES];
+    int prev = POOL_Selected();
+    int left = 0;
+    int ok = 0;
+
+    if (!snaps)
         return -1;
+    if (count > POOL_Count())
+        count = POOL_Count();
 
-    /* Single IO status register (422) */
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->IO_STATUS);
-
-    uint8_t rx_buf[16] = {0};
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-
-    if (len < 7)
+    /* every drive's blocks are queued before the first wait, so the
+     * round trips to all drives overlap */
+    for (int d = 0; d < count; d++)
     {
-        printf("[ERROR] IO Status read failed! Len=%d\n", len);
-        return -1;
+        memset(&snaps[d], 0, sizeof(snaps[d]));
+        (void)POOL_Select(d);
+        submitted[d] = (int8_t)(Snapshot_Submit(&req[d], GetReadPlan(axis, signals)) == 0);
+        decoded[d]   = (int8_t)!submitted[d];
+        left        += submitted[d];
     }
 
-    uint16_t io_raw = (uint16_t)((rx_buf[3] << 8) | rx_buf[4]);
-    *raw_io = io_raw;
-
-    /* ---------------- LIMIT SWITCH CHECK (LCU SAFETY) ---------------- */
-
-    uint8_t inputs = io_raw & 0xFF;   /* DD byte */
-
-    if (axis == AXIS_TILT)
+    /* each drive is decoded as soon as its blocks are in, so a limit
+     * trip is stopped while slower (or dead) drives are still being
+     * waited for */
+    while (left > 0)
     {
-        /* PAN: Input-1 & Input-2 */
-        if (inputs & ((1 << 0) | (1 << 1)))
+        for (int d = 0; d < count; d++)
         {
-            printf("[LIMIT] PAN axis limit hit → E-STOP\n");
-            CMD_EStop(axis);
-        }
-    }
-    else /* AXIS_PAN */
-    {
-        /* TILT: Input-4 & Input-5 */
-        if (inputs & ((1 << 3) | (1 << 4)))
-        {
-            printf("[LIMIT] TILT axis limit hit → E-STOP\n");
-            CMD_EStop(axis);
+            if (decoded[d] || !Snapshot_Done(&req[d]))
+                continue;
+
+            decoded[d] = 1;
+            left--;
+            (void)POOL_Select(d);
+            if (Snapshot_Decode(&req[d], &snaps[d]) == 0)
+                ok++;
         }
+        if (left > 0)
+            (void)MODBUS_Poll();
     }
 
-    return 0;
+    (void)POOL_Select(prev);
+    return ok;
 }
+
 /*----------------------------------------------------------
- * Read System Status (Holding)
+ * Single-signal reads
+ * Each is one descriptor lookup through Read_One; the scaling
+ * lives in the signal table (signal_codec.c).
  *----------------------------------------------------------*/
-int Read_SystemStatus(Axis_t axis, float *value)
+static int Read_F32(Axis_t axis, Signal_t sig, float *value)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = (axis == AXIS_PAN) ? REG_PAN_SYSTEM_STATUS : REG_TILT_SYSTEM_STATUS;
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->SYSTEM_STATUS);
+    DriveSnapshot_t snap;
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+    if (!value || Read_One(axis, sig, &snap) != 0)
+        return -1;
+    *value = *(const float *)((const char *)&snap + CODEC_Describe(sig)->out_field);
+    return 0;
+}
 
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+static int Read_U16(Axis_t axis, Signal_t sig, uint16_t *value)
+{
+    DriveSnapshot_t snap;
 
-    *value = (float)raw;
+    if (!value || Read_One(axis, sig, &snap) != 0)
+        return -1;
+    *value = *(const uint16_t *)((const char *)&snap + CODEC_Describe(sig)->out_field);
     return 0;
 }
-/*----------------------------------------------------------
- * Read DC Bus Voltage
- *----------------------------------------------------------*/
-int Read_DCBusVoltage(Axis_t axis, float *value)
+
+/* ---------------- DRIVE INFO (BOOT / ONCE) ---------------- */
+int Read_Version(Axis_t axis, uint16_t *value)
+{
+    return Read_U16(axis, SIG_VERSION, value);
+}
+
+int Read_Revision(Axis_t axis, uint16_t *value)
 {
-    uint8_t rx_buf[64U];
-    //uint16_t addr = GetRegisterAddress(axis, REG_PAN_DCBUS_VOLT, REG_TILT_DCBUS_VOLT);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = (uint16_t)(cfg->DCBUS_VOLT_CMD);
+    return Read_U16(axis, SIG_REVISION, value);
+}
 
-    int len = MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-    if (len <= 0) return -1;
+int Read_ReleaseDate(Axis_t axis, uint16_t *value)
+{
+    return Read_U16(axis, SIG_RELEASE_DATE, value);
+}
 
-    uint16_t raw;
-    if (extract_reg16_from_resp(rx_buf, len, &raw) != 0) return -1;
+/* ---------------- MOTION FEEDBACK ---------------- */
+int Read_Actual_Absolute_Pos_MM(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_ABS_POSITION, value);
+}
+
+int Read_Position_Deg(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_POS_DEG, value);
+}
 
-    *value = ((float)raw);
+int Read_Position_MM(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_POS_MM, value);
+}
+
+int Read_RPM(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_RPM, value);
+}
+
+/* ---------------- CURRENT / VOLTAGE ---------------- */
+int Read_Current(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_CURRENT, value);
+}
+
+/* ---------------- SAFETY / DEBUG ---------------- */
+/* The limit switch check runs in the decode, like for snapshots */
+int Read_IO_Status(Axis_t axis, uint16_t *raw_io)
+{
+    if (Read_U16(axis, SIG_IO_STATUS, raw_io) != 0)
+    {
+        LOG_ERROR("[ERROR] IO Status read failed!\n");
+        return -1;
+    }
     return 0;
 }
+
+int Read_SystemStatus(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_SYSTEM_STATUS, value);
+}
+
+int Read_DCBusVoltage(Axis_t axis, float *value)
+{
+    return Read_F32(axis, SIG_DCBUS_VOLT, value);
+}
+
 /*----------------------------------------------------------
  * Read and decode fault status bits
  *----------------------------------------------------------*/
 void Read_FaultStatus(Axis_t axis, FaultStatus_t *status)
 {
-    uint8_t rx_buf[8U];
-    //uint16_t addr = GetRegisterAddress(axis,axis1_cfg.FAULT_STATUS,axis2_cfg.FAULT_STATUS);
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
-    uint16_t addr = cfg->FAULT_STATUS;
-
-    (void)MODBUS_ReadInput(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
-
-    uint16_t raw = (uint16_t)(((uint16_t)rx_buf[3U] << 8U) | rx_buf[4U]);
-    status->raw_code = raw;
-
-    status->short_circuit    = (uint8_t)((raw & fault_cfg.SHORT_CKT) != 0U);
-    status->system_ok        = (uint8_t)((raw & fault_cfg.SYSTEM_HEALTHY) != 0U);
-    status->rated_current    = (uint8_t)((raw & fault_cfg.RATED_CURRENT_FAULT) != 0U);
-    status->over_temp        = (uint8_t)((raw & fault_cfg.OVER_TEMP) != 0U);
-    status->over_volt        = (uint8_t)((raw & fault_cfg.OVER_VOLT) != 0U);
-    status->under_volt       = (uint8_t)((raw & fault_cfg.UNDER_VOLT) != 0U);
-    status->motion_error     = (uint8_t)((raw & fault_cfg.MOTION_ERROR) != 0U);
-    status->drive_disable    = (uint8_t)((raw & fault_cfg.DRIVE_DISABLE) != 0U);
-    status->eeprom_error     = (uint8_t)((raw & fault_cfg.EEPROM_ERROR) != 0U);
-    status->commutation_err  = (uint8_t)((raw & fault_cfg.COMMUTATION_ERROR) != 0U);
-    status->lock_rotor       = (uint8_t)((raw & fault_cfg.LOCK_ROTOR) != 0U);
-    status->emergency_err    = (uint8_t)((raw & fault_cfg.EMERGENCY_ERROR) != 0U);
-    status->command_error    = (uint8_t)((raw & fault_cfg.COMMUTATION_ERROR) != 0U);
-    status->motion_complete  = (uint8_t)((raw & fault_cfg.MOTION_COMPLETE) != 0U);
-
-    printf("Axis %u Fault Reg: 0x%04X [Temp=%u]\n", axis, raw, status->over_temp);
+    DriveSnapshot_t snap;
+
+    if (!status)
+        return;
+
+    /* a failed read reports all bits clear, as before */
+    (void)Read_One(axis, SIG_FAULT_STATUS, &snap);
+    *status = snap.fault;
+
+    LOG_DEBUG("Axis %u Fault Reg: 0x%04X [Temp=%u]\n", axis, status->raw_code, status->over_temp);
 }
+
 /* feedback overcurrent protection */
 // void Check_CurrentProtection(Axis_t axis)
 // {
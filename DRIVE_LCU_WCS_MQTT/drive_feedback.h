@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include"ini.h"
 #include"axis_helper.h"
+#include "read_planner.h"
 
 /**
  * @brief Structure representing drive fault and health status
@@ -29,6 +30,28 @@ typedef struct
 
 } FaultStatus_t;
 
+/**
+ * @brief One decoded sample of an axis, filled by a single plan
+ */
+typedef struct
+{
+    uint32_t valid;         /**< SIG_MASK() of the fields filled in */
+
+    float    actual_pos_mm;
+    float    pos_deg;
+    float    pos_mm;
+    float    rpm;
+    float    current;
+    uint16_t io_status;
+    float    system_status;
+    float    dcbus;
+    FaultStatus_t fault;
+
+    uint16_t version;
+    uint16_t revision;
+    uint16_t release;
+} DriveSnapshot_t;
+
 /* ---------------- DRIVE INFO (BOOT / ONCE) ---------------- */
 int Read_Version(Axis_t axis, uint16_t *value);
 int Read_Revision(Axis_t axis, uint16_t *value);
@@ -54,6 +77,27 @@ int Read_DCBusVoltage(Axis_t axis, float *value);
  * @param status Pointer to FaultStatus_t structure to populate
  */
 void Read_FaultStatus(Axis_t axis, FaultStatus_t *status);
+
+/**
+ * @brief Read a set of signals with the fewest block reads
+ * @param axis    Axis to read
+ * @param signals SIG_MASK() set, e.g. SIGSET_CONTINUOUS
+ * @param snap    Filled in; snap->valid marks the decoded fields
+ * @return 0 if every requested signal was read, -1 otherwise
+ */
+int Read_Snapshot(Axis_t axis, uint32_t signals, DriveSnapshot_t *snap);
+
+/**
+ * @brief Read_Snapshot on every drive of the pool at once; all
+ *        drives' block reads are in flight together, and each
+ *        drive is decoded (limit checks included) once its own
+ *        blocks are in
+ * @param snaps One per drive, indexed like the pool
+ * @param count Entries in 'snaps'; drives beyond it are skipped
+ * @return Number of drives whose snapshot is complete, -1 on error
+ */
+int Read_SnapshotAll(Axis_t axis, uint32_t signals,
+                     DriveSnapshot_t *snaps, int count);
 void Check_CurrentProtection(Axis_t axis);
 
 #endif /* DRIVE_FEEDBACK_H */
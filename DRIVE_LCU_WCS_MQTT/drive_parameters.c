@@ -2,8 +2,11 @@
 #include "axis_helper.h"
 #include "drive_parameters.h"
 #include "modbus_functions.h"
+#include "register_shadow.h"
+#include "lcu_log.h"
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <stdbool.h>
 
 static bool Check_SoftwareLimit(Axis_t axis, float target_deg)
@@ -13,14 +16,14 @@ static bool Check_SoftwareLimit(Axis_t axis, float target_deg)
     {
         if (target_deg < cfg->LIMIT_MIN_DEG)
         {
-            printf("[LIMIT] PAN left limit reached: %.2f° < %.2f°\n",
-                    target_deg, cfg->LIMIT_MIN_DEG);
+            LOG_WARN("[LIMIT] PAN left limit reached: %.2f° < %.2f°\n",
+                      target_deg, cfg->LIMIT_MIN_DEG);
             return false;
         }
         if (target_deg > cfg->LIMIT_MAX_DEG)
         {
-            printf("[LIMIT] PAN right limit reached: %.2f° > %.2f°\n",
-                    target_deg, cfg->LIMIT_MAX_DEG);
+            LOG_WARN("[LIMIT] PAN right limit reached: %.2f° > %.2f°\n",
+                      target_deg, cfg->LIMIT_MAX_DEG);
             return false;
         }
     }
@@ -28,14 +31,14 @@ static bool Check_SoftwareLimit(Axis_t axis, float target_deg)
     {
         if (target_deg < cfg->LIMIT_MIN_DEG)
         {
-            printf("[LIMIT] TILT down limit reached: %.2f° < %.2f°\n",
-                    target_deg, cfg->LIMIT_MIN_DEG);
+            LOG_WARN("[LIMIT] TILT down limit reached: %.2f° < %.2f°\n",
+                      target_deg, cfg->LIMIT_MIN_DEG);
             return false;
         }
         if (target_deg >cfg->LIMIT_MAX_DEG)
         {
-            printf("[LIMIT] TILT up limit reached: %.2f° > %.2f°\n",
-                    target_deg,cfg->LIMIT_MAX_DEG);
+            LOG_WARN("[LIMIT] TILT up limit reached: %.2f° > %.2f°\n",
+                      target_deg,cfg->LIMIT_MAX_DEG);
             return false;
         }
     }
@@ -82,15 +85,94 @@ static uint16_t FloatToReg(float value, float scale)
 }
 
 /*----------------------------------------------------------
- * Helper: Read back and verify write (optional)
+ * Helper: Compare a register read-back (0x03 or 0x17 reply)
+ * Returns 0 when all 'count' registers read back as written
  *----------------------------------------------------------*/
-static void VerifyParameterWrite(uint16_t addr)
+static int CheckReadBack(uint16_t addr, const uint16_t *data, uint16_t count,
+                         const uint8_t *rx_buf, int32_t res)
 {
-    uint8_t rx_buf[8U];
-    (void)MODBUS_ReadHolding(modbus_cfg.UNIT_ID, addr, 2U, rx_buf);
+    /* unit, func, byte count, 2 bytes per register */
+    if (res < (int32_t)(3U + 2U * count) || (rx_buf[1U] & 0x80U) != 0U)
+    {
+        LOG_ERROR("   Verify FAILED: [0x%X] no valid response\n", addr);
+        return -1;
+    }
+
+    int ok = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint16_t raw = (uint16_t)(((uint16_t)rx_buf[3U + 2U * i] << 8U) | rx_buf[4U + 2U * i]);
+        if (raw != data[i])
+            ok = -1;
+    }
+
+    uint16_t first = (uint16_t)(((uint16_t)rx_buf[3U] << 8U) | rx_buf[4U]);
+    LOG_DEBUG("   Verified Write: [0x%X] = %u%s\n", addr, first, (ok == 0) ? "" : " (MISMATCH)");
+    return ok;
+}
+
+/*----------------------------------------------------------
+ * Helper: Read back and verify write
+ *----------------------------------------------------------*/
+static int VerifyParameterWrite(uint16_t addr, const uint16_t *data, uint16_t count)
+{
+    uint8_t rx_buf[256U];
+    int32_t res = MODBUS_ReadHolding(POOL_UnitId(), addr, count, rx_buf);
 
-    uint16_t raw = (uint16_t)(((uint16_t)rx_buf[3U] << 8U) | rx_buf[4U]);
-    printf("   Verified Write: [0x%X] = %u\n", addr, raw);
+    return CheckReadBack(addr, data, count, rx_buf, res);
+}
+
+/* 0x17 refused by the drive: exception ILLEGAL FUNCTION */
+static int IsIllegalFunction(const uint8_t *rx_buf, int32_t res)
+{
+    return res >= 5 && (rx_buf[1U] & 0x80U) != 0U && rx_buf[2U] == 0x01U;
+}
+
+/*----------------------------------------------------------
+ * Helper: Write parameter registers through the shadow
+ * Skipped when the drive already holds the values; otherwise
+ * written, verified and remembered once confirmed. The write
+ * and its read-back are one 0x17 request when the drive has it.
+ * Returns 1 skipped, 0 written and verified, -1 failed
+ *----------------------------------------------------------*/
+static int WriteParameter(Axis_t axis, uint16_t addr, const uint16_t *data, uint16_t count)
+{
+    uint8_t rx[256];
+    int32_t res;
+
+    if (SHADOW_Matches(axis, addr, data, count))
+        return 1;
+
+    /* the drive's value is unknown until the read-back agrees */
+    SHADOW_Forget(axis, addr, count);
+
+    if (MODBUS_UseReadWrite())
+    {
+        res = MODBUS_ReadWriteMultiple(POOL_UnitId(), addr, count,
+                                       addr, count, data, rx);
+        if (!IsIllegalFunction(rx, res))
+        {
+            if (CheckReadBack(addr, data, count, rx, res) != 0)
+                return -1;
+
+            SHADOW_Store(axis, addr, data, count);
+            return 0;
+        }
+        /* refused: the engine stops offering 0x17, use 0x10 + 0x03 */
+    }
+
+    res = MODBUS_WriteHolding(POOL_UnitId(), addr, data, count, rx);
+    if (res <= 0 || (rx[1U] & 0x80U) != 0U)
+    {
+        LOG_ERROR("   Write FAILED: [0x%X]\n", addr);
+        return -1;
+    }
+
+    if (VerifyParameterWrite(addr, data, count) != 0)
+        return -1;
+
+    SHADOW_Store(axis, addr, data, count);
+    return 0;
 }
 
 /*----------------------------------------------------------
@@ -135,11 +217,12 @@ static void VerifyParameterWrite(uint16_t addr)
     data[0] = (uint16_t)val;  // first register = position
     data[1] = 0x0000;    // second register = 0 (as you want)
 
-    /* 7) Send Modbus write frame */
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data, 2, rx);
+    /* 7) Send Modbus write frame (target is not shadowed) */
+    SHADOW_Forget(axis, addr, 2U);
+    (void)MODBUS_WriteHolding(POOL_UnitId(), addr, data, 2, rx);
 
-    printf("[MOVE OK] Axis %u -> Target: %.2f mm (Reg 0x%X)\n",
-           axis, target_mm, addr);
+    LOG_INFO("[MOVE OK] Axis %u -> Target: %.2f mm (Reg 0x%X)\n",
+             axis, target_mm, addr);
 }
 //Negative position move
  void Set_Position_Negative(Axis_t axis, float mm)
@@ -182,18 +265,18 @@ static void VerifyParameterWrite(uint16_t addr)
     /* HIGH word second */
     data[1] = (uint16_t)((val >> 16) & 0xFFFF); // second register = 0 (as you want)
 
-    /* 7) Send Modbus write frame */
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data, 2, rx);
+    /* 7) Send Modbus write frame (target is not shadowed) */
+    SHADOW_Forget(axis, addr, 2U);
+    (void)MODBUS_WriteHolding(POOL_UnitId(), addr, data, 2, rx);
 
-    printf("[MOVE OK] Axis %u -> Target: %.2f mm (Reg 0x%X)\n",
-           axis, target_mm, addr);
+    LOG_INFO("[MOVE OK] Axis %u -> Target: %.2f mm (Reg 0x%X)\n",
+             axis, target_mm, addr);
 }
 /*----------------------------------------------------------
  * Set Velocity
  *----------------------------------------------------------*/
 void Set_Velocity(Axis_t axis, float vel)
 {
-    uint8_t rx[256];
     //float vmax = Compute_MaxVelocity();
 
     // if (vel > vmax)
@@ -211,17 +294,17 @@ void Set_Velocity(Axis_t axis, float vel)
     uint16_t data[2];
     data[0] = val;  // first register = position
     data[1] = 0;    // second register = 0 (as you want)
-    MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data,2,rx);
 
-    printf("Axis %u: Set Velocity = %.2f mm/s\n", axis, vel);
-    VerifyParameterWrite(addr);
+    if (WriteParameter(axis, addr, data, 2U) > 0)
+        LOG_DEBUG("Axis %u: Velocity = %.2f mm/s already set\n", axis, vel);
+    else
+        LOG_INFO("Axis %u: Set Velocity = %.2f mm/s\n", axis, vel);
 }
 /*----------------------------------------------------------
  * Set Acceleration
  *----------------------------------------------------------*/
 void Set_Acceleration(Axis_t axis, float accel)
 {
-    uint8_t rx[256];
     // float amax = Compute_MaxAcceleration();
 
     // if (accel > amax)
@@ -239,10 +322,11 @@ void Set_Acceleration(Axis_t axis, float accel)
     uint16_t data[2];
     data[0] = val;  // first register = position
     data[1] = 0;    // second register = 0 (as you want)
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data,2,rx);
 
-    printf("Axis %u: Set Accel = %.2f mm/s²\n", axis, accel);
-    VerifyParameterWrite(addr);
+    if (WriteParameter(axis, addr, data, 2U) > 0)
+        LOG_DEBUG("Axis %u: Accel = %.2f mm/s² already set\n", axis, accel);
+    else
+        LOG_INFO("Axis %u: Set Accel = %.2f mm/s²\n", axis, accel);
 }
 
 
@@ -251,7 +335,6 @@ void Set_Acceleration(Axis_t axis, float accel)
  *----------------------------------------------------------*/
 void Set_Deceleration(Axis_t axis, float decel)
 {
-    uint8_t rx[256];
     //uint16_t addr = GetRegisterAddress(axis, REG_PAN_DECEL, REG_TILT_DECEL);
     AXIS_CONFIG *cfg = GetAxisCfg(axis);
     uint16_t addr = (uint16_t)cfg->DECEL;
@@ -261,10 +344,10 @@ void Set_Deceleration(Axis_t axis, float decel)
     data[0] = val;  // first register = position
     data[1] = 0;    // second register = 0 (as you want)
 
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data,2,rx);
-    printf("Axis %u: Set Decel = %.2f (Reg 0x%X)\n", axis, decel, addr);
-
-    VerifyParameterWrite(addr);
+    if (WriteParameter(axis, addr, data, 2U) > 0)
+        LOG_DEBUG("Axis %u: Decel = %.2f (Reg 0x%X) already set\n", axis, decel, addr);
+    else
+        LOG_INFO("Axis %u: Set Decel = %.2f (Reg 0x%X)\n", axis, decel, addr);
 }
 
 /*----------------------------------------------------------
@@ -272,7 +355,6 @@ void Set_Deceleration(Axis_t axis, float decel)
  *----------------------------------------------------------*/
 void Set_HomeOffset(Axis_t axis, float offset)
 {
-    uint8_t rx[256];
     //uint16_t addr = GetRegisterAddress(axis, REG_PAN_HOME_OFFSET, REG_TILT_HOME_OFFSET);
     AXIS_CONFIG *cfg = GetAxisCfg(axis);
     uint16_t addr = (uint16_t)cfg->HOME_OFFSET;
@@ -282,10 +364,10 @@ void Set_HomeOffset(Axis_t axis, float offset)
     data[0] = val;  // first register = position
     data[1] = 0;    // second register = 0 (as you want)
 
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data,2,rx);
-    printf("Axis %u: Set HomeOffset = %.2f (Reg 0x%X)\n", axis, offset, addr);
-
-    VerifyParameterWrite(addr);
+    if (WriteParameter(axis, addr, data, 2U) > 0)
+        LOG_DEBUG("Axis %u: HomeOffset = %.2f (Reg 0x%X) already set\n", axis, offset, addr);
+    else
+        LOG_INFO("Axis %u: Set HomeOffset = %.2f (Reg 0x%X)\n", axis, offset, addr);
 }
 
 /*----------------------------------------------------------
@@ -322,11 +404,12 @@ void Set_HomeOffset(Axis_t axis, float offset)
     uint16_t data[2];
     data[0] = (uint16_t)val;  // first register = position
     data[1] = 0;    // second register = 0 (as you want)
-    /* 5) Write to modbus register */
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data,2,rx);
+    /* 5) Write to modbus register (target is not shadowed) */
+    SHADOW_Forget(axis, addr, 2U);
+    (void)MODBUS_WriteHolding(POOL_UnitId(), addr, data,2,rx);
 
-    printf("[MOVE OK] Axis %u: Set DegPosition = %.2f° (Reg 0x%X)\n",
-           axis, deg_pos, addr);
+    LOG_INFO("[MOVE OK] Axis %u: Set DegPosition = %.2f° (Reg 0x%X)\n",
+             axis, deg_pos, addr);
 }
 //Negative degree position move
  void Set_DegPosition_Negative(Axis_t axis, float deg_pos)
@@ -359,40 +442,353 @@ void Set_HomeOffset(Axis_t axis, float offset)
     uint16_t data[2];
     data[0] = (uint16_t)(val & 0xFFFF);  // first register = position
     data[1] = (uint16_t)((val >> 16) & 0xFFFF);  
-    /* 5) Write to modbus register */
-    (void)MODBUS_WriteHolding(modbus_cfg.UNIT_ID, addr, data,2,rx);
+    /* 5) Write to modbus register (target is not shadowed) */
+    SHADOW_Forget(axis, addr, 2U);
+    (void)MODBUS_WriteHolding(POOL_UnitId(), addr, data,2,rx);
 
-    printf("[MOVE OK] Axis %u: Set DegPosition = %.2f° (Reg 0x%X)\n",
-           axis, deg_pos, addr);
+    LOG_INFO("[MOVE OK] Axis %u: Set DegPosition = %.2f° (Reg 0x%X)\n",
+             axis, deg_pos, addr);
 }
 /*----------------------------------------------------------
- * Write Multiple Registers (0x10)
- *   position, velocity, acceleration, deceleration
+ * Motion parameter upload
+ *   Every field is a 2-word register pair, LOW word first.
+ *   Fields at adjacent pairs form one run; each run is one
+ *   FC16 write, and all runs go out through the engine together.
+ *   With [MODBUS] VERIFY_MOTION each written run is read back
+ *   once: in the same FC23 request when the drive has it, else
+ *   with one FC03 after all writes are answered.
  *----------------------------------------------------------*/
-void Set_MotionParameters(Axis_t axis, float pos, float vel, float accel, float decel)
+#define MOTION_MAX_FIELDS  4U
+
+typedef struct
 {
-    uint16_t start_addr;
-    uint16_t reg_data[4U]; /* 4 registers */
-    AXIS_CONFIG *cfg = GetAxisCfg(axis);
+    const char *name;
+    uint16_t    addr;
+    int32_t     value;      /* scaled drive value */
+    uint8_t     shadowed;   /* parameter (1) or move target (0) */
+} MotionField_t;
 
-    if (axis == AXIS_PAN)
+typedef struct
+{
+    uint8_t  first;         /* index into the sorted fields */
+    uint8_t  count;
+    uint16_t regs[2U * MOTION_MAX_FIELDS];
+    uint8_t  write;         /* not already held by the drive */
+} MotionRun_t;
+
+static void PutReg32(uint16_t *dst, int32_t value)
+{
+    dst[0] = (uint16_t)((uint32_t)value & 0xFFFFU);   /* LOW word  */
+    dst[1] = (uint16_t)((uint32_t)value >> 16);       /* HIGH word */
+}
+
+static int32_t GetReg32(const uint8_t *src)
+{
+    uint16_t lo = (uint16_t)((src[0] << 8) | src[1]);
+    uint16_t hi = (uint16_t)((src[2] << 8) | src[3]);
+    return (int32_t)(((uint32_t)hi << 16) | lo);
+}
+
+/* Group the fields into runs of adjacent register pairs (sorts 'f') */
+static uint8_t BuildMotionRuns(MotionField_t *f, uint8_t n, MotionRun_t *runs)
+{
+    uint8_t run_count = 0;
+
+    for (uint8_t i = 1; i < n; i++)
+    {
+        MotionField_t key = f[i];
+        uint8_t j = i;
+        while (j > 0 && f[j - 1].addr > key.addr)
+        {
+            f[j] = f[j - 1];
+            j--;
+        }
+        f[j] = key;
+    }
+
+    for (uint8_t i = 0; i < n; i++)
     {
-        start_addr = cfg->POSITION;
+        if (i == 0 || f[i].addr != f[i - 1].addr + 2U)
+        {
+            runs[run_count].first = i;
+            runs[run_count].count = 0;
+            run_count++;
+        }
+
+        MotionRun_t *run = &runs[run_count - 1];
+        PutReg32(&run->regs[2U * run->count], f[i].value);
+        run->count++;
     }
-    else
+    return run_count;
+}
+
+static int RunShadowed(const MotionField_t *f, const MotionRun_t *run)
+{
+    for (uint8_t i = 0; i < run->count; i++)
     {
-        start_addr = cfg->POSITION;
+        if (!f[run->first + i].shadowed)
+            return 0;
     }
+    return 1;
+}
 
-    reg_data[0] = FloatToReg(pos,   100.0F);
-    reg_data[1] = FloatToReg(vel,   1.0F);
-    reg_data[2] = FloatToReg(accel, 1.0F);
-    reg_data[3] = FloatToReg(decel, 1.0F);
+/* Confirmed fields go into the shadow, move targets never do */
+static void RunToShadow(Axis_t axis, const MotionField_t *f, const MotionRun_t *run,
+                        const uint8_t *confirmed)
+{
+    for (uint8_t i = 0; i < run->count; i++)
+    {
+        const MotionField_t *fld = &f[run->first + i];
+        if (fld->shadowed && confirmed[i])
+            SHADOW_Store(axis, fld->addr, &run->regs[2U * i], 2U);
+    }
+}
+
+/* Compare one run's read-back; report per-field mismatches */
+static int CheckMotionRun(Axis_t axis, const MotionField_t *f, const MotionRun_t *run,
+                          const MODBUS_Txn_t *txn, const uint8_t *rx_buf)
+{
+    uint8_t confirmed[MOTION_MAX_FIELDS] = {0};
+    int ok = 0;
 
-    (void)MODBUS_WriteMultiple(modbus_cfg.UNIT_ID, start_addr, 4U, reg_data);
+    if (txn->state != MODBUS_TXN_DONE ||
+        txn->rx_len < (int32_t)(3U + 4U * run->count) ||
+        rx_buf[2] != (uint8_t)(4U * run->count))
+    {
+        LOG_ERROR("   Verify FAILED: [0x%X] no valid response\n", f[run->first].addr);
+        return -1;
+    }
+
+    for (uint8_t i = 0; i < run->count; i++)
+    {
+        const MotionField_t *fld = &f[run->first + i];
+        int32_t got = GetReg32(&rx_buf[3U + 4U * i]);
+
+        confirmed[i] = (got == fld->value);
+        if (!confirmed[i])
+        {
+            LOG_ERROR("   Verify MISMATCH: Axis %u %s [0x%X] wrote %ld read %ld\n",
+                      axis, fld->name, fld->addr, (long)fld->value, (long)got);
+            ok = -1;
+        }
+    }
+    RunToShadow(axis, f, run, confirmed);
+
+    if (ok == 0)
+        LOG_DEBUG("   Verified Write: [0x%X] %u field(s)\n", f[run->first].addr, run->count);
+    return ok;
+}
+
+/* Read every written run back at once */
+static int VerifyMotionRuns(Axis_t axis, const MotionField_t *f,
+                            const MotionRun_t *runs, uint8_t run_count)
+{
+    MODBUS_Txn_t txn[MOTION_MAX_FIELDS];
+    uint8_t rx_buf[MOTION_MAX_FIELDS][MODBUS_MAX_ADU];
+    int ok = 0;
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        txn[r].state = MODBUS_TXN_IDLE;
+        if (!runs[r].write)
+            continue;
+        if (MODBUS_TxnRead(&txn[r], POOL_UnitId(), 0x03,
+                           f[runs[r].first].addr, (uint16_t)(2U * runs[r].count),
+                           rx_buf[r], sizeof(rx_buf[r])) != 0 ||
+            MODBUS_Submit(&txn[r]) != 0)
+        {
+            txn[r].state = MODBUS_TXN_TIMEOUT;
+        }
+    }
+    MODBUS_WaitAll();
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        if (runs[r].write && CheckMotionRun(axis, f, &runs[r], &txn[r], rx_buf[r]) != 0)
+            ok = -1;
+    }
+    return ok;
+}
+
+/*
+ * Write and read back every run in one 0x17 request each. Runs the
+ * drive refuses with ILLEGAL FUNCTION keep 'write' set for the
+ * 0x10 + 0x03 path; all others are finished here.
+ */
+static int ReadWriteMotionRuns(Axis_t axis, const MotionField_t *f,
+                               MotionRun_t *runs, uint8_t run_count)
+{
+    MODBUS_Txn_t txn[MOTION_MAX_FIELDS];
+    uint8_t rx_buf[MOTION_MAX_FIELDS][MODBUS_MAX_ADU];
+    int ok = 0;
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        uint16_t addr = f[runs[r].first].addr;
+        uint16_t regs = (uint16_t)(2U * runs[r].count);
+
+        txn[r].state = MODBUS_TXN_IDLE;
+        if (!runs[r].write)
+            continue;
+        if (MODBUS_TxnReadWrite(&txn[r], POOL_UnitId(),
+                                addr, regs, addr, regs, runs[r].regs,
+                                rx_buf[r], sizeof(rx_buf[r])) != 0 ||
+            MODBUS_Submit(&txn[r]) != 0)
+        {
+            txn[r].state = MODBUS_TXN_TIMEOUT;
+        }
+    }
+    MODBUS_WaitAll();
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        if (!runs[r].write)
+            continue;
+        if (txn[r].state == MODBUS_TXN_DONE && IsIllegalFunction(rx_buf[r], txn[r].rx_len))
+            continue;
+
+        if (CheckMotionRun(axis, f, &runs[r], &txn[r], rx_buf[r]) != 0)
+            ok = -1;
+        runs[r].write = 0;
+    }
+    return ok;
+}
+
+static int UploadMotion(Axis_t axis, MotionField_t *f, uint8_t n)
+{
+    MotionRun_t  runs[MOTION_MAX_FIELDS];
+    MODBUS_Txn_t txn[MOTION_MAX_FIELDS];
+    uint8_t      rx_buf[MOTION_MAX_FIELDS][MODBUS_MAX_ADU];
+    uint8_t      run_count = BuildMotionRuns(f, n, runs);
+    uint8_t      pending   = 0;
+    int          ok        = 0;
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        MotionRun_t *run = &runs[r];
+        uint16_t addr    = f[run->first].addr;
+        uint16_t regs    = (uint16_t)(2U * run->count);
+
+        run->write = !(RunShadowed(f, run) &&
+                       SHADOW_Matches(axis, addr, run->regs, regs));
+        if (!run->write)
+            continue;
+
+        /* the drive's values are unknown until the write is confirmed */
+        SHADOW_Forget(axis, addr, regs);
+        pending++;
+    }
+    if (pending == 0)
+        return 1;
+
+    /* verified upload: write and read-back share a round trip */
+    if (modbus_cfg.VERIFY_MOTION && MODBUS_UseReadWrite())
+    {
+        ok = ReadWriteMotionRuns(axis, f, runs, run_count);
+
+        pending = 0;
+        for (uint8_t r = 0; r < run_count; r++)
+            pending += runs[r].write;
+        if (pending == 0)
+            return ok;
+    }
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        MotionRun_t *run = &runs[r];
+
+        txn[r].state = MODBUS_TXN_IDLE;
+        if (!run->write)
+            continue;
+        if (MODBUS_TxnWriteMultiple(&txn[r], POOL_UnitId(),
+                                    f[run->first].addr, (uint16_t)(2U * run->count),
+                                    run->regs, rx_buf[r], sizeof(rx_buf[r])) != 0 ||
+            MODBUS_Submit(&txn[r]) != 0)
+        {
+            txn[r].state = MODBUS_TXN_TIMEOUT;
+        }
+    }
+    MODBUS_WaitAll();
+
+    for (uint8_t r = 0; r < run_count; r++)
+    {
+        if (!runs[r].write)
+            continue;
+
+        /* exception replies have the high bit of the function code set */
+        if (txn[r].state != MODBUS_TXN_DONE || txn[r].rx_len < 8 ||
+            (rx_buf[r][1] & 0x80U) != 0U)
+        {
+            LOG_ERROR("   Write FAILED: [0x%X]\n", f[runs[r].first].addr);
+            runs[r].write = 0;      /* nothing to verify */
+            ok = -1;
+        }
+        else if (!modbus_cfg.VERIFY_MOTION)
+        {
+            /* no read-back requested: the acknowledgement confirms it */
+            uint8_t confirmed[MOTION_MAX_FIELDS];
+            memset(confirmed, 1, sizeof(confirmed));
+            RunToShadow(axis, f, &runs[r], confirmed);
+        }
+    }
+
+    if (modbus_cfg.VERIFY_MOTION && VerifyMotionRuns(axis, f, runs, run_count) != 0)
+        ok = -1;
+    return ok;
+}
+
+static int UploadMotionTarget(Axis_t axis, const char *target_name, uint16_t target_addr,
+                              float target, float vel, float accel, float decel)
+{
+    AXIS_CONFIG *cfg = GetAxisCfg(axis);
+    if (!cfg)
+        return -1;
+
+    MotionField_t f[MOTION_MAX_FIELDS] =
+    {
+        { target_name, target_addr,              (int32_t)(target * 100.0F), 0U },
+        { "VELOCITY",  (uint16_t)cfg->VELOCITY,  (int32_t)vel,               1U },
+        { "ACCEL",     (uint16_t)cfg->ACCEL,     (int32_t)accel,             1U },
+        { "DECEL",     (uint16_t)cfg->DECEL,     (int32_t)decel,             1U },
+    };
+
+    return UploadMotion(axis, f, MOTION_MAX_FIELDS);
+}
+
+/*----------------------------------------------------------
+ * Write Multiple Registers (0x10)
+ *   position (mm), velocity, acceleration, deceleration
+ *----------------------------------------------------------*/
+int Set_MotionParameters(Axis_t axis, float pos, float vel, float accel, float decel)
+{
+    AXIS_CONFIG *cfg = GetAxisCfg(axis);
+    if (!cfg)
+        return -1;
+
+    int res = UploadMotionTarget(axis, "POSITION", (uint16_t)cfg->POSITION,
+                                 pos, vel, accel, decel);
+
+    LOG_INFO("Axis %u: Motion upload @0x%X Pos=%.2f mm Vel=%.2f Acc=%.2f Dec=%.2f%s\n",
+             axis, cfg->POSITION, pos, vel, accel, decel,
+             (res < 0) ? " FAILED" : (res > 0) ? " (already set)" : "");
+    return (res < 0) ? -1 : 0;
+}
+
+/*----------------------------------------------------------
+ * Write Multiple Registers (0x10)
+ *   degree position, velocity, acceleration, deceleration
+ *----------------------------------------------------------*/
+int Set_MotionParameters_Deg(Axis_t axis, float deg, float vel, float accel, float decel)
+{
+    AXIS_CONFIG *cfg = GetAxisCfg(axis);
+    if (!cfg)
+        return -1;
 
-    printf("Axis %u: Multi-param write @0x%X Pos=%.2f Vel=%.2f Acc=%.2f Dec=%.2f\n",
-           axis, start_addr, pos, vel, accel, decel);
+    int res = UploadMotionTarget(axis, "DEG_POS", (uint16_t)cfg->DEG_POS,
+                                 deg, vel, accel, decel);
 
-    VerifyParameterWrite(start_addr);
+    LOG_INFO("Axis %u: Motion upload @0x%X Deg=%.2f Vel=%.2f Acc=%.2f Dec=%.2f%s\n",
+             axis, cfg->DEG_POS, deg, vel, accel, decel,
+             (res < 0) ? " FAILED" : (res > 0) ? " (already set)" : "");
+    return (res < 0) ? -1 : 0;
 }
@@ -37,16 +37,27 @@ void Set_DegPosition_Positive(Axis_t axis, float deg_pos);
 void Set_DegPosition_Negative(Axis_t axis, float deg_pos);
 
 /**
- * @brief Set motion parameters (position, velocity, acceleration, deceleration)
- *        in one Modbus multi-register command (0x10)
+ * @brief Upload a move: target position (mm), velocity, acceleration
+ *        and deceleration as 2-word registers (LOW word first)
+ *
+ * Fields at adjacent registers go out as one FC16 write, separate
+ * runs are pipelined. With [MODBUS] VERIFY_MOTION the written runs
+ * are read back once (FC03) and each mismatching field is reported.
+ * Velocity, acceleration and deceleration already held by the drive
+ * (register shadow) are not rewritten unless they share a run.
  *
  * @param axis   Axis to command (AXIS_PAN or AXIS_TILT)
- * @param pos    Target position in degrees
+ * @param pos    Target position in mm
  * @param vel    Velocity
  * @param accel  Acceleration
  * @param decel  Deceleration
+ * @return 0 on success, -1 on a failed write or verification
  */
-void Set_MotionParameters(Axis_t axis, float pos, float vel, float accel, float decel);
+int Set_MotionParameters(Axis_t axis, float pos, float vel, float accel, float decel);
 
+/**
+ * @brief As Set_MotionParameters, with the target in degrees (DEG_POS)
+ */
+int Set_MotionParameters_Deg(Axis_t axis, float deg, float vel, float accel, float decel);
 
 #endif /* DRIVE_PARAMETERS_H */
@@ -0,0 +1,114 @@
+#include "drive_pool.h"
+#include "modbus_functions.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if MAX_DRIVES > MODBUS_MAX_LINKS
+#error "MAX_DRIVES exceeds MODBUS_MAX_LINKS"
+#endif
+
+static int pool_selected = 0;
+static PLAT_Mutex_t *pool_lock;
+
+int POOL_Init(void)
+{
+    int opened = 0;
+
+    if (!pool_lock)
+        pool_lock = PLAT_MutexCreate();
+
+    MODBUS_Init();
+
+    for (int i = 0; i < drive_count; i++)
+    {
+        if (MODBUS_Open((uint8_t)i, &drive_cfg[i]) == 0)
+            opened++;
+    }
+
+    (void)POOL_Select(0);
+    printf("[OK] Drive pool: %d of %d drive link(s) open\n", opened, drive_count);
+    return opened;
+}
+
+void POOL_Close(void)
+{
+    MODBUS_Close();
+    pool_selected = 0;
+}
+
+void POOL_Lock(void)
+{
+    if (pool_lock)
+        PLAT_MutexLock(pool_lock);
+}
+
+void POOL_Unlock(void)
+{
+    if (pool_lock)
+        PLAT_MutexUnlock(pool_lock);
+}
+
+int POOL_Count(void)
+{
+    return drive_count;
+}
+
+int POOL_Select(int idx)
+{
+    if (idx < 0 || idx >= drive_count)
+        return -1;
+
+    pool_selected = idx;
+    return MODBUS_Select((uint8_t)idx);
+}
+
+int POOL_Selected(void)
+{
+    return pool_selected;
+}
+
+const DRIVE_CONFIG *POOL_Drive(int idx)
+{
+    if (idx < 0 || idx >= drive_count)
+        return NULL;
+    return &drive_cfg[idx];
+}
+
+int POOL_Find(const char *name)
+{
+    if (!name || name[0] == '\0')
+        return (drive_count > 0) ? 0 : -1;
+
+    for (int i = 0; i < drive_count; i++)
+    {
+        if (strcmp(drive_cfg[i].NAME, name) == 0)
+            return i;
+    }
+
+    /* not a name: accept a plain index */
+    char *end;
+    long idx = strtol(name, &end, 10);
+    if (*end == '\0' && idx >= 0 && idx < drive_count)
+        return (int)idx;
+
+    return -1;
+}
+
+uint8_t POOL_UnitId(void)
+{
+    return (uint8_t)drive_cfg[pool_selected].UNIT_ID;
+}
+
+AXIS_CONFIG *POOL_AxisMap(int axis_no)
+{
+    const DRIVE_CONFIG *drv = &drive_cfg[pool_selected];
+
+    switch (axis_no)
+    {
+        case 1:  return drv->AXIS1_CFG;
+        case 2:  return drv->AXIS2_CFG;
+        default: return NULL;
+    }
+}
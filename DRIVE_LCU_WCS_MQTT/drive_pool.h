@@ -0,0 +1,79 @@
+#ifndef DRIVE_POOL_H
+#define DRIVE_POOL_H
+
+#include <stdint.h>
+#include "ini.h"
+
+/*===========================================================
+ * Drive pool
+ *
+ * One entry per [DRIVE] section of config.ini (or a single drive
+ * built from [NETWORK] / [MODBUS] when there is none). Each drive
+ * has its own Modbus link, register map and shadow. Calls that
+ * name no drive (drive_parameters, drive_feedback, drive_command)
+ * act on the selected one; POOL_Select switches it. All links are
+ * pumped together, so requests to several drives overlap.
+ *
+ * The selection and the Modbus engine belong to one thread at a
+ * time: a thread holds POOL_Lock from its POOL_Select to the end
+ * of the drive calls that follow it.
+ *===========================================================*/
+
+/**
+ * @brief  Open a Modbus link to every configured drive and select
+ *         the first; a drive that is not up only fails its requests
+ * @return Number of drives whose link opened
+ */
+int POOL_Init(void);
+
+/**
+ * @brief  Close every drive link
+ */
+void POOL_Close(void);
+
+/**
+ * @brief  Number of configured drives (at least 1 after ini_load)
+ */
+int POOL_Count(void);
+
+/**
+ * @brief  Make drive 'idx' the target of drive calls
+ * @return 0 on success, -1 if 'idx' is out of range
+ */
+int POOL_Select(int idx);
+
+/**
+ * @brief  Index of the selected drive
+ */
+int POOL_Selected(void);
+
+/**
+ * @brief  Configuration of drive 'idx', or NULL
+ */
+const DRIVE_CONFIG *POOL_Drive(int idx);
+
+/**
+ * @brief  Find a drive by NAME or by index ("0", "1", ...);
+ *         NULL or "" means the first drive
+ * @return Drive index, or -1 if there is no such drive
+ */
+int POOL_Find(const char *name);
+
+/**
+ * @brief  Take / release the pool for a run of drive calls; a no-op
+ *         before POOL_Init
+ */
+void POOL_Lock(void);
+void POOL_Unlock(void);
+
+/**
+ * @brief  Modbus unit ID of the selected drive
+ */
+uint8_t POOL_UnitId(void);
+
+/**
+ * @brief  Register map of axis 1 / 2 of the selected drive
+ */
+AXIS_CONFIG *POOL_AxisMap(int axis_no);
+
+#endif /* DRIVE_POOL_H */
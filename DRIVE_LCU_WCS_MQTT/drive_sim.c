@@ -0,0 +1,809 @@
+/*
+ * drive_sim.c - Modbus RTU-over-UDP drive simulator
+ *
+ * Answers the LCU like the real drive: RTU frames with CRC, one
+ * datagram per request, FC03/04/06/10 (and FC23 unless -n). The
+ * register map comes from the same config.ini ([AXIS1], [AXIS2],
+ * [COMMAND_REGISTERS], [FAULT_BITS], [MOTOR]) so both sides agree.
+ *
+ * Build:  make sim
+ * Run:    bin/drive_sim.exe [options]
+ *
+ *   -c FILE       config file                  (default config.ini)
+ *   -b IP         bind address                 (default 0.0.0.0)
+ *   -p PORT       bind port                    (default DRIVE_PORT_UDP)
+ *   -l MS         reply latency                (default 0)
+ *   -j MS         extra random latency 0..MS   (default 0)
+ *   -d PCT        requests dropped, in %       (default 0)
+ *   -r PCT        replies held back, in %      (default 0)
+ *   -R MS         hold time of a held reply    (default 20)
+ *   -s SEED       random seed, same seed = same run (default 1)
+ *   -f AX:BITS@S  raise fault BITS on axis AX (1/2) after S seconds;
+ *                 repeatable, e.g. -f 1:0x0008@5 (over-temp)
+ *   -n            no FC23: answer it with ILLEGAL FUNCTION
+ *   -v            log every request; print counters every second
+ *
+ * Motion: POS_MOVE / POS_MOVE_DEG / HOME_MOVE_DEG run a trapezoid
+ * toward the target with the uploaded VELOCITY / ACCEL / DECEL;
+ * VEL_FWD / VEL_REV run until HALT or E-STOP. Any fault stops the
+ * axis until RESET.
+ */
+#include "ini.h"
+#include "modbus_crc.h"
+#include "platform.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int sim_socklen_t;
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#define SOCKET          int
+#define INVALID_SOCKET  (-1)
+#define closesocket     close
+typedef socklen_t sim_socklen_t;
+#endif
+
+#define SIM_MAX_ADU        260U
+#define SIM_MAX_PENDING    64U     /* replies waiting for their send time */
+#define SIM_MAX_FAULTS     8U
+#define SIM_TICK_US        1000U   /* motion step while idle */
+
+/* Model constants that config.ini does not carry */
+#define SIM_VERSION        0x0102U
+#define SIM_REVISION       0x0003U
+#define SIM_RELEASE_DATE   0x2410U
+#define SIM_DCBUS_VOLT     48U
+#define SIM_IDLE_CURRENT   0.20F   /* A, enabled and standing */
+#define SIM_AMPS_PER_ACCEL 0.002F  /* A per unit/s² of commanded accel */
+
+/*===========================================================
+ *  Options
+ *===========================================================*/
+typedef struct
+{
+    uint8_t  axis;          /* AXIS_ID 1 or 2 */
+    uint16_t bits;
+    uint32_t at_ms;
+    uint8_t  fired;
+} SimFault_t;
+
+static struct
+{
+    const char *config;
+    const char *bind_ip;
+    int         port;
+    uint32_t    latency_us;
+    uint32_t    jitter_us;
+    uint32_t    drop_pct;
+    uint32_t    reorder_pct;
+    uint32_t    hold_us;
+    uint32_t    seed;
+    int         no_fc23;
+    int         verbose;
+    SimFault_t  faults[SIM_MAX_FAULTS];
+    uint8_t     fault_count;
+} opt = { "config.ini", "0.0.0.0", -1, 0, 0, 0, 0, 20000, 1, 0, 0, { { 0 } }, 0 };
+
+/*===========================================================
+ *  Drive model
+ *===========================================================*/
+typedef enum
+{
+    MOVE_IDLE = 0,
+    MOVE_TO_MM,
+    MOVE_TO_DEG,
+    MOVE_VEL_FWD,
+    MOVE_VEL_REV
+} SimMove_t;
+
+typedef struct
+{
+    AXIS_CONFIG *cfg;
+    int          enabled;
+    SimMove_t    move;
+    float        pos_mm;
+    float        pos_deg;
+    float        target;    /* mm or deg, by 'move' */
+    float        vel;       /* signed, units/s */
+    float        accel_now; /* |dv/dt| of the last step */
+    uint16_t     faults;    /* [FAULT_BITS] currently raised */
+} SimAxis_t;
+
+static uint16_t  holding[65536];
+static uint16_t  input[65536];
+static SimAxis_t axes[2];
+static uint16_t  solenoid;
+
+static struct
+{
+    uint32_t requests;
+    uint32_t replies;
+    uint32_t dropped;
+    uint32_t held;
+    uint32_t bad_crc;
+    uint32_t exceptions;
+} sim_stats;
+
+/*===========================================================
+ *  Reproducible randomness (xorshift32)
+ *===========================================================*/
+static uint32_t sim_rand_state;
+
+static uint32_t SIM_Rand(void)
+{
+    uint32_t x = sim_rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    sim_rand_state = x;
+    return x;
+}
+
+static int SIM_Chance(uint32_t pct)
+{
+    return pct > 0 && (SIM_Rand() % 100U) < pct;
+}
+
+/*===========================================================
+ *  Register helpers
+ *===========================================================*/
+
+/* 2-word field, LOW word first, as the LCU writes them */
+static int32_t SIM_Get32(uint16_t addr)
+{
+    return (int32_t)(((uint32_t)holding[(uint16_t)(addr + 1U)] << 16) | holding[addr]);
+}
+
+static void SIM_PutInput(int addr, int32_t value)
+{
+    if (addr <= 0 || addr > 0xFFFE)
+        return;
+    input[addr]     = (uint16_t)((uint32_t)value & 0xFFFFU);
+    input[addr + 1] = (uint16_t)((uint32_t)value >> 16);
+}
+
+static SimAxis_t *SIM_AxisById(uint16_t id)
+{
+    if (id == 1U) return &axes[0];
+    if (id == 2U) return &axes[1];
+    return NULL;
+}
+
+/*===========================================================
+ *  Motion
+ *===========================================================*/
+static void SIM_Stop(SimAxis_t *ax)
+{
+    ax->move = MOVE_IDLE;
+    ax->vel  = 0.0F;
+}
+
+static void SIM_Step(SimAxis_t *ax, float dt)
+{
+    float vmax  = fabsf((float)SIM_Get32((uint16_t)ax->cfg->VELOCITY));
+    float accel = fabsf((float)SIM_Get32((uint16_t)ax->cfg->ACCEL));
+    float decel = fabsf((float)SIM_Get32((uint16_t)ax->cfg->DECEL));
+    float v0    = ax->vel;
+
+    if (accel <= 0.0F) accel = vmax * 4.0F;
+    if (decel <= 0.0F) decel = accel;
+
+    if (ax->move == MOVE_IDLE || !ax->enabled || ax->faults != 0U)
+    {
+        SIM_Stop(ax);
+        ax->accel_now = 0.0F;
+        return;
+    }
+
+    float *pos = (ax->move == MOVE_TO_MM) ? &ax->pos_mm : &ax->pos_deg;
+    float  want;
+
+    if (ax->move == MOVE_VEL_FWD || ax->move == MOVE_VEL_REV)
+    {
+        want = (ax->move == MOVE_VEL_FWD) ? vmax : -vmax;
+    }
+    else
+    {
+        /* fastest speed that can still stop at the target */
+        float dist = ax->target - *pos;
+        float vstop = sqrtf(2.0F * decel * fabsf(dist));
+        want = (vstop < vmax) ? vstop : vmax;
+        if (dist < 0.0F)
+            want = -want;
+    }
+
+    float dv_max = ((fabsf(want) < fabsf(v0)) ? decel : accel) * dt;
+    if (want > v0 + dv_max)      ax->vel = v0 + dv_max;
+    else if (want < v0 - dv_max) ax->vel = v0 - dv_max;
+    else                         ax->vel = want;
+
+    float next = *pos + ax->vel * dt;
+
+    if (ax->move == MOVE_TO_MM || ax->move == MOVE_TO_DEG)
+    {
+        /* arrived, or stepped past the target */
+        if ((ax->target - *pos) * (ax->target - next) <= 0.0F ||
+            fabsf(ax->target - next) < 0.005F)
+        {
+            next = ax->target;
+            SIM_Stop(ax);
+        }
+    }
+    *pos = next;
+    ax->accel_now = (dt > 0.0F) ? fabsf(ax->vel - v0) / dt : 0.0F;
+}
+
+/* Limit inputs in the IO status byte, as drive_feedback.c reads them */
+static uint16_t SIM_LimitInputs(const SimAxis_t *ax)
+{
+    uint16_t lo = (ax == &axes[0]) ? (1U << 0) : (1U << 3);
+    uint16_t hi = (ax == &axes[0]) ? (1U << 1) : (1U << 4);
+    uint16_t io = 0;
+
+    if (ax->pos_deg < ax->cfg->LIMIT_MIN_DEG) io |= lo;
+    if (ax->pos_deg > ax->cfg->LIMIT_MAX_DEG) io |= hi;
+    return io;
+}
+
+static uint16_t SIM_Status(const SimAxis_t *ax)
+{
+    uint16_t st = ax->faults;
+
+    if (ax->faults == 0U)
+        st |= (uint16_t)fault_cfg.SYSTEM_HEALTHY;
+    if (!ax->enabled)
+        st |= (uint16_t)fault_cfg.DRIVE_DISABLE;
+    if (ax->move == MOVE_IDLE)
+        st |= (uint16_t)fault_cfg.MOTION_COMPLETE;
+    return st;
+}
+
+/* Refresh the input registers from the model */
+static void SIM_Publish(void)
+{
+    uint16_t io = (uint16_t)(solenoid & 0xFF00U);
+
+    for (int i = 0; i < 2; i++)
+    {
+        SimAxis_t   *ax  = &axes[i];
+        AXIS_CONFIG *cfg = ax->cfg;
+        float rpm = 0.0F;
+        float amps = 0.0F;
+
+        if (motor_cfg.DPMR_MM > 0.0F)
+            rpm = fabsf(ax->vel) * 60.0F / motor_cfg.DPMR_MM;
+        if (ax->enabled)
+            amps = SIM_IDLE_CURRENT + ax->accel_now * SIM_AMPS_PER_ACCEL;
+
+        io |= SIM_LimitInputs(ax);
+
+        SIM_PutInput(cfg->VERSION,        SIM_VERSION);
+        SIM_PutInput(cfg->REVISION,       SIM_REVISION);
+        SIM_PutInput(cfg->RELEASE_DATE,   SIM_RELEASE_DATE);
+        SIM_PutInput(cfg->ABS_POSITION,   (int32_t)(ax->pos_mm * 100.0F));
+        SIM_PutInput(cfg->POS_DEG,        (int32_t)(ax->pos_deg * 100.0F));
+        SIM_PutInput(cfg->POS_MM,         (int32_t)(ax->pos_mm * 100.0F));
+        SIM_PutInput(cfg->RPM,            (int32_t)rpm);
+        SIM_PutInput(cfg->ACTUAL_CURRENT, (int32_t)(amps * 100.0F));
+        SIM_PutInput(cfg->DCBUS_VOLT_CMD, SIM_DCBUS_VOLT);
+        SIM_PutInput(cfg->SYSTEM_STATUS,  SIM_Status(ax));
+        SIM_PutInput(cfg->FAULT_STATUS,   SIM_Status(ax));
+    }
+
+    /* IO_STATUS may be shared by both axes (422 in the stock config) */
+    for (int i = 0; i < 2; i++)
+        SIM_PutInput(axes[i].cfg->IO_STATUS, io);
+}
+
+static void SIM_Advance(uint64_t now_us)
+{
+    static uint64_t last_us;
+    float dt = (last_us == 0) ? 0.0F : (float)(now_us - last_us) / 1e6F;
+    last_us = now_us;
+
+    /* scheduled fault injection */
+    uint32_t now_ms = (uint32_t)(now_us / 1000ULL);
+    static uint32_t start_ms;
+    if (start_ms == 0)
+        start_ms = now_ms ? now_ms : 1U;
+
+    for (uint8_t i = 0; i < opt.fault_count; i++)
+    {
+        SimFault_t *f = &opt.faults[i];
+        SimAxis_t  *ax = SIM_AxisById(f->axis);
+        if (f->fired || !ax || now_ms - start_ms < f->at_ms)
+            continue;
+        f->fired = 1;
+        ax->faults |= f->bits;
+        printf("[SIM] fault 0x%04X raised on axis %u\n", f->bits, f->axis);
+        fflush(stdout);
+    }
+
+    for (int i = 0; i < 2; i++)
+        SIM_Step(&axes[i], dt);
+    SIM_Publish();
+}
+
+/*===========================================================
+ *  Commands (FC06 to [COMMAND_REGISTERS])
+ *===========================================================*/
+static void SIM_CommandAxis(SimAxis_t *ax, uint16_t reg)
+{
+    AXIS_CONFIG *cfg = ax->cfg;
+
+    if (reg == cmd_regs.CMD_ENABLE)
+        ax->enabled = 1;
+    else if (reg == cmd_regs.CMD_DISABLE)
+    {
+        ax->enabled = 0;
+        SIM_Stop(ax);
+    }
+    else if (reg == cmd_regs.CMD_RESET)
+        ax->faults = 0;
+    else if (reg == cmd_regs.CMD_HALT)
+    {
+        /* ramp down at DECEL: stop where the ramp ends */
+        if (ax->move != MOVE_IDLE)
+        {
+            float decel = fabsf((float)SIM_Get32((uint16_t)cfg->DECEL));
+            float stop  = (decel > 0.0F) ? ax->vel * fabsf(ax->vel) / (2.0F * decel) : 0.0F;
+            int   mm    = (ax->move == MOVE_TO_MM);
+            ax->target  = (mm ? ax->pos_mm : ax->pos_deg) + stop;
+            ax->move    = mm ? MOVE_TO_MM : MOVE_TO_DEG;
+        }
+    }
+    else if (reg == cmd_regs.CMD_EMG_STOP)
+    {
+        SIM_Stop(ax);
+        ax->faults |= (uint16_t)fault_cfg.EMERGENCY_ERROR;
+    }
+    else if (reg == cmd_regs.CMD_POS_MOVE)
+    {
+        ax->target = (float)SIM_Get32((uint16_t)cfg->POSITION) / 100.0F;
+        ax->move   = MOVE_TO_MM;
+    }
+    else if (reg == cmd_regs.CMD_POS_MOVE_DEG)
+    {
+        ax->target = (float)SIM_Get32((uint16_t)cfg->DEG_POS) / 100.0F;
+        ax->move   = MOVE_TO_DEG;
+    }
+    else if (reg == cmd_regs.CMD_HOME_MOVE_DEG)
+    {
+        ax->target = (float)SIM_Get32((uint16_t)cfg->HOME_OFFSET) / 100.0F;
+        ax->move   = MOVE_TO_DEG;
+    }
+    else if (reg == cmd_regs.CMD_VEL_FWD)
+        ax->move = MOVE_VEL_FWD;
+    else if (reg == cmd_regs.CMD_VEL_REV)
+        ax->move = MOVE_VEL_REV;
+
+    if (ax->move != MOVE_IDLE && (!ax->enabled || ax->faults != 0U))
+    {
+        /* refused like the drive does: flag it, stay put */
+        ax->faults |= (uint16_t)fault_cfg.COMMAND_ERROR;
+        SIM_Stop(ax);
+    }
+}
+
+static void SIM_WriteRegister(uint16_t addr, uint16_t value)
+{
+    holding[addr] = value;
+
+    if (addr == cmd_regs.CMD_SOLENOID)
+    {
+        solenoid = value;
+        return;
+    }
+
+    int is_cmd = (addr == cmd_regs.CMD_HALT || addr == cmd_regs.CMD_EMG_STOP ||
+                  addr == cmd_regs.CMD_DISABLE || addr == cmd_regs.CMD_ENABLE ||
+                  addr == cmd_regs.CMD_RESET || addr == cmd_regs.CMD_POS_MOVE ||
+                  addr == cmd_regs.CMD_HOME_MOVE_DEG || addr == cmd_regs.CMD_VEL_FWD ||
+                  addr == cmd_regs.CMD_VEL_REV || addr == cmd_regs.CMD_POS_MOVE_DEG);
+    if (!is_cmd)
+        return;
+
+    /* value selects the axis: 1, 2 or 3 = both (see drive_command.c) */
+    if (value == 1U || value == 3U)
+        SIM_CommandAxis(&axes[0], addr);
+    if (value == 2U || value == 3U)
+        SIM_CommandAxis(&axes[1], addr);
+}
+
+/*===========================================================
+ *  Modbus PDU handling
+ *===========================================================*/
+static uint16_t SIM_Be16(const uint8_t *p)
+{
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static int SIM_Exception(const uint8_t *req, uint8_t code, uint8_t *rsp)
+{
+    rsp[0] = req[0];
+    rsp[1] = (uint8_t)(req[1] | 0x80U);
+    rsp[2] = code;
+    sim_stats.exceptions++;
+    return 3;
+}
+
+static int SIM_ReadRegs(const uint16_t *bank, uint16_t addr, uint16_t count,
+                        const uint8_t *req, uint8_t *rsp)
+{
+    if (count == 0 || count > 125U)
+        return SIM_Exception(req, 0x03, rsp);
+    if ((uint32_t)addr + count > 0x10000U)
+        return SIM_Exception(req, 0x02, rsp);
+
+    rsp[0] = req[0];
+    rsp[1] = req[1];
+    rsp[2] = (uint8_t)(count * 2U);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        rsp[3U + 2U * i] = (uint8_t)(bank[addr + i] >> 8);
+        rsp[4U + 2U * i] = (uint8_t)(bank[addr + i] & 0xFFU);
+    }
+    return 3 + 2 * count;
+}
+
+/* Build the reply PDU (without CRC); 0 = no reply */
+static int SIM_Handle(const uint8_t *req, int len, uint8_t *rsp)
+{
+    uint8_t func = req[1];
+
+    switch (func)
+    {
+        case 0x03:
+        case 0x04:
+            if (len != 6)
+                return 0;
+            return SIM_ReadRegs((func == 0x03) ? holding : input,
+                                SIM_Be16(&req[2]), SIM_Be16(&req[4]), req, rsp);
+
+        case 0x06:
+            if (len != 6)
+                return 0;
+            SIM_WriteRegister(SIM_Be16(&req[2]), SIM_Be16(&req[4]));
+            memcpy(rsp, req, 6);
+            return 6;
+
+        case 0x10:
+        {
+            uint16_t addr  = SIM_Be16(&req[2]);
+            uint16_t count = SIM_Be16(&req[4]);
+            if (len < 7 || count == 0 || count > 123U ||
+                req[6] != count * 2U || len != 7 + count * 2)
+                return SIM_Exception(req, 0x03, rsp);
+
+            for (uint16_t i = 0; i < count; i++)
+                SIM_WriteRegister((uint16_t)(addr + i), SIM_Be16(&req[7U + 2U * i]));
+            memcpy(rsp, req, 6);
+            return 6;
+        }
+
+        case 0x17:
+        {
+            if (opt.no_fc23)
+                return SIM_Exception(req, 0x01, rsp);
+
+            uint16_t rd_addr = SIM_Be16(&req[2]);
+            uint16_t rd_num  = SIM_Be16(&req[4]);
+            uint16_t wr_addr = SIM_Be16(&req[6]);
+            uint16_t wr_num  = SIM_Be16(&req[8]);
+            if (len < 11 || wr_num == 0 || wr_num > 121U ||
+                req[10] != wr_num * 2U || len != 11 + wr_num * 2)
+                return SIM_Exception(req, 0x03, rsp);
+
+            /* the write happens before the read */
+            for (uint16_t i = 0; i < wr_num; i++)
+                SIM_WriteRegister((uint16_t)(wr_addr + i), SIM_Be16(&req[11U + 2U * i]));
+            return SIM_ReadRegs(holding, rd_addr, rd_num, req, rsp);
+        }
+
+        default:
+            return SIM_Exception(req, 0x01, rsp);
+    }
+}
+
+/*===========================================================
+ *  Impaired link: replies wait in a queue until their send time
+ *===========================================================*/
+typedef struct
+{
+    uint64_t           due_us;
+    struct sockaddr_in to;
+    uint8_t            data[SIM_MAX_ADU];
+    int                len;
+} SimReply_t;
+
+static SimReply_t pending[SIM_MAX_PENDING];
+static uint8_t    pending_count;
+
+static void SIM_Queue(const struct sockaddr_in *to, const uint8_t *pdu, int len,
+                      uint64_t now_us)
+{
+    if (pending_count == SIM_MAX_PENDING)
+    {
+        sim_stats.dropped++;
+        return;
+    }
+
+    uint64_t delay = opt.latency_us;
+    if (opt.jitter_us > 0)
+        delay += SIM_Rand() % (opt.jitter_us + 1U);
+    if (SIM_Chance(opt.reorder_pct))
+    {
+        /* held back long enough for later replies to overtake it */
+        delay += opt.hold_us;
+        sim_stats.held++;
+    }
+
+    SimReply_t *r = &pending[pending_count++];
+    r->due_us = now_us + delay;
+    r->to     = *to;
+    memcpy(r->data, pdu, (size_t)len);
+
+    uint16_t crc = MODBUS_CRC16(r->data, (size_t)len);
+    r->data[len]     = (uint8_t)(crc & 0xFFU);    /* CRC low byte first */
+    r->data[len + 1] = (uint8_t)(crc >> 8);
+    r->len = len + 2;
+}
+
+static void SIM_SendDue(SOCKET s, uint64_t now_us)
+{
+    uint8_t i = 0;
+
+    while (i < pending_count)
+    {
+        SimReply_t *r = &pending[i];
+        if (r->due_us > now_us)
+        {
+            i++;
+            continue;
+        }
+
+        (void)sendto(s, (const char *)r->data, r->len, 0,
+                     (const struct sockaddr *)&r->to, sizeof(r->to));
+        sim_stats.replies++;
+
+        memmove(r, r + 1, (size_t)(pending_count - i - 1U) * sizeof(*r));
+        pending_count--;
+    }
+}
+
+static uint64_t SIM_NextDue(void)
+{
+    uint64_t next = 0;
+    for (uint8_t i = 0; i < pending_count; i++)
+    {
+        if (next == 0 || pending[i].due_us < next)
+            next = pending[i].due_us;
+    }
+    return next;
+}
+
+static void SIM_Receive(SOCKET s, uint64_t now_us)
+{
+    uint8_t req[SIM_MAX_ADU];
+    uint8_t rsp[SIM_MAX_ADU];
+    struct sockaddr_in from;
+    sim_socklen_t from_len = sizeof(from);
+
+    int len = (int)recvfrom(s, (char *)req, sizeof(req), 0,
+                            (struct sockaddr *)&from, &from_len);
+    if (len < 4)
+        return;
+
+    sim_stats.requests++;
+    if (!MODBUS_CRC_Valid(req, (size_t)len))
+    {
+        sim_stats.bad_crc++;
+        return;
+    }
+    if (req[0] != (uint8_t)modbus_cfg.UNIT_ID)
+        return;
+
+    if (opt.verbose)
+    {
+        printf("[SIM] rx ");
+        for (int i = 0; i < len; i++)
+            printf("%02X ", req[i]);
+        printf("\n");
+    }
+
+    /* lost on the way in: the drive never sees it */
+    if (SIM_Chance(opt.drop_pct))
+    {
+        sim_stats.dropped++;
+        return;
+    }
+
+    SIM_Advance(now_us);
+    int rsp_len = SIM_Handle(req, len - 2, rsp);
+    if (rsp_len > 0)
+        SIM_Queue(&from, rsp, rsp_len, now_us);
+}
+
+/*===========================================================
+ *  Start-up
+ *===========================================================*/
+static void SIM_Usage(void)
+{
+    printf("usage: drive_sim [-c config.ini] [-b ip] [-p port] [-l ms] [-j ms]\n"
+           "                 [-d pct] [-r pct] [-R ms] [-s seed] [-f ax:bits@s]... [-n] [-v]\n");
+}
+
+static int SIM_ParseFault(const char *arg)
+{
+    unsigned ax;
+    int      bits;
+    double   at_s;
+
+    if (opt.fault_count == SIM_MAX_FAULTS ||
+        sscanf(arg, "%u:%i@%lf", &ax, &bits, &at_s) != 3 ||
+        (ax != 1U && ax != 2U) || at_s < 0.0)
+        return -1;
+
+    SimFault_t *f = &opt.faults[opt.fault_count++];
+    f->axis  = (uint8_t)ax;
+    f->bits  = (uint16_t)bits;
+    f->at_ms = (uint32_t)(at_s * 1000.0);
+    return 0;
+}
+
+static int SIM_ParseArgs(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int takes = 1;
+
+        if (strcmp(a, "-n") == 0)      { opt.no_fc23 = 1; takes = 0; }
+        else if (strcmp(a, "-v") == 0) { opt.verbose = 1; takes = 0; }
+        else if (!v)                   return -1;
+        else if (strcmp(a, "-c") == 0) opt.config      = v;
+        else if (strcmp(a, "-b") == 0) opt.bind_ip     = v;
+        else if (strcmp(a, "-p") == 0) opt.port        = atoi(v);
+        else if (strcmp(a, "-l") == 0) opt.latency_us  = (uint32_t)(atof(v) * 1000.0);
+        else if (strcmp(a, "-j") == 0) opt.jitter_us   = (uint32_t)(atof(v) * 1000.0);
+        else if (strcmp(a, "-d") == 0) opt.drop_pct    = (uint32_t)atoi(v);
+        else if (strcmp(a, "-r") == 0) opt.reorder_pct = (uint32_t)atoi(v);
+        else if (strcmp(a, "-R") == 0) opt.hold_us     = (uint32_t)(atof(v) * 1000.0);
+        else if (strcmp(a, "-s") == 0) opt.seed        = (uint32_t)strtoul(v, NULL, 0);
+        else if (strcmp(a, "-f") == 0) { if (SIM_ParseFault(v) != 0) return -1; }
+        else                           return -1;
+
+        i += takes;
+    }
+    return 0;
+}
+
+static SOCKET SIM_Open(void)
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+    {
+        printf("[ERROR] WSAStartup failed\n");
+        return INVALID_SOCKET;
+    }
+#endif
+
+    SOCKET s = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s == INVALID_SOCKET)
+    {
+        printf("[ERROR] Failed to create UDP socket\n");
+        return INVALID_SOCKET;
+    }
+
+    struct sockaddr_in local;
+    memset(&local, 0, sizeof(local));
+    local.sin_family      = AF_INET;
+    local.sin_port        = htons((uint16_t)opt.port);
+    local.sin_addr.s_addr = inet_addr(opt.bind_ip);
+
+    if (bind(s, (struct sockaddr *)&local, sizeof(local)) != 0)
+    {
+        printf("[ERROR] Failed to bind %s:%d\n", opt.bind_ip, opt.port);
+        closesocket(s);
+        return INVALID_SOCKET;
+    }
+    return s;
+}
+
+static void SIM_Init(void)
+{
+    axes[0].cfg = &axis1_cfg;
+    axes[1].cfg = &axis2_cfg;
+    sim_rand_state = opt.seed ? opt.seed : 1U;
+    SIM_Publish();
+}
+
+static void SIM_PrintStats(void)
+{
+    printf("[SIM] req=%u rsp=%u drop=%u held=%u crc=%u exc=%u | "
+           "ax1 %.2f mm %.2f deg | ax2 %.2f mm %.2f deg\n",
+           sim_stats.requests, sim_stats.replies, sim_stats.dropped,
+           sim_stats.held, sim_stats.bad_crc, sim_stats.exceptions,
+           axes[0].pos_mm, axes[0].pos_deg, axes[1].pos_mm, axes[1].pos_deg);
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    if (SIM_ParseArgs(argc, argv) != 0)
+    {
+        SIM_Usage();
+        return 1;
+    }
+
+    if (ini_load(opt.config) != 0)
+    {
+        printf("ERROR: %s load failed\n", opt.config);
+        return 1;
+    }
+    if (opt.port < 0)
+        opt.port = net_cfg.DRIVE_PORT_UDP;
+
+    MODBUS_CRC_Init();
+    SIM_Init();
+
+    SOCKET s = SIM_Open();
+    if (s == INVALID_SOCKET)
+        return 1;
+
+    printf("[SIM] drive on %s:%d unit %d | latency %u+%u us, drop %u%%, hold %u%% x %u us, seed %u%s\n",
+           opt.bind_ip, opt.port, modbus_cfg.UNIT_ID,
+           opt.latency_us, opt.jitter_us, opt.drop_pct,
+           opt.reorder_pct, opt.hold_us, opt.seed,
+           opt.no_fc23 ? ", no FC23" : "");
+
+    uint64_t next_stats_us = PLAT_TimeUs() + 1000000ULL;
+
+    for (;;)
+    {
+        uint64_t now_us = PLAT_TimeUs();
+        uint64_t due    = SIM_NextDue();
+        uint64_t wait   = SIM_TICK_US * 10U;
+
+        if (due != 0)
+            wait = (due > now_us) ? due - now_us : 0;
+
+        fd_set fds;
+        FD_ZERO(&fds);
+        FD_SET(s, &fds);
+        struct timeval tv;
+        tv.tv_sec  = (long)(wait / 1000000ULL);
+        tv.tv_usec = (long)(wait % 1000000ULL);
+
+        int ready = select((int)s + 1, &fds, NULL, NULL, &tv);
+
+        now_us = PLAT_TimeUs();
+        if (ready > 0)
+            SIM_Receive(s, now_us);
+        else
+            SIM_Advance(now_us);
+        SIM_SendDue(s, now_us);
+
+        if (opt.verbose && now_us >= next_stats_us)
+        {
+            SIM_PrintStats();
+            next_stats_us = now_us + 1000000ULL;
+        }
+    }
+
+    closesocket(s);
+    return 0;
+}
@@ -0,0 +1,377 @@
+#include "flight_recorder.h"
+#include "telemetry_acq.h"
+#include "drive_pool.h"
+#include "mqtt_client.h"
+#include "platform.h"
+#include "lcu_log.h"
+#include "ini.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define REC_RING_MASK  (REC_RING_SIZE - 1U)
+#define REC_CHUNK_MIN  64U
+
+/*===========================================================
+ *  Rings
+ *  Only the acquisition thread writes them, and only while no
+ *  capture is frozen; the publisher thread reads them only while
+ *  one is. rec_state hands them over (release / acquire), so
+ *  neither side ever waits for the other.
+ *===========================================================*/
+typedef struct
+{
+    uint64_t t_us;
+    uint16_t valid;             /* SIG_MASK() of the fields below */
+    uint16_t io_status;
+    uint16_t fault_raw;
+    float    actual_pos_mm;
+    float    pos_deg;
+    float    pos_mm;
+    float    rpm;
+    float    current;
+    float    dcbus;
+} REC_Sample_t;
+
+typedef struct
+{
+    REC_Sample_t rec[REC_RING_SIZE];
+    uint32_t     head;          /* samples written */
+} REC_Ring_t;
+
+#define REC_SIGNALS  (SIG_MASK(SIG_ABS_POSITION) | SIG_MASK(SIG_POS_DEG) |   \
+                      SIG_MASK(SIG_POS_MM) | SIG_MASK(SIG_RPM) |            \
+                      SIG_MASK(SIG_CURRENT) | SIG_MASK(SIG_IO_STATUS) |     \
+                      SIG_MASK(SIG_DCBUS_VOLT) | SIG_MASK(SIG_FAULT_STATUS))
+
+typedef enum
+{
+    REC_ARMED = 0,              /* recording, a trigger may start a capture */
+    REC_CLAIMED,                /* a trigger is filling in rec_capture      */
+    REC_TRIGGERED,              /* recording the post window                */
+    REC_FROZEN                  /* rings held for REC_Service               */
+} REC_State_t;
+
+typedef struct
+{
+    uint32_t id;
+    uint8_t  cause;
+    uint8_t  drive;
+    uint8_t  axis;
+    uint16_t detail;
+    uint32_t pre_ms;
+    uint32_t post_ms;
+    uint64_t trigger_us;
+    uint64_t wall;              /* unix time, for the file name and header */
+} REC_Capture_t;
+
+static REC_Ring_t    rec_rings[MAX_DRIVES][ACQ_AXES];
+static atomic_int    rec_state;
+static REC_Capture_t rec_capture;   /* written by the trigger that won */
+static uint32_t      rec_captures;
+
+static const char *REC_CauseName(uint8_t cause)
+{
+    switch (cause)
+    {
+        case REC_CAUSE_FAULT:    return "fault";
+        case REC_CAUSE_LIMIT:    return "limit";
+        case REC_CAUSE_OPERATOR: return "operator";
+        default:                 return "unknown";
+    }
+}
+
+/*===========================================================
+ *  Recording (acquisition thread) and triggers (any thread)
+ *===========================================================*/
+void REC_Record(int drive, Axis_t axis, const DriveSnapshot_t *snap, uint64_t t_us)
+{
+    int a = ACQ_AXIS_INDEX(axis);
+
+    if (!recorder_cfg.ENABLE || drive < 0 || drive >= MAX_DRIVES ||
+        a < 0 || a >= (int)ACQ_AXES)
+        return;
+
+    int state = atomic_load_explicit(&rec_state, memory_order_acquire);
+    if (state == REC_FROZEN)
+        return;
+    if (state == REC_TRIGGERED &&
+        t_us >= rec_capture.trigger_us + (uint64_t)rec_capture.post_ms * 1000U)
+    {
+        atomic_store_explicit(&rec_state, REC_FROZEN, memory_order_release);
+        return;
+    }
+
+    REC_Ring_t   *ring = &rec_rings[drive][a];
+    REC_Sample_t *s    = &ring->rec[ring->head & REC_RING_MASK];
+
+    s->t_us          = t_us;
+    s->valid         = (uint16_t)(snap->valid & REC_SIGNALS);
+    s->io_status     = snap->io_status;
+    s->fault_raw     = snap->fault.raw_code;
+    s->actual_pos_mm = snap->actual_pos_mm;
+    s->pos_deg       = snap->pos_deg;
+    s->pos_mm        = snap->pos_mm;
+    s->rpm           = snap->rpm;
+    s->current       = snap->current;
+    s->dcbus         = snap->dcbus;
+    ring->head++;
+}
+
+int REC_Trigger(REC_Cause_t cause, int drive, Axis_t axis, uint16_t detail)
+{
+    int expected = REC_ARMED;
+
+    if (!recorder_cfg.ENABLE ||
+        !atomic_compare_exchange_strong(&rec_state, &expected, REC_CLAIMED))
+        return -1;
+
+    rec_capture.id         = ++rec_captures;
+    rec_capture.cause      = (uint8_t)cause;
+    rec_capture.drive      = (uint8_t)drive;
+    rec_capture.axis       = (uint8_t)axis;
+    rec_capture.detail     = detail;
+    rec_capture.pre_ms     = (recorder_cfg.PRE_MS > 0) ? (uint32_t)recorder_cfg.PRE_MS : 0U;
+    rec_capture.post_ms    = (recorder_cfg.POST_MS > 0) ? (uint32_t)recorder_cfg.POST_MS : 0U;
+    rec_capture.trigger_us = PLAT_TimeUs();
+    rec_capture.wall       = (uint64_t)time(NULL);
+
+    atomic_store_explicit(&rec_state, REC_TRIGGERED, memory_order_release);
+
+    LOG_WARN("[REC] Capture %u: %s on drive %d axis %d (0x%04X)\n",
+             rec_capture.id, REC_CauseName(rec_capture.cause), drive, (int)axis,
+             detail);
+    return 0;
+}
+
+/*===========================================================
+ *  Output (publisher thread): the image goes to the file and
+ *  the MQTT chunks as it is serialized, with no copy of it
+ *===========================================================*/
+typedef struct
+{
+    FILE     *file;
+    uint32_t  chunk_bytes;      /* payload per message, 0 = no upload */
+    uint32_t  fill;
+    uint16_t  index;
+    uint16_t  count;
+    uint32_t  total;
+    int       failed;
+    uint8_t   chunk[REC_CHUNK_HEADER + REC_CHUNK_MAX];
+} REC_Out_t;
+
+static uint8_t *REC_Put16(uint8_t *p, uint16_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    return p + 2;
+}
+
+static uint8_t *REC_Put32(uint8_t *p, uint32_t v)
+{
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+    return p + 4;
+}
+
+static uint8_t *REC_Put64(uint8_t *p, uint64_t v)
+{
+    for (int i = 0; i < 8; i++)
+        p[i] = (uint8_t)(v >> (8 * i));
+    return p + 8;
+}
+
+static uint8_t *REC_PutF32(uint8_t *p, float v)
+{
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return REC_Put32(p, bits);
+}
+
+static void REC_SendChunk(REC_Out_t *out)
+{
+    uint8_t *p = out->chunk;
+
+    p = REC_Put32(p, rec_capture.id);
+    p = REC_Put16(p, out->index);
+    p = REC_Put16(p, out->count);
+    (void)REC_Put32(p, out->total);
+
+    if (mqtt_publish(net_cfg.MQTT_TOPIC_RECORDER, out->chunk,
+                     REC_CHUNK_HEADER + out->fill) != 0)
+        out->failed = 1;
+    out->index++;
+    out->fill = 0;
+}
+
+static void REC_Emit(REC_Out_t *out, const uint8_t *bytes, uint32_t n)
+{
+    if (out->file && fwrite(bytes, 1, n, out->file) != n)
+        out->failed = 1;
+
+    while (out->chunk_bytes && n > 0)
+    {
+        uint32_t take = out->chunk_bytes - out->fill;
+        if (take > n)
+            take = n;
+
+        memcpy(out->chunk + REC_CHUNK_HEADER + out->fill, bytes, take);
+        out->fill += take;
+        bytes     += take;
+        n         -= take;
+
+        if (out->fill == out->chunk_bytes)
+            REC_SendChunk(out);
+    }
+}
+
+/* Oldest sample of the ring inside the window, and how many are */
+static uint32_t REC_Window(const REC_Ring_t *ring, uint32_t *first)
+{
+    const REC_Capture_t *c = &rec_capture;
+    uint64_t pre_us = (uint64_t)c->pre_ms * 1000U;
+    uint64_t lo     = (c->trigger_us > pre_us) ? c->trigger_us - pre_us : 0U;
+    uint32_t held   = (ring->head < REC_RING_SIZE) ? ring->head : REC_RING_SIZE;
+    uint32_t i      = ring->head - held;
+
+    while (i != ring->head && ring->rec[i & REC_RING_MASK].t_us < lo)
+        i++;
+    *first = i;
+    return ring->head - i;
+}
+
+static void REC_EmitRing(REC_Out_t *out, int d, uint8_t a, uint32_t first, uint32_t count)
+{
+    const REC_Ring_t *ring = &rec_rings[d][a];
+    uint8_t  hdr[REC_RING_BYTES];
+    uint8_t *p = hdr;
+
+    memset(hdr, 0, sizeof(hdr));
+    strncpy((char *)p, POOL_Drive(d)->NAME, 32U);
+    p += 32;
+    *p++ = (uint8_t)d;
+    *p++ = (uint8_t)(a + 1U);   /* Axis_t */
+    p = REC_Put16(p, 0);
+    (void)REC_Put32(p, count);
+    REC_Emit(out, hdr, sizeof(hdr));
+
+    for (uint32_t i = first; i != first + count; i++)
+    {
+        const REC_Sample_t *s = &ring->rec[i & REC_RING_MASK];
+        uint8_t rec[REC_RECORD_BYTES];
+
+        p = REC_Put32(rec, (uint32_t)(int32_t)((int64_t)s->t_us -
+                                               (int64_t)rec_capture.trigger_us));
+        p = REC_Put16(p, s->valid);
+        p = REC_Put16(p, s->io_status);
+        p = REC_Put16(p, s->fault_raw);
+        p = REC_PutF32(p, s->actual_pos_mm);
+        p = REC_PutF32(p, s->pos_deg);
+        p = REC_PutF32(p, s->pos_mm);
+        p = REC_PutF32(p, s->rpm);
+        p = REC_PutF32(p, s->current);
+        (void)REC_PutF32(p, s->dcbus);
+        REC_Emit(out, rec, sizeof(rec));
+    }
+}
+
+static FILE *REC_OpenFile(char *path, size_t cap)
+{
+    char      stamp[32];
+    time_t    wall = (time_t)rec_capture.wall;
+    struct tm *tm  = localtime(&wall);
+
+    if (!tm || strftime(stamp, sizeof(stamp), "%Y%m%d_%H%M%S", tm) == 0)
+        snprintf(stamp, sizeof(stamp), "%llu", (unsigned long long)rec_capture.wall);
+
+    snprintf(path, cap, "%s/rec_%s_%u_%s.bin", recorder_cfg.DIR, stamp,
+             rec_capture.id, REC_CauseName(rec_capture.cause));
+    return fopen(path, "wb");
+}
+
+void REC_Service(void)
+{
+    static REC_Out_t out;
+    uint32_t first[MAX_DRIVES][ACQ_AXES];
+    uint32_t count[MAX_DRIVES][ACQ_AXES];
+    uint32_t samples = 0;
+    char     path[192];
+    uint8_t  hdr[REC_HEADER_BYTES];
+    uint8_t *p;
+
+    if (atomic_load_explicit(&rec_state, memory_order_acquire) != REC_FROZEN)
+        return;
+
+    int drives = POOL_Count();
+    uint8_t rings = (uint8_t)(drives * (int)ACQ_AXES);
+
+    for (int d = 0; d < drives; d++)
+    {
+        for (uint8_t a = 0; a < ACQ_AXES; a++)
+        {
+            count[d][a] = REC_Window(&rec_rings[d][a], &first[d][a]);
+            samples += count[d][a];
+        }
+    }
+
+    memset(&out, 0, sizeof(out));
+    out.total = REC_HEADER_BYTES + rings * REC_RING_BYTES + samples * REC_RECORD_BYTES;
+
+    path[0] = '\0';
+    if (recorder_cfg.DIR[0])
+    {
+        out.file = REC_OpenFile(path, sizeof(path));
+        if (!out.file)
+            LOG_ERROR("[REC] Cannot create %s\n", path);
+    }
+    if (recorder_cfg.MQTT_CHUNK > 0)
+    {
+        uint32_t cb = (uint32_t)recorder_cfg.MQTT_CHUNK;
+        if (cb < REC_CHUNK_MIN)
+            cb = REC_CHUNK_MIN;
+        if (cb > REC_CHUNK_MAX)
+            cb = REC_CHUNK_MAX;
+        out.chunk_bytes = cb;
+        out.count       = (uint16_t)((out.total + cb - 1U) / cb);
+    }
+
+    p = hdr;
+    memcpy(p, "LREC", 4);
+    p += 4;
+    p = REC_Put16(p, REC_VERSION);
+    p = REC_Put16(p, REC_RECORD_BYTES);
+    p = REC_Put32(p, rec_capture.id);
+    *p++ = rec_capture.cause;
+    *p++ = rec_capture.drive;
+    *p++ = rec_capture.axis;
+    *p++ = rings;
+    p = REC_Put16(p, rec_capture.detail);
+    p = REC_Put16(p, 0);
+    p = REC_Put32(p, rec_capture.pre_ms);
+    p = REC_Put32(p, rec_capture.post_ms);
+    p = REC_Put64(p, rec_capture.trigger_us);
+    (void)REC_Put64(p, rec_capture.wall);
+    REC_Emit(&out, hdr, sizeof(hdr));
+
+    for (int d = 0; d < drives; d++)
+    {
+        for (uint8_t a = 0; a < ACQ_AXES; a++)
+            REC_EmitRing(&out, d, a, first[d][a], count[d][a]);
+    }
+    if (out.chunk_bytes && out.fill > 0)
+        REC_SendChunk(&out);
+
+    if (out.file && fclose(out.file) != 0)
+        out.failed = 1;
+
+    if (out.failed)
+        LOG_ERROR("[REC] Capture %u: write failed\n", rec_capture.id);
+    else
+        LOG_WARN("[REC] Capture %u: %u samples, %u bytes%s%s, %u MQTT chunks\n",
+                 rec_capture.id, samples, out.total, out.file ? " -> " : "",
+                 out.file ? path : "", out.index);
+
+    /* hand the rings back to the acquisition thread */
+    atomic_store_explicit(&rec_state, REC_ARMED, memory_order_release);
+}
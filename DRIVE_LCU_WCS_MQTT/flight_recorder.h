@@ -0,0 +1,79 @@
+#ifndef FLIGHT_RECORDER_H
+#define FLIGHT_RECORDER_H
+
+#include <stdint.h>
+#include "axis_helper.h"
+#include "drive_feedback.h"
+
+/*===========================================================
+ * Flight recorder
+ *
+ * Every sample the acquisition thread reads (motion and health,
+ * each with its timestamp) is also copied into a fixed ring per
+ * drive axis. Recording is a struct copy and an atomic load:
+ * no lock, no syscall, nothing that could delay the next read.
+ *
+ * A capture is triggered by a fault flag rising (or system_ok
+ * falling) in a decoded fault word, a limit switch tripping, or
+ * the WCS "RecorderDump" command. Recording goes on for
+ * [RECORDER] POST_MS, then every ring freezes and the publisher
+ * thread writes the samples from PRE_MS before the trigger to
+ * POST_MS after it as one binary image: to a file in DIR and/or
+ * in MQTT_CHUNK-byte messages on MQTT_TOPIC_RECORDER. Recording
+ * resumes once the image is out; triggers in the meantime are
+ * ignored. A ring holds REC_RING_SIZE samples, so a window
+ * longer than that starts at the oldest one.
+ *
+ * Image, little-endian, no padding:
+ *
+ *   header   "LREC", u16 version, u16 record bytes, u32 capture id,
+ *            u8 cause (REC_Cause_t), u8 drive, u8 axis (3 = all),
+ *            u8 rings, u16 detail (fault word / IO word), u16 0,
+ *            u32 pre_ms, u32 post_ms, u64 trigger_us, u64 unix time
+ *   per ring char drive name[32], u8 drive, u8 axis, u16 0,
+ *            u32 records
+ *   record   i32 time from trigger (us), u16 valid (SIG_MASK()),
+ *            u16 io_status, u16 fault raw, f32 actual_pos_mm,
+ *            pos_deg, pos_mm, rpm, current, dcbus
+ *
+ * Each MQTT chunk starts with u32 capture id, u16 chunk index,
+ * u16 chunk count, u32 image bytes; the payloads in index order
+ * are the image.
+ *===========================================================*/
+#define REC_RING_SIZE      1024U    /* samples per axis; power of two */
+#define REC_VERSION        1U
+#define REC_HEADER_BYTES   44U
+#define REC_RING_BYTES     40U
+#define REC_RECORD_BYTES   34U
+#define REC_CHUNK_HEADER   12U
+#define REC_CHUNK_MAX      16384U   /* MQTT_CHUNK is clamped to this */
+#define REC_SERVICE_MS     100U     /* REC_Service period (publisher) */
+
+typedef enum
+{
+    REC_CAUSE_FAULT = 1,
+    REC_CAUSE_LIMIT,
+    REC_CAUSE_OPERATOR
+} REC_Cause_t;
+
+/**
+ * @brief Record one decoded sample of 'axis' on drive 'drive';
+ *        acquisition thread only
+ * @param t_us Time of the read (PLAT_TimeUs)
+ */
+void REC_Record(int drive, Axis_t axis, const DriveSnapshot_t *snap, uint64_t t_us);
+
+/**
+ * @brief  Start a capture; safe from any thread
+ * @param  detail Raw word that tripped it (fault / IO), else 0
+ * @return 0 if started, -1 if the recorder is off or a capture
+ *         is already running
+ */
+int REC_Trigger(REC_Cause_t cause, int drive, Axis_t axis, uint16_t detail);
+
+/**
+ * @brief Write out a frozen capture and re-arm; publisher thread
+ */
+void REC_Service(void);
+
+#endif /* FLIGHT_RECORDER_H */
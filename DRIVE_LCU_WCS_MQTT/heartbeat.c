@@ -1,49 +1,51 @@
 #include "heartbeat.h"
 #include "mqtt_client.h"
 #include "ini.h"
+#include "json_writer.h"
 #include <stdio.h>
 #include <string.h>
-#include "cJSON.h"
 
-void Task_Send_Heartbeat(void)
-{
-    /* Safety check */
-    if (!mqtt_connected())
-        return;
+/* The heartbeat never changes: serialized on the first call,
+ * then the same bytes are published every time */
+static char   hb_json[128];
+static size_t hb_len;
 
-    /* Root JSON object */
-    cJSON *root = cJSON_CreateObject();
-    if (!root)
-        return;
+static void Build_Heartbeat(void)
+{
+    JSONW_t w;
 
-    cJSON_AddNumberToObject(root, "v", 1);
-    cJSON_AddStringToObject(root, "id", "heartbeat");
-    cJSON_AddStringToObject(root, "type", "Event");
-    cJSON_AddStringToObject(root, "name", "Heartbeat");
-    cJSON_AddStringToObject(root, "src", "middleware");
+    JSONW_Init(&w, hb_json, sizeof(hb_json));
+    JSONW_ObjectBegin(&w, NULL);
+    JSONW_Num(&w, "v", 1);
+    JSONW_Str(&w, "id", "heartbeat");
+    JSONW_Str(&w, "type", "Event");
+    JSONW_Str(&w, "name", "Heartbeat");
+    JSONW_Str(&w, "src", "middleware");
 
     /* Body */
-    cJSON *body = cJSON_AddObjectToObject(root, "body");
-    cJSON_AddStringToObject(body, "status", "alive");
+    JSONW_ObjectBegin(&w, "body");
+    JSONW_Str(&w, "status", "alive");
+    JSONW_ObjectEnd(&w);
 
     /* Meta (empty object) */
-    cJSON_AddObjectToObject(root, "meta");
+    JSONW_ObjectBegin(&w, "meta");
+    JSONW_ObjectEnd(&w);
+    JSONW_ObjectEnd(&w);
+
+    if (JSONW_Finish(&w))
+        hb_len = w.len;
+}
 
-    /* Convert JSON to string (compact, no spaces) */
-    char *json_str = cJSON_PrintUnformatted(root);
-    if (!json_str)
-    {
-        cJSON_Delete(root);
+void Task_Send_Heartbeat(void)
+{
+    /* Safety check */
+    if (!mqtt_connected())
         return;
-    }
 
-    /* Publish heartbeat */
-    mqtt_publish(net_cfg.MQTT_TOPIC_HEARTBEAT,
-                 json_str,
-                 strlen(json_str));
+    if (hb_len == 0)
+        Build_Heartbeat();
 
-    /* Cleanup */
-    cJSON_free(json_str);
-    cJSON_Delete(root);
+    /* Publish heartbeat */
+    if (hb_len > 0)
+        mqtt_publish(net_cfg.MQTT_TOPIC_HEARTBEAT, hb_json, hb_len);
 }
-
@@ -22,9 +22,22 @@ AXIS_CONFIG axis2_cfg;
 COMMAND_REGS cmd_regs;
 FAULT_BITS_CONFIG fault_cfg;
 MOTOR_CONFIG motor_cfg;
+LOG_CONFIG log_cfg;
+STATS_CONFIG stats_cfg;
+TELEMETRY_CONFIG telemetry_cfg;
+RECORDER_CONFIG recorder_cfg;
+DRIVE_CONFIG drive_cfg[MAX_DRIVES];
+int drive_count;
+
+/* [AXIS...] sections other than AXIS1 / AXIS2 */
+static AXIS_CONFIG axis_maps[MAX_AXIS_MAPS];
+static char        axis_map_names[MAX_AXIS_MAPS][64];
+static int         axis_map_count;
 
 /* helper buffers */
 static char current_section[64] = {0};
+static DRIVE_CONFIG *cur_drive;     /* valid while in a [DRIVE] section */
+static AXIS_CONFIG  *cur_axis;      /* valid while in an [AXIS...] section */
 
 /* trim left and right in-place */
 static void trim_lr(char *s)
@@ -72,6 +85,11 @@ static void init_defaults(void)
     memset(&cmd_regs, 0, sizeof(cmd_regs));
     memset(&fault_cfg, 0, sizeof(fault_cfg));
     memset(&motor_cfg, 0, sizeof(motor_cfg));
+    memset(drive_cfg, 0, sizeof(drive_cfg));
+    drive_count = 0;
+    axis_map_count = 0;
+    cur_drive = NULL;
+    cur_axis = NULL;
 
     /* ---------------- NETWORK ---------------- */
     safe_strcpy(net_cfg.DRIVE_IP_ADDR, "169.254.214.170", sizeof(net_cfg.DRIVE_IP_ADDR));
@@ -91,6 +109,10 @@ static void init_defaults(void)
 
     safe_strcpy(net_cfg.MQTT_TOPIC_TELEMETRY, "server/telemetry",sizeof(net_cfg.MQTT_TOPIC_TELEMETRY));
 
+    safe_strcpy(net_cfg.MQTT_TOPIC_STATS, "server/stats",sizeof(net_cfg.MQTT_TOPIC_STATS));
+    safe_strcpy(net_cfg.MQTT_TOPIC_TELEMETRY_CBOR, "server/telemetry/cbor",sizeof(net_cfg.MQTT_TOPIC_TELEMETRY_CBOR));
+    safe_strcpy(net_cfg.MQTT_TOPIC_RECORDER, "server/recorder",sizeof(net_cfg.MQTT_TOPIC_RECORDER));
+
 
     /* ---------------- MODBUS ---------------- */
     modbus_cfg.UNIT_ID = 1;
@@ -100,6 +122,20 @@ static void init_defaults(void)
     modbus_cfg.FUNC_WRITE_MULTIPLE = 16;
     modbus_cfg.MAX_RESPONSE_BYTES = 260;
     modbus_cfg.TIMEOUT_SEC = 1;
+    modbus_cfg.PIPELINE_DEPTH = 4;
+    modbus_cfg.PLAN_MAX_GAP = 8;
+    modbus_cfg.VERIFY_CRC = 1;
+    safe_strcpy(modbus_cfg.TRANSPORT, "UDP", sizeof(modbus_cfg.TRANSPORT));
+    modbus_cfg.TCP_PORT = 502;
+    modbus_cfg.RTO_MIN_MS = 10;
+    modbus_cfg.RTO_MAX_MS = 1000;
+    modbus_cfg.RTO_INIT_MS = 250;
+    modbus_cfg.MAX_ATTEMPTS = 3;
+    modbus_cfg.CALL_DEADLINE_MS = 1500;
+    modbus_cfg.STALE_MS = 100;
+    modbus_cfg.VERIFY_MOTION = 1;
+    modbus_cfg.USE_FC23 = -1;
+    modbus_cfg.FC23_PROBE_REG = 284;
 
     /* =====================================================
      * AXIS1 = PAN   (300 series registers)
@@ -198,6 +234,36 @@ static void init_defaults(void)
     motor_cfg.RATED_CURRENT = 5.0f;
     motor_cfg.PEAK_CURRENT = 10.0f;
     motor_cfg.CURRENT_SHUTDOWN_LIMIT = 10.0f;
+
+    /* ---------------- LOG ---------------- */
+    log_cfg.LEVEL = 2;
+
+    /* ---------------- STATS ---------------- */
+    stats_cfg.PUBLISH_SEC = 10;
+    stats_cfg.REG_RANGE = 100;
+
+    /* ---------------- TELEMETRY ---------------- */
+    telemetry_cfg.CONTINUOUS_MS = 100;
+    telemetry_cfg.PERIODIC_MS = 5000;
+    telemetry_cfg.HEARTBEAT_MS = 1000;
+    telemetry_cfg.DELTA = 0;
+    telemetry_cfg.MAX_SILENCE_MS = 1000;
+    telemetry_cfg.KEYFRAME_MS = 10000;
+    telemetry_cfg.DB_ACTUAL_POS_MM = 0.0F;
+    telemetry_cfg.DB_POS_DEG = 0.0F;
+    telemetry_cfg.DB_POS_MM = 0.0F;
+    telemetry_cfg.DB_RPM = 0.0F;
+    telemetry_cfg.DB_IO_STATUS = 0.0F;
+    safe_strcpy(telemetry_cfg.ENCODING, "JSON", sizeof(telemetry_cfg.ENCODING));
+    telemetry_cfg.BATCH_SAMPLES = 0;
+    telemetry_cfg.BATCH_MS = 100;
+
+    /* ---------------- RECORDER ---------------- */
+    recorder_cfg.ENABLE = 1;
+    recorder_cfg.PRE_MS = 10000;
+    recorder_cfg.POST_MS = 2000;
+    safe_strcpy(recorder_cfg.DIR, ".", sizeof(recorder_cfg.DIR));
+    recorder_cfg.MQTT_CHUNK = 0;
 }
 
 /* case-sensitive match helper */
@@ -228,6 +294,145 @@ static void assign_str(char *dst, size_t dstlen, const char *val)
     dst[dstlen - 1] = 0;
 }
 
+/* register map of section 'name'; 'create' adds a new [AXIS...] map */
+static AXIS_CONFIG *axis_map(const char *name, int create)
+{
+    if (strcmp(name, "AXIS1") == 0) return &axis1_cfg;
+    if (strcmp(name, "AXIS2") == 0) return &axis2_cfg;
+    if (strncmp(name, "AXIS", 4) != 0) return NULL;
+
+    for (int i = 0; i < axis_map_count; i++)
+        if (strcmp(axis_map_names[i], name) == 0)
+            return &axis_maps[i];
+
+    if (!create)
+        return NULL;
+    if (axis_map_count == MAX_AXIS_MAPS)
+    {
+        printf("[WARN] config: more than %d extra [AXIS...] sections, ignoring [%s]\n",
+               MAX_AXIS_MAPS, name);
+        return NULL;
+    }
+
+    /* a new map lists every register itself */
+    safe_strcpy(axis_map_names[axis_map_count], name, sizeof(axis_map_names[0]));
+    memset(&axis_maps[axis_map_count], 0, sizeof(axis_maps[0]));
+    return &axis_maps[axis_map_count++];
+}
+
+/* one key of an [AXIS...] section; unknown keys are ignored */
+static void assign_axis(AXIS_CONFIG *cfg, const char *key, const char *val)
+{
+    if (strcmp(key, "NAME") == 0)
+        assign_str(cfg->NAME, sizeof(cfg->NAME), val);
+    else if (strcmp(key, "AXIS_ID") == 0)
+        assign_int(&cfg->AXIS_ID, val);
+
+    else if (strcmp(key, "POSITION") == 0)
+        assign_int(&cfg->POSITION, val);
+    else if (strcmp(key, "VELOCITY") == 0)
+        assign_int(&cfg->VELOCITY, val);
+    else if (strcmp(key, "ACCEL") == 0)
+        assign_int(&cfg->ACCEL, val);
+    else if (strcmp(key, "DECEL") == 0)
+        assign_int(&cfg->DECEL, val);
+    else if (strcmp(key, "HOME_OFFSET") == 0)
+        assign_int(&cfg->HOME_OFFSET, val);
+    else if (strcmp(key, "DEG_POS") == 0)
+        assign_int(&cfg->DEG_POS, val);
+
+    else if (strcmp(key, "VERSION") == 0)
+        assign_int(&cfg->VERSION, val);
+    else if (strcmp(key, "REVISION") == 0)
+        assign_int(&cfg->REVISION, val);
+    else if (strcmp(key, "RELEASE_DATE") == 0)
+        assign_int(&cfg->RELEASE_DATE, val);
+    else if (strcmp(key, "ABS_POSITION") == 0)
+        assign_int(&cfg->ABS_POSITION, val);
+    else if (strcmp(key, "POS_DEG") == 0)
+        assign_int(&cfg->POS_DEG, val);
+    else if (strcmp(key, "POS_MM") == 0)
+        assign_int(&cfg->POS_MM, val);
+    else if (strcmp(key, "RPM") == 0)
+        assign_int(&cfg->RPM, val);
+    else if (strcmp(key, "ACTUAL_CURRENT") == 0)
+        assign_int(&cfg->ACTUAL_CURRENT, val);
+    else if (strcmp(key, "IO_STATUS") == 0)
+        assign_int(&cfg->IO_STATUS, val);
+    else if (strcmp(key, "SYSTEM_STATUS") == 0)
+        assign_int(&cfg->SYSTEM_STATUS, val);
+    else if (strcmp(key, "DCBUS_VOLT_CMD") == 0 || strcmp(key, "DCBUS_VOLT") == 0)
+        assign_int(&cfg->DCBUS_VOLT_CMD, val);
+    else if (strcmp(key, "FAULT_STATUS") == 0)
+        assign_int(&cfg->FAULT_STATUS, val);
+
+    else if (strcmp(key, "LIMIT_MIN_DEG") == 0)
+        assign_float(&cfg->LIMIT_MIN_DEG, val);
+    else if (strcmp(key, "LIMIT_MAX_DEG") == 0)
+        assign_float(&cfg->LIMIT_MAX_DEG, val);
+    else if (strcmp(key, "LIMIT_MIN_MM") == 0)
+        assign_float(&cfg->LIMIT_MIN_MM, val);
+    else if (strcmp(key, "LIMIT_MAX_MM") == 0)
+        assign_float(&cfg->LIMIT_MAX_MM, val);
+}
+
+/* a [DRIVE] entry with every key unset (inherit) */
+static void init_drive(DRIVE_CONFIG *drv)
+{
+    memset(drv, 0, sizeof(*drv));
+    drv->DRIVE_PORT_UDP  = -1;
+    drv->LOCAL_BIND_PORT = -1;
+    drv->TCP_PORT        = -1;
+    drv->UNIT_ID         = -1;
+}
+
+/* fill unset [DRIVE] keys from [NETWORK] / [MODBUS], find the axis maps */
+static void resolve_drives(void)
+{
+    if (drive_count == 0)
+    {
+        init_drive(&drive_cfg[0]);
+        drive_count = 1;
+    }
+
+    for (int i = 0; i < drive_count; i++)
+    {
+        DRIVE_CONFIG *drv = &drive_cfg[i];
+
+        if (drv->NAME[0] == 0)
+            snprintf(drv->NAME, sizeof(drv->NAME), "DRIVE%d", i + 1);
+        if (drv->DRIVE_IP_ADDR[0] == 0)
+            safe_strcpy(drv->DRIVE_IP_ADDR, net_cfg.DRIVE_IP_ADDR, sizeof(drv->DRIVE_IP_ADDR));
+        if (drv->DRIVE_PORT_UDP < 0)
+            drv->DRIVE_PORT_UDP = net_cfg.DRIVE_PORT_UDP;
+        if (drv->LOCAL_BIND_IP[0] == 0)
+            safe_strcpy(drv->LOCAL_BIND_IP, net_cfg.LOCAL_BIND_IP, sizeof(drv->LOCAL_BIND_IP));
+        /* one local port per drive; 0 keeps letting the OS choose */
+        if (drv->LOCAL_BIND_PORT < 0)
+            drv->LOCAL_BIND_PORT = (net_cfg.LOCAL_BIND_PORT > 0) ? net_cfg.LOCAL_BIND_PORT + i : 0;
+        if (drv->TRANSPORT[0] == 0)
+            safe_strcpy(drv->TRANSPORT, modbus_cfg.TRANSPORT, sizeof(drv->TRANSPORT));
+        if (drv->TCP_PORT < 0)
+            drv->TCP_PORT = modbus_cfg.TCP_PORT;
+        if (drv->UNIT_ID < 0)
+            drv->UNIT_ID = modbus_cfg.UNIT_ID;
+        if (drv->AXIS1[0] == 0)
+            safe_strcpy(drv->AXIS1, "AXIS1", sizeof(drv->AXIS1));
+        if (drv->AXIS2[0] == 0)
+            safe_strcpy(drv->AXIS2, "AXIS2", sizeof(drv->AXIS2));
+
+        drv->AXIS1_CFG = axis_map(drv->AXIS1, 0);
+        drv->AXIS2_CFG = axis_map(drv->AXIS2, 0);
+        if (!drv->AXIS1_CFG || !drv->AXIS2_CFG)
+        {
+            printf("[WARN] config: drive %s names a missing axis section, using [AXIS1]/[AXIS2]\n",
+                   drv->NAME);
+            if (!drv->AXIS1_CFG) drv->AXIS1_CFG = &axis1_cfg;
+            if (!drv->AXIS2_CFG) drv->AXIS2_CFG = &axis2_cfg;
+        }
+    }
+}
+
 /* main loader */
 int ini_load(const char *filename)
 {
@@ -255,6 +460,22 @@ int ini_load(const char *filename)
             {
                 trim_lr(secname);
                 safe_strcpy(current_section, secname, sizeof(current_section));
+
+                cur_axis = axis_map(secname, 1);
+                if (strcmp(secname, "DRIVE") == 0)
+                {
+                    if (drive_count < MAX_DRIVES)
+                    {
+                        cur_drive = &drive_cfg[drive_count++];
+                        init_drive(cur_drive);
+                    }
+                    else
+                    {
+                        printf("[WARN] config: more than %d [DRIVE] sections, ignoring the rest\n",
+                               MAX_DRIVES);
+                        current_section[0] = 0;
+                    }
+                }
             }
             continue;
         }
@@ -298,6 +519,12 @@ int ini_load(const char *filename)
             assign_str(net_cfg.MQTT_TOPIC_HEARTBEAT,sizeof(net_cfg.MQTT_TOPIC_HEARTBEAT),valbuf);
         else if (match(current_section, keybuf, "MQTT", "MQTT_TOPIC_TELEMETRY"))
             assign_str(net_cfg.MQTT_TOPIC_TELEMETRY,sizeof(net_cfg.MQTT_TOPIC_TELEMETRY),valbuf);
+        else if (match(current_section, keybuf, "MQTT", "MQTT_TOPIC_STATS"))
+            assign_str(net_cfg.MQTT_TOPIC_STATS,sizeof(net_cfg.MQTT_TOPIC_STATS),valbuf);
+        else if (match(current_section, keybuf, "MQTT", "MQTT_TOPIC_TELEMETRY_CBOR"))
+            assign_str(net_cfg.MQTT_TOPIC_TELEMETRY_CBOR,sizeof(net_cfg.MQTT_TOPIC_TELEMETRY_CBOR),valbuf);
+        else if (match(current_section, keybuf, "MQTT", "MQTT_TOPIC_RECORDER"))
+            assign_str(net_cfg.MQTT_TOPIC_RECORDER,sizeof(net_cfg.MQTT_TOPIC_RECORDER),valbuf);
         else if (match(current_section, keybuf, "MQTT", "MQTT_CLIENT_ID"))
             assign_str(net_cfg.MQTT_CLIENT_ID,sizeof(net_cfg.MQTT_CLIENT_ID),valbuf);
 
@@ -317,110 +544,60 @@ int ini_load(const char *filename)
             assign_int(&modbus_cfg.MAX_RESPONSE_BYTES, valbuf);
         else if (match(current_section, keybuf, "MODBUS", "TIMEOUT_SEC"))
             assign_int(&modbus_cfg.TIMEOUT_SEC, valbuf);
-
-        /* ---------------- AXIS1 (TILT) ------------- */
-        else if (match(current_section, keybuf, "AXIS1", "NAME"))
-            assign_str(axis1_cfg.NAME, sizeof(axis1_cfg.NAME), valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "AXIS_ID"))
-            assign_int(&axis1_cfg.AXIS_ID, valbuf);
-
-        else if (match(current_section, keybuf, "AXIS1", "POSITION"))
-            assign_int(&axis1_cfg.POSITION, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "VELOCITY"))
-            assign_int(&axis1_cfg.VELOCITY, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "ACCEL"))
-            assign_int(&axis1_cfg.ACCEL, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "DECEL"))
-            assign_int(&axis1_cfg.DECEL, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "HOME_OFFSET"))
-            assign_int(&axis1_cfg.HOME_OFFSET, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "DEG_POS"))
-            assign_int(&axis1_cfg.DEG_POS, valbuf);
-
-        else if (match(current_section, keybuf, "AXIS1", "VERSION"))
-            assign_int(&axis1_cfg.VERSION, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "REVISION"))
-            assign_int(&axis1_cfg.REVISION, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "RELEASE_DATE"))
-            assign_int(&axis1_cfg.RELEASE_DATE, valbuf);
-        else if( match(current_section, keybuf, "AXIS1", "ABS_POSITION"))
-            assign_int(&axis1_cfg.ABS_POSITION, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "POS_DEG"))
-            assign_int(&axis1_cfg.POS_DEG, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "POS_MM"))
-            assign_int(&axis1_cfg.POS_MM, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "RPM"))
-            assign_int(&axis1_cfg.RPM, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "ACTUAL_CURRENT"))
-            assign_int(&axis1_cfg.ACTUAL_CURRENT, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "IO_STATUS"))
-            assign_int(&axis1_cfg.IO_STATUS, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "SYSTEM_STATUS"))
-            assign_int(&axis1_cfg.SYSTEM_STATUS, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "DCBUS_VOLT_CMD")) /* second occurrence -> store in DCBUS_VOLT2 */
-            assign_int(&axis1_cfg.DCBUS_VOLT_CMD, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "FAULT_STATUS")) /* second occurrence -> store in DCBUS_VOLT2 */
-            assign_int(&axis1_cfg.FAULT_STATUS, valbuf);
-
-        else if (match(current_section, keybuf, "AXIS1", "LIMIT_MIN_DEG"))
-            assign_float(&axis1_cfg.LIMIT_MIN_DEG, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "LIMIT_MAX_DEG"))
-            assign_float(&axis1_cfg.LIMIT_MAX_DEG, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "LIMIT_MIN_MM"))
-            assign_float(&axis1_cfg.LIMIT_MIN_MM, valbuf);
-        else if (match(current_section, keybuf, "AXIS1", "LIMIT_MAX_MM"))
-            assign_float(&axis1_cfg.LIMIT_MAX_MM, valbuf);
-
-        /* --------------- AXIS2 (PAN) ------------------ */
-        else if (match(current_section, keybuf, "AXIS2", "NAME"))
-            assign_str(axis2_cfg.NAME, sizeof(axis2_cfg.NAME), valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "AXIS_ID"))
-            assign_int(&axis2_cfg.AXIS_ID, valbuf);
-
-        else if (match(current_section, keybuf, "AXIS2", "POSITION"))
-            assign_int(&axis2_cfg.POSITION, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "VELOCITY"))
-            assign_int(&axis2_cfg.VELOCITY, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "ACCEL"))
-            assign_int(&axis2_cfg.ACCEL, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "DECEL"))
-            assign_int(&axis2_cfg.DECEL, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "HOME_OFFSET"))
-            assign_int(&axis2_cfg.HOME_OFFSET, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "DEG_POS"))
-            assign_int(&axis2_cfg.DEG_POS, valbuf);
-
-        else if (match(current_section, keybuf, "AXIS2", "VERSION"))
-            assign_int(&axis2_cfg.VERSION, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "REVISION"))
-            assign_int(&axis2_cfg.REVISION, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "RELEASE_DATE"))
-            assign_int(&axis2_cfg.RELEASE_DATE, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "POS_DEG"))
-            assign_int(&axis2_cfg.POS_DEG, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "POS_MM"))
-            assign_int(&axis2_cfg.POS_MM, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "RPM"))
-            assign_int(&axis2_cfg.RPM, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "ACTUAL_CURRENT"))
-            assign_int(&axis2_cfg.ACTUAL_CURRENT, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "IO_STATUS"))
-            assign_int(&axis2_cfg.IO_STATUS, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "SYSTEM_STATUS"))
-            assign_int(&axis2_cfg.SYSTEM_STATUS, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "DCBUS_VOLT")) /* second occurrence -> DCBUS_VOLT2 */
-            assign_int(&axis2_cfg.DCBUS_VOLT_CMD, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "FAULT_STATUS")) /* second occurrence -> DCBUS_VOLT2 */
-            assign_int(&axis2_cfg.FAULT_STATUS, valbuf);
-
-        else if (match(current_section, keybuf, "AXIS2", "LIMIT_MIN_DEG"))
-            assign_float(&axis2_cfg.LIMIT_MIN_DEG, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "LIMIT_MAX_DEG"))
-            assign_float(&axis2_cfg.LIMIT_MAX_DEG, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "LIMIT_MIN_MM"))
-            assign_float(&axis2_cfg.LIMIT_MIN_MM, valbuf);
-        else if (match(current_section, keybuf, "AXIS2", "LIMIT_MAX_MM"))
-            assign_float(&axis2_cfg.LIMIT_MAX_MM, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "PIPELINE_DEPTH"))
+            assign_int(&modbus_cfg.PIPELINE_DEPTH, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "PLAN_MAX_GAP"))
+            assign_int(&modbus_cfg.PLAN_MAX_GAP, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "VERIFY_CRC"))
+            assign_int(&modbus_cfg.VERIFY_CRC, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "TRANSPORT"))
+            assign_str(modbus_cfg.TRANSPORT, sizeof(modbus_cfg.TRANSPORT), valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "TCP_PORT"))
+            assign_int(&modbus_cfg.TCP_PORT, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "RTO_MIN_MS"))
+            assign_int(&modbus_cfg.RTO_MIN_MS, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "RTO_MAX_MS"))
+            assign_int(&modbus_cfg.RTO_MAX_MS, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "RTO_INIT_MS"))
+            assign_int(&modbus_cfg.RTO_INIT_MS, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "MAX_ATTEMPTS"))
+            assign_int(&modbus_cfg.MAX_ATTEMPTS, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "CALL_DEADLINE_MS"))
+            assign_int(&modbus_cfg.CALL_DEADLINE_MS, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "STALE_MS"))
+            assign_int(&modbus_cfg.STALE_MS, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "VERIFY_MOTION"))
+            assign_int(&modbus_cfg.VERIFY_MOTION, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "USE_FC23"))
+            assign_int(&modbus_cfg.USE_FC23, valbuf);
+        else if (match(current_section, keybuf, "MODBUS", "FC23_PROBE_REG"))
+            assign_int(&modbus_cfg.FC23_PROBE_REG, valbuf);
+
+        /* ---------------- DRIVE (one per section) ----- */
+        else if (match(current_section, keybuf, "DRIVE", "NAME"))
+            assign_str(cur_drive->NAME, sizeof(cur_drive->NAME), valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "DRIVE_IP_ADDR"))
+            assign_str(cur_drive->DRIVE_IP_ADDR, sizeof(cur_drive->DRIVE_IP_ADDR), valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "DRIVE_PORT_UDP"))
+            assign_int(&cur_drive->DRIVE_PORT_UDP, valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "LOCAL_BIND_IP"))
+            assign_str(cur_drive->LOCAL_BIND_IP, sizeof(cur_drive->LOCAL_BIND_IP), valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "LOCAL_BIND_PORT"))
+            assign_int(&cur_drive->LOCAL_BIND_PORT, valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "TRANSPORT"))
+            assign_str(cur_drive->TRANSPORT, sizeof(cur_drive->TRANSPORT), valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "TCP_PORT"))
+            assign_int(&cur_drive->TCP_PORT, valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "UNIT_ID"))
+            assign_int(&cur_drive->UNIT_ID, valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "AXIS1"))
+            assign_str(cur_drive->AXIS1, sizeof(cur_drive->AXIS1), valbuf);
+        else if (match(current_section, keybuf, "DRIVE", "AXIS2"))
+            assign_str(cur_drive->AXIS2, sizeof(cur_drive->AXIS2), valbuf);
+
+        /* ---------------- AXIS register maps ---------- */
+        else if (cur_axis)
+            assign_axis(cur_axis, keybuf, valbuf);
 
         /* --------------- COMMAND_REGISTERS ------------------ */
         else if (match(current_section, keybuf, "COMMAND_REGISTERS", "CMD_SOLENOID"))
@@ -490,9 +667,62 @@ int ini_load(const char *filename)
         else if (match(current_section, keybuf, "MOTOR", "CURRENT_SHUTDOWN_LIMIT"))
             assign_float(&motor_cfg.CURRENT_SHUTDOWN_LIMIT, valbuf);
 
+        /* ---------------- LOG ---------------------- */
+        else if (match(current_section, keybuf, "LOG", "LEVEL"))
+            assign_int(&log_cfg.LEVEL, valbuf);
+
+        /* ---------------- STATS -------------------- */
+        else if (match(current_section, keybuf, "STATS", "PUBLISH_SEC"))
+            assign_int(&stats_cfg.PUBLISH_SEC, valbuf);
+        else if (match(current_section, keybuf, "STATS", "REG_RANGE"))
+            assign_int(&stats_cfg.REG_RANGE, valbuf);
+
+        /* ---------------- TELEMETRY ---------------- */
+        else if (match(current_section, keybuf, "TELEMETRY", "CONTINUOUS_MS"))
+            assign_int(&telemetry_cfg.CONTINUOUS_MS, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "PERIODIC_MS"))
+            assign_int(&telemetry_cfg.PERIODIC_MS, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "HEARTBEAT_MS"))
+            assign_int(&telemetry_cfg.HEARTBEAT_MS, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "DELTA"))
+            assign_int(&telemetry_cfg.DELTA, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "MAX_SILENCE_MS"))
+            assign_int(&telemetry_cfg.MAX_SILENCE_MS, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "KEYFRAME_MS"))
+            assign_int(&telemetry_cfg.KEYFRAME_MS, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "DB_ACTUAL_POS_MM"))
+            assign_float(&telemetry_cfg.DB_ACTUAL_POS_MM, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "DB_POS_DEG"))
+            assign_float(&telemetry_cfg.DB_POS_DEG, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "DB_POS_MM"))
+            assign_float(&telemetry_cfg.DB_POS_MM, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "DB_RPM"))
+            assign_float(&telemetry_cfg.DB_RPM, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "DB_IO_STATUS"))
+            assign_float(&telemetry_cfg.DB_IO_STATUS, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "ENCODING"))
+            assign_str(telemetry_cfg.ENCODING, sizeof(telemetry_cfg.ENCODING), valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "BATCH_SAMPLES"))
+            assign_int(&telemetry_cfg.BATCH_SAMPLES, valbuf);
+        else if (match(current_section, keybuf, "TELEMETRY", "BATCH_MS"))
+            assign_int(&telemetry_cfg.BATCH_MS, valbuf);
+
+        /* ---------------- RECORDER ----------------- */
+        else if (match(current_section, keybuf, "RECORDER", "ENABLE"))
+            assign_int(&recorder_cfg.ENABLE, valbuf);
+        else if (match(current_section, keybuf, "RECORDER", "PRE_MS"))
+            assign_int(&recorder_cfg.PRE_MS, valbuf);
+        else if (match(current_section, keybuf, "RECORDER", "POST_MS"))
+            assign_int(&recorder_cfg.POST_MS, valbuf);
+        else if (match(current_section, keybuf, "RECORDER", "DIR"))
+            assign_str(recorder_cfg.DIR, sizeof(recorder_cfg.DIR), valbuf);
+        else if (match(current_section, keybuf, "RECORDER", "MQTT_CHUNK"))
+            assign_int(&recorder_cfg.MQTT_CHUNK, valbuf);
+
         /* else: unknown key -> ignore silently (or log if needed) */
     }
 
     fclose(f);
+    resolve_drives();
     return 0;
 }
@@ -20,6 +20,9 @@ typedef struct {
 
     char MQTT_TOPIC_HEARTBEAT[64];
     char MQTT_TOPIC_TELEMETRY[64];
+    char MQTT_TOPIC_TELEMETRY_CBOR[64];
+    char MQTT_TOPIC_STATS[64];
+    char MQTT_TOPIC_RECORDER[64];
 } NETWORK_CONFIG;
 
 typedef struct {
@@ -30,6 +33,20 @@ typedef struct {
     int FUNC_WRITE_MULTIPLE;
     int MAX_RESPONSE_BYTES;
     int TIMEOUT_SEC;
+    int PIPELINE_DEPTH;     /* max requests in flight to the drive */
+    int PLAN_MAX_GAP;       /* unused registers a coalesced read may span */
+    int VERIFY_CRC;         /* drop received frames with a bad CRC */
+    char TRANSPORT[8];      /* "UDP" (RTU + CRC) or "TCP" (Modbus/TCP) */
+    int TCP_PORT;           /* drive port for Modbus/TCP */
+    int RTO_MIN_MS;         /* floor of the adaptive per-attempt timeout */
+    int RTO_MAX_MS;         /* ceiling of the adaptive per-attempt timeout */
+    int RTO_INIT_MS;        /* timeout before the first RTT sample */
+    int MAX_ATTEMPTS;       /* sends per transaction, first one included */
+    int CALL_DEADLINE_MS;   /* total time a transaction may take (0 = none) */
+    int STALE_MS;           /* how long a timed-out attempt may still be answered */
+    int VERIFY_MOTION;      /* read a motion upload back once and compare */
+    int USE_FC23;           /* 0x17 write+read-back: -1 probe, 0 never, 1 always */
+    int FC23_PROBE_REG;     /* holding register the probe rewrites with its own value */
 } MODBUS_CONFIG;
 
 typedef struct {
@@ -106,6 +123,70 @@ typedef struct {
     float CURRENT_SHUTDOWN_LIMIT;
 } MOTOR_CONFIG;
 
+/*
+ * One drive of the pool. Every [DRIVE] section adds one; with none,
+ * drive 0 is built from [NETWORK] / [MODBUS]. Keys left out inherit
+ * from those sections, so a single-drive config.ini needs no change.
+ */
+#define MAX_DRIVES     8    /* [DRIVE] sections honoured */
+#define MAX_AXIS_MAPS  8    /* [AXIS...] sections besides AXIS1 / AXIS2 */
+
+typedef struct {
+    char NAME[32];
+    char DRIVE_IP_ADDR[64];
+    int  DRIVE_PORT_UDP;
+    char LOCAL_BIND_IP[64];
+    int  LOCAL_BIND_PORT;   /* default: [NETWORK] LOCAL_BIND_PORT + drive index */
+    char TRANSPORT[8];
+    int  TCP_PORT;
+    int  UNIT_ID;
+    char AXIS1[32];         /* section with the TILT register map */
+    char AXIS2[32];         /* section with the PAN register map  */
+
+    /* resolved by ini_load */
+    AXIS_CONFIG *AXIS1_CFG;
+    AXIS_CONFIG *AXIS2_CFG;
+} DRIVE_CONFIG;
+
+typedef struct {
+    int LEVEL;              /* 0 error, 1 warn, 2 info, 3 debug */
+} LOG_CONFIG;
+
+typedef struct {
+    int PUBLISH_SEC;        /* Modbus latency snapshot period, 0 = off */
+    int REG_RANGE;          /* registers per latency range series */
+} STATS_CONFIG;
+
+typedef struct {
+    int CONTINUOUS_MS;      /* motion feedback sample / publish period */
+    int PERIODIC_MS;        /* health (current, DC bus, faults) period  */
+    int HEARTBEAT_MS;       /* MQTT heartbeat period                    */
+
+    /* continuous change-only mode */
+    int   DELTA;            /* 1 = send only fields outside their band  */
+    int   MAX_SILENCE_MS;   /* full message after this long unsent, 0 = off */
+    int   KEYFRAME_MS;      /* full message at least this often, 0 = off */
+    float DB_ACTUAL_POS_MM; /* deadbands, engineering units; 0 = any change */
+    float DB_POS_DEG;
+    float DB_POS_MM;
+    float DB_RPM;
+    float DB_IO_STATUS;
+
+    char  ENCODING[8];      /* "JSON", "CBOR" or "BOTH" (one topic each) */
+
+    /* continuous batching (replaces change-only mode when on) */
+    int   BATCH_SAMPLES;    /* samples per message, 0/1 = one per message */
+    int   BATCH_MS;         /* send a partial batch this long after its first sample */
+} TELEMETRY_CONFIG;
+
+typedef struct {
+    int  ENABLE;            /* record every acquisition sample */
+    int  PRE_MS;            /* kept before a trigger */
+    int  POST_MS;           /* recorded after it */
+    char DIR[128];          /* capture files go here, "" = no file */
+    int  MQTT_CHUNK;        /* bytes per MQTT_TOPIC_RECORDER message, 0 = no upload */
+} RECORDER_CONFIG;
+
 /// GLOBAL OBJECTS (access everywhere)
 extern NETWORK_CONFIG net_cfg;
 extern MODBUS_CONFIG modbus_cfg;
@@ -114,6 +195,12 @@ extern AXIS_CONFIG axis2_cfg;
 extern COMMAND_REGS cmd_regs;
 extern FAULT_BITS_CONFIG fault_cfg;
 extern MOTOR_CONFIG motor_cfg;
+extern LOG_CONFIG log_cfg;
+extern STATS_CONFIG stats_cfg;
+extern TELEMETRY_CONFIG telemetry_cfg;
+extern RECORDER_CONFIG recorder_cfg;
+extern DRIVE_CONFIG drive_cfg[MAX_DRIVES];
+extern int drive_count;
 
 /// Loader function
 int ini_load(const char *filename);
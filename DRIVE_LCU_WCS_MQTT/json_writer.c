@@ -0,0 +1,265 @@
+#include "json_writer.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static atomic_uint jsonw_dropped;
+
+void JSONW_Init(JSONW_t *w, char *buf, size_t cap)
+{
+    memset(w, 0, sizeof(*w));
+    w->buf = buf;
+    w->cap = cap;
+}
+
+void JSONW_From(JSONW_t *w, const JSONW_t *tmpl, char *buf, size_t cap)
+{
+    *w = *tmpl;
+    w->buf = buf;
+    w->cap = cap;
+
+    if (tmpl->len > cap)
+    {
+        w->len      = 0;
+        w->overflow = 1;
+        return;
+    }
+    memcpy(buf, tmpl->buf, tmpl->len);
+}
+
+/*----------------------------------------------------------
+ * Output
+ *----------------------------------------------------------*/
+static void JSONW_Put(JSONW_t *w, const char *s, size_t n)
+{
+    /* keep one byte for JSONW_Finish's NUL */
+    if (w->overflow || w->len + n >= w->cap)
+    {
+        w->overflow = 1;
+        return;
+    }
+    memcpy(w->buf + w->len, s, n);
+    w->len += n;
+}
+
+static void JSONW_Char(JSONW_t *w, char c)
+{
+    JSONW_Put(w, &c, 1);
+}
+
+/* Quoted string with cJSON's escapes */
+static void JSONW_Quoted(JSONW_t *w, const char *s)
+{
+    const char *run = s;
+
+    JSONW_Char(w, '"');
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        char esc[8];
+
+        if (c >= 32U && c != '"' && c != '\\')
+            continue;
+
+        JSONW_Put(w, run, (size_t)(s - run));
+        run = s + 1;
+
+        switch (c)
+        {
+            case '"':  JSONW_Put(w, "\\\"", 2); break;
+            case '\\': JSONW_Put(w, "\\\\", 2); break;
+            case '\b': JSONW_Put(w, "\\b", 2);  break;
+            case '\f': JSONW_Put(w, "\\f", 2);  break;
+            case '\n': JSONW_Put(w, "\\n", 2);  break;
+            case '\r': JSONW_Put(w, "\\r", 2);  break;
+            case '\t': JSONW_Put(w, "\\t", 2);  break;
+            default:
+                snprintf(esc, sizeof(esc), "\\u%04x", c);
+                JSONW_Put(w, esc, 6);
+                break;
+        }
+    }
+    JSONW_Put(w, run, (size_t)(s - run));
+    JSONW_Char(w, '"');
+}
+
+/* Separator and key of the next member */
+static void JSONW_Member(JSONW_t *w, const char *key)
+{
+    if (w->depth > 0 && w->count[w->depth - 1U]++ > 0)
+        JSONW_Char(w, ',');
+    if (key)
+    {
+        JSONW_Quoted(w, key);
+        JSONW_Char(w, ':');
+    }
+}
+
+static void JSONW_Open(JSONW_t *w, const char *key, char bracket)
+{
+    JSONW_Member(w, key);
+    JSONW_Char(w, bracket);
+
+    if (w->depth >= JSONW_MAX_DEPTH)
+    {
+        w->overflow = 1;
+        return;
+    }
+    w->count[w->depth++] = 0;
+}
+
+static void JSONW_Close(JSONW_t *w, char bracket)
+{
+    if (w->depth == 0)
+    {
+        w->overflow = 1;
+        return;
+    }
+    w->depth--;
+    JSONW_Char(w, bracket);
+}
+
+void JSONW_ObjectBegin(JSONW_t *w, const char *key) { JSONW_Open(w, key, '{'); }
+void JSONW_ObjectEnd(JSONW_t *w)                    { JSONW_Close(w, '}'); }
+void JSONW_ArrayBegin(JSONW_t *w, const char *key)  { JSONW_Open(w, key, '['); }
+void JSONW_ArrayEnd(JSONW_t *w)                     { JSONW_Close(w, ']'); }
+
+void JSONW_Str(JSONW_t *w, const char *key, const char *value)
+{
+    JSONW_Member(w, key);
+    JSONW_Quoted(w, value ? value : "");
+}
+
+void JSONW_Bool(JSONW_t *w, const char *key, int value)
+{
+    JSONW_Member(w, key);
+    if (value)
+        JSONW_Put(w, "true", 4);
+    else
+        JSONW_Put(w, "false", 5);
+}
+
+/* Same digits as cJSON's print_number: whole numbers that fit an
+ * int as integers, others with 15 significant digits, or 17 when
+ * 15 do not read back as the same double */
+void JSONW_Num(JSONW_t *w, const char *key, double value)
+{
+    char num[32];
+    int  n;
+
+    JSONW_Member(w, key);
+
+    if (isnan(value) || isinf(value))
+    {
+        JSONW_Put(w, "null", 4);
+        return;
+    }
+
+    if (value >= (double)INT_MIN && value <= (double)INT_MAX &&
+        value == (double)(int)value)
+    {
+        /* the common case: counts, register values, flags */
+        int      v   = (int)value;
+        unsigned u   = (v < 0) ? 0U - (unsigned)v : (unsigned)v;
+        char    *end = num + sizeof(num);
+        char    *p   = end;
+
+        do
+        {
+            *--p = (char)('0' + u % 10U);
+            u /= 10U;
+        } while (u);
+        if (v < 0)
+            *--p = '-';
+        JSONW_Put(w, p, (size_t)(end - p));
+        return;
+    }
+
+    n = snprintf(num, sizeof(num), "%1.15g", value);
+
+    double back = strtod(num, NULL);
+    double big  = (fabs(back) > fabs(value)) ? fabs(back) : fabs(value);
+    if (!(fabs(back - value) <= big * DBL_EPSILON))
+        n = snprintf(num, sizeof(num), "%1.17g", value);
+
+    if (n > 0 && (size_t)n < sizeof(num))
+        JSONW_Put(w, num, (size_t)n);
+    else
+        w->overflow = 1;
+}
+
+void JSONW_Fixed(JSONW_t *w, const char *key, double value, uint8_t decimals)
+{
+    static const uint32_t pow10[JSONW_MAX_DECIMALS + 1U] =
+        { 1U, 10U, 100U, 1000U, 10000U, 100000U, 1000000U };
+    char  num[32];
+    char *end = num + sizeof(num);
+    char *p   = end;
+
+    if (decimals > JSONW_MAX_DECIMALS)
+        decimals = JSONW_MAX_DECIMALS;
+
+    double scaled = value * pow10[decimals];
+    if (isnan(scaled) || scaled > 9e15 || scaled < -9e15)
+    {
+        JSONW_Num(w, key, value);   /* null, or beyond int64 precision */
+        return;
+    }
+
+    JSONW_Member(w, key);
+
+    int64_t  m = (int64_t)(scaled + ((scaled >= 0.0) ? 0.5 : -0.5));
+    uint64_t u = (m < 0) ? 0U - (uint64_t)m : (uint64_t)m;
+    uint64_t whole = u / pow10[decimals];
+    uint32_t frac  = (uint32_t)(u % pow10[decimals]);
+
+    if (frac)
+    {
+        uint8_t digits = decimals;
+        while (frac % 10U == 0U)
+        {
+            frac /= 10U;
+            digits--;
+        }
+        while (digits--)
+        {
+            *--p = (char)('0' + frac % 10U);
+            frac /= 10U;
+        }
+        *--p = '.';
+    }
+    do
+    {
+        *--p = (char)('0' + whole % 10U);
+        whole /= 10U;
+    } while (whole);
+
+    /* no "-0" */
+    if (m < 0)
+        *--p = '-';
+
+    JSONW_Put(w, p, (size_t)(end - p));
+}
+
+const char *JSONW_Finish(JSONW_t *w)
+{
+    if (w->overflow || w->len >= w->cap)
+    {
+        atomic_fetch_add_explicit(&jsonw_dropped, 1U, memory_order_relaxed);
+        return NULL;
+    }
+    if (w->depth != 0)
+        return NULL;
+
+    w->buf[w->len] = '\0';
+    return w->buf;
+}
+
+uint32_t JSONW_Dropped(void)
+{
+    return atomic_load_explicit(&jsonw_dropped, memory_order_relaxed);
+}
@@ -0,0 +1,77 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*===========================================================
+ * Streaming JSON writer
+ *
+ * Writes compact JSON straight into a caller buffer: no tree, no
+ * heap. Output is byte-identical to cJSON_PrintUnformatted for the
+ * same members in the same order (same number formatting, same
+ * string escapes), so the MQTT messages did not change when the
+ * builders moved off cJSON. JSONW_Fixed is the one deliberate
+ * difference: scaled register values print at their resolution.
+ *
+ * Commas and nesting are tracked by the writer. Inside an object
+ * every value takes a key; inside an array pass NULL. If the
+ * buffer fills up the writer stops and JSONW_Finish returns NULL;
+ * such messages are counted (JSONW_Dropped) so a caller that
+ * drops them is not silent about it.
+ *
+ * A message whose start never changes (the "v/id/type/name/src"
+ * envelope) can be written once into a template writer and
+ * JSONW_From copies it, nesting state included, per message.
+ *===========================================================*/
+#define JSONW_MAX_DEPTH     8U
+#define JSONW_MAX_DECIMALS  6U
+
+typedef struct
+{
+    char    *buf;
+    size_t   cap;
+    size_t   len;
+    uint8_t  overflow;
+    uint8_t  depth;
+    uint8_t  count[JSONW_MAX_DEPTH];    /* members written per level */
+} JSONW_t;
+
+void JSONW_Init(JSONW_t *w, char *buf, size_t cap);
+
+/**
+ * @brief  Start 'w' in 'buf' as a copy of a template writer
+ */
+void JSONW_From(JSONW_t *w, const JSONW_t *tmpl, char *buf, size_t cap);
+
+void JSONW_ObjectBegin(JSONW_t *w, const char *key);
+void JSONW_ObjectEnd(JSONW_t *w);
+void JSONW_ArrayBegin(JSONW_t *w, const char *key);
+void JSONW_ArrayEnd(JSONW_t *w);
+
+void JSONW_Str(JSONW_t *w, const char *key, const char *value);
+void JSONW_Num(JSONW_t *w, const char *key, double value);
+
+/**
+ * @brief Number at a fixed resolution: rounded once to 'decimals'
+ *        fraction digits (at most JSONW_MAX_DECIMALS), then printed
+ *        with integer arithmetic and trailing zeros dropped, so a
+ *        0.01-scaled register prints as 12.34, not 12.340000152587891
+ */
+void JSONW_Fixed(JSONW_t *w, const char *key, double value, uint8_t decimals);
+void JSONW_Bool(JSONW_t *w, const char *key, int value);
+
+/**
+ * @brief  NUL-terminate the output
+ * @return The JSON text (the caller's buffer), NULL on overflow
+ *         or unclosed objects
+ */
+const char *JSONW_Finish(JSONW_t *w);
+
+/**
+ * @brief  Messages JSONW_Finish refused because they overflowed
+ *         their buffer, every writer and thread, since start-up
+ */
+uint32_t JSONW_Dropped(void);
+
+#endif /* JSON_WRITER_H */
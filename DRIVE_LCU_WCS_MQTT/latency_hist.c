@@ -0,0 +1,184 @@
+#include "latency_hist.h"
+#include "ini.h"
+#include "platform.h"
+#include <string.h>
+
+static HIST_Snapshot_t hist_cur;
+static uint32_t        hist_start_ms;
+static int             hist_started;
+
+/* Index of the highest set bit; v != 0 */
+static uint32_t HIST_Msb(uint32_t v)
+{
+#if defined(__GNUC__)
+    return 31U - (uint32_t)__builtin_clz(v);
+#else
+    uint32_t n = 0;
+    while (v >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+static uint32_t HIST_Index(uint32_t v)
+{
+    if (v >= (1UL << HIST_MAX_EXP))
+        v = (1UL << HIST_MAX_EXP) - 1U;
+    if (v < (1U << HIST_SUB_BITS))
+        return v;
+
+    uint32_t e = HIST_Msb(v);
+    uint32_t shift = e - HIST_SUB_BITS;
+    return ((shift + 1U) << HIST_SUB_BITS) +
+           ((v >> shift) & ((1U << HIST_SUB_BITS) - 1U));
+}
+
+/* Largest value that lands in bucket 'idx' */
+static uint32_t HIST_UpperEdge(uint32_t idx)
+{
+    if (idx < (1U << HIST_SUB_BITS))
+        return idx;
+
+    uint32_t shift = (idx >> HIST_SUB_BITS) - 1U;
+    uint32_t sub   = idx & ((1U << HIST_SUB_BITS) - 1U);
+    uint32_t lower = ((1U << HIST_SUB_BITS) + sub) << shift;
+    return lower + (1U << shift) - 1U;
+}
+
+void HIST_Add(HIST_t *h, uint32_t value_us)
+{
+    if (h->count == 0 || value_us < h->min_us)
+        h->min_us = value_us;
+    if (value_us > h->max_us)
+        h->max_us = value_us;
+    h->count++;
+    h->sum_us += value_us;
+    h->buckets[HIST_Index(value_us)]++;
+}
+
+uint32_t HIST_Percentile(const HIST_t *h, double pct)
+{
+    if (h->count == 0)
+        return 0;
+
+    /* rank of the sample wanted, 1-based */
+    uint64_t rank = (uint64_t)((pct / 100.0) * (double)h->count + 0.5);
+    if (rank < 1)
+        rank = 1;
+    if (rank > h->count)
+        rank = h->count;
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < HIST_BUCKETS; i++)
+    {
+        seen += h->buckets[i];
+        if (seen >= rank)
+        {
+            uint32_t edge = HIST_UpperEdge(i);
+            return (edge < h->max_us) ? edge : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+/*-----------------------------------------------------------
+ * Series lookup: linear over a handful of entries, most calls
+ * hit one of the first few
+ *-----------------------------------------------------------*/
+static HIST_Series_t *HIST_Func(uint8_t func)
+{
+    for (uint8_t i = 0; i < hist_cur.func_count; i++)
+    {
+        if (hist_cur.funcs[i].func == func)
+            return &hist_cur.funcs[i];
+    }
+    if (hist_cur.func_count == HIST_MAX_FUNCS)
+        return NULL;
+
+    HIST_Series_t *s = &hist_cur.funcs[hist_cur.func_count++];
+    s->func = func;
+    return s;
+}
+
+static HIST_Series_t *HIST_Range(uint8_t func, uint16_t addr)
+{
+    uint16_t width = (stats_cfg.REG_RANGE > 0) ? (uint16_t)stats_cfg.REG_RANGE : 1U;
+    uint16_t start = (uint16_t)(addr - addr % width);
+
+    for (uint8_t i = 0; i < hist_cur.range_count; i++)
+    {
+        if (hist_cur.ranges[i].func == func && hist_cur.ranges[i].range_start == start)
+            return &hist_cur.ranges[i];
+    }
+    if (hist_cur.range_count == HIST_MAX_RANGES)
+        return NULL;
+
+    HIST_Series_t *s = &hist_cur.ranges[hist_cur.range_count++];
+    s->func        = func;
+    s->range_start = start;
+    return s;
+}
+
+static void HIST_Start(void)
+{
+    if (!hist_started)
+    {
+        hist_start_ms = PLAT_TimeMs();
+        hist_started  = 1;
+    }
+}
+
+void HIST_Record(uint8_t func, uint16_t addr, uint32_t latency_us, int exception)
+{
+    HIST_Series_t *series[2] = { HIST_Func(func), HIST_Range(func, addr) };
+
+    HIST_Start();
+    for (int i = 0; i < 2; i++)
+    {
+        if (!series[i])
+        {
+            hist_cur.dropped++;
+            continue;
+        }
+        HIST_Add(&series[i]->hist, latency_us);
+        if (exception)
+            series[i]->exceptions++;
+    }
+}
+
+void HIST_RecordTimeout(uint8_t func, uint16_t addr)
+{
+    HIST_Series_t *series[2] = { HIST_Func(func), HIST_Range(func, addr) };
+
+    HIST_Start();
+    for (int i = 0; i < 2; i++)
+    {
+        if (!series[i])
+        {
+            hist_cur.dropped++;
+            continue;
+        }
+        series[i]->timeouts++;
+    }
+}
+
+void HIST_RecordSafetyWire(uint32_t latency_us)
+{
+    HIST_Start();
+    HIST_Add(&hist_cur.safety_wire, latency_us);
+}
+
+void HIST_Snapshot(HIST_Snapshot_t *out)
+{
+    uint32_t now_ms = PLAT_TimeMs();
+
+    if (out)
+    {
+        *out = hist_cur;
+        out->period_ms = hist_started ? now_ms - hist_start_ms : 0U;
+    }
+
+    memset(&hist_cur, 0, sizeof(hist_cur));
+    hist_start_ms = now_ms;
+    hist_started  = 1;
+}
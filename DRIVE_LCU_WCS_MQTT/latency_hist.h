@@ -0,0 +1,101 @@
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+
+/*===========================================================
+ * Modbus latency histograms
+ *
+ * Log-linear (HDR style) buckets: values below 2^HIST_SUB_BITS us
+ * get one bucket each, every power of two above that is split into
+ * 2^HIST_SUB_BITS linear buckets, so any recorded value is known to
+ * within 12.5%. Memory is fixed; recording is a bit scan and three
+ * increments, cheap enough to stay on in production.
+ *
+ * The engine records every completed or failed transaction twice:
+ * once under its function code and once under its register range
+ * ([STATS] REG_RANGE registers wide). HIST_Snapshot hands out the
+ * histograms filled since the previous snapshot and starts new ones.
+ * Safety-lane writes also record their submit-to-wire time.
+ *===========================================================*/
+#define HIST_SUB_BITS     3U
+#define HIST_MAX_EXP      27U   /* values clamp to 2^27 us (134 s) */
+#define HIST_BUCKETS      ((HIST_MAX_EXP - HIST_SUB_BITS + 1U) << HIST_SUB_BITS)
+
+#define HIST_MAX_FUNCS    8U    /* function codes tracked          */
+#define HIST_MAX_RANGES   16U   /* (function, register range) pairs */
+
+/**
+ * @brief One latency distribution, in microseconds
+ */
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[HIST_BUCKETS];
+} HIST_t;
+
+/**
+ * @brief A histogram plus the outcomes that have no latency
+ */
+typedef struct
+{
+    uint8_t  func;          /**< Function code                     */
+    uint16_t range_start;   /**< First register (range series only) */
+    uint32_t timeouts;      /**< Out of attempts or call deadline  */
+    uint32_t exceptions;    /**< Answered with an exception reply  */
+    HIST_t   hist;          /**< Send-to-reply time of answered requests */
+} HIST_Series_t;
+
+/**
+ * @brief Everything recorded between two snapshots
+ */
+typedef struct
+{
+    uint32_t      period_ms;        /**< Length of the interval      */
+    uint8_t       func_count;
+    uint8_t       range_count;
+    uint32_t      dropped;          /**< Records with no free series */
+    HIST_t        safety_wire;      /**< Safety lane issue-to-send   */
+    HIST_Series_t funcs[HIST_MAX_FUNCS];
+    HIST_Series_t ranges[HIST_MAX_RANGES];
+} HIST_Snapshot_t;
+
+/**
+ * @brief  Add one value to a histogram
+ */
+void HIST_Add(HIST_t *h, uint32_t value_us);
+
+/**
+ * @brief  Value below which 'pct' percent of the samples fall, as the
+ *         upper edge of the bucket holding it (never above max_us)
+ * @return Microseconds, 0 for an empty histogram
+ */
+uint32_t HIST_Percentile(const HIST_t *h, double pct);
+
+/**
+ * @brief  Record an answered transaction; 'exception' marks an
+ *         exception reply (its latency is recorded too)
+ */
+void HIST_Record(uint8_t func, uint16_t addr, uint32_t latency_us, int exception);
+
+/**
+ * @brief  Record a transaction that got no answer
+ */
+void HIST_RecordTimeout(uint8_t func, uint16_t addr);
+
+/**
+ * @brief  Record how long a safety-lane request took from submit
+ *         (for a posted write, from when its command was issued)
+ *         to its first hand-off to the transport
+ */
+void HIST_RecordSafetyWire(uint32_t latency_us);
+
+/**
+ * @brief  Copy the current interval into 'out' and start a new one
+ */
+void HIST_Snapshot(HIST_Snapshot_t *out);
+
+#endif /* LATENCY_HIST_H */
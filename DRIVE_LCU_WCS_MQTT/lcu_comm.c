@@ -14,6 +14,7 @@ static SOCKET client_sock = INVALID_SOCKET;
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#define INVALID_SOCKET  (-1)
 static int server_sock = -1;
 static int client_sock = -1;
 #endif
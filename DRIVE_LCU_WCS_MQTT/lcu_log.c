@@ -0,0 +1,608 @@
+#include "lcu_log.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#define LOG_RING_MASK     (LOG_RING_SIZE - 1U)
+#define LOG_LINE_BYTES    512U
+#define LOG_IDLE_SLEEP_MS 2U
+
+volatile int log_level = LOG_LEVEL_INFO;
+
+/*===========================================================
+ *  Record: the format pointer plus raw arguments; strings and
+ *  hex bytes are copied into the payload
+ *===========================================================*/
+typedef union
+{
+    long long          i;
+    unsigned long long u;
+    double             d;
+    const void        *p;
+    uint16_t           str;     /* payload offset of a copied %s */
+} LOG_Arg_t;
+
+typedef struct
+{
+    const char *fmt;
+    uint8_t     nargs;
+    uint8_t     complete;       /* every conversion was captured */
+    uint8_t     used;           /* payload bytes in use */
+    uint8_t     hex;            /* hex dump record */
+    uint8_t     hex_off;
+    uint8_t     hex_len;
+    LOG_Arg_t   args[LOG_MAX_ARGS];
+    char        payload[LOG_PAYLOAD_BYTES];
+} LOG_Record_t;
+
+/* Bounded MPSC ring (per-slot sequence numbers): a slot is free
+ * for position pos when seq == pos, readable when seq == pos + 1 */
+typedef struct
+{
+    atomic_size_t seq;
+    LOG_Record_t  rec;
+} LOG_Slot_t;
+
+static LOG_Slot_t    log_ring[LOG_RING_SIZE];
+static atomic_size_t log_head;          /* next position to claim */
+static size_t        log_tail;          /* writer thread only */
+
+static atomic_int    log_async;         /* records go through the ring */
+static atomic_int    log_stop;
+static atomic_int    log_done;
+
+static atomic_uint   log_written;
+static atomic_uint   log_dropped;
+static atomic_uint   log_truncated;
+
+/*===========================================================
+ *  Conversion specs, shared by capture and formatting
+ *===========================================================*/
+typedef enum
+{
+    LEN_NONE = 0, LEN_HH, LEN_H, LEN_L, LEN_LL,
+    LEN_J, LEN_Z, LEN_T, LEN_LD
+} LOG_Len_t;
+
+typedef struct
+{
+    const char *flags;      /* after '%': flags, width, precision */
+    size_t      flags_len;
+    uint8_t     stars;      /* '*' width / precision arguments */
+    LOG_Len_t   len;
+    char        conv;
+} LOG_Spec_t;
+
+/* Parse the spec after a '%'; returns the character after it */
+static const char *LOG_ParseSpec(const char *p, LOG_Spec_t *spec)
+{
+    spec->flags = p;
+    spec->stars = 0;
+
+    while (*p && strchr("-+ #0123456789.*", *p))
+    {
+        if (*p == '*')
+            spec->stars++;
+        p++;
+    }
+    spec->flags_len = (size_t)(p - spec->flags);
+
+    spec->len = LEN_NONE;
+    switch (*p)
+    {
+        case 'h':
+            p++;
+            spec->len = LEN_H;
+            if (*p == 'h') { p++; spec->len = LEN_HH; }
+            break;
+        case 'l':
+            p++;
+            spec->len = LEN_L;
+            if (*p == 'l') { p++; spec->len = LEN_LL; }
+            break;
+        case 'j': p++; spec->len = LEN_J;  break;
+        case 'z': p++; spec->len = LEN_Z;  break;
+        case 't': p++; spec->len = LEN_T;  break;
+        case 'L': p++; spec->len = LEN_LD; break;
+        default: break;
+    }
+
+    spec->conv = *p;
+    return (*p) ? p + 1 : p;
+}
+
+/*===========================================================
+ *  Capture (caller thread)
+ *===========================================================*/
+static void LOG_CopyString(LOG_Record_t *rec, LOG_Arg_t *arg, const char *s)
+{
+    size_t room = LOG_PAYLOAD_BYTES - rec->used;
+    size_t n;
+
+    if (!s)
+        s = "(null)";
+
+    n = strlen(s);
+    if (room == 0)
+    {
+        /* nothing left: point at the terminator of the last copy */
+        arg->str = (uint16_t)(LOG_PAYLOAD_BYTES - 1U);
+        rec->complete = 0;
+        return;
+    }
+    if (n + 1 > room)
+    {
+        n = room - 1;
+        rec->complete = 0;
+    }
+
+    arg->str = rec->used;
+    memcpy(&rec->payload[rec->used], s, n);
+    rec->payload[rec->used + n] = '\0';
+    rec->used = (uint8_t)(rec->used + n + 1);
+}
+
+static void LOG_Capture(LOG_Record_t *rec, const char *fmt, va_list ap)
+{
+    rec->fmt      = fmt;
+    rec->nargs    = 0;
+    rec->complete = 1;
+    rec->used     = 0;
+    rec->hex      = 0;
+    rec->hex_off  = 0;
+    rec->hex_len  = 0;
+
+    for (const char *p = fmt; *p; )
+    {
+        if (*p++ != '%')
+            continue;
+        if (*p == '%')
+        {
+            p++;
+            continue;
+        }
+
+        LOG_Spec_t spec;
+        p = LOG_ParseSpec(p, &spec);
+
+        if (rec->nargs + spec.stars + 1U > LOG_MAX_ARGS)
+        {
+            rec->complete = 0;
+            return;
+        }
+        for (uint8_t s = 0; s < spec.stars; s++)
+            rec->args[rec->nargs++].i = va_arg(ap, int);
+
+        LOG_Arg_t *arg = &rec->args[rec->nargs];
+        switch (spec.conv)
+        {
+            case 'd': case 'i': case 'c':
+                switch (spec.len)
+                {
+                    case LEN_L:  arg->i = va_arg(ap, long);      break;
+                    case LEN_LL: arg->i = va_arg(ap, long long); break;
+                    case LEN_J:  arg->i = (long long)va_arg(ap, intmax_t);  break;
+                    case LEN_Z:  arg->i = (long long)va_arg(ap, size_t);    break;
+                    case LEN_T:  arg->i = (long long)va_arg(ap, ptrdiff_t); break;
+                    default:     arg->i = va_arg(ap, int);       break;
+                }
+                break;
+
+            case 'u': case 'o': case 'x': case 'X':
+                switch (spec.len)
+                {
+                    case LEN_L:  arg->u = va_arg(ap, unsigned long);      break;
+                    case LEN_LL: arg->u = va_arg(ap, unsigned long long); break;
+                    case LEN_J:  arg->u = (unsigned long long)va_arg(ap, uintmax_t); break;
+                    case LEN_Z:  arg->u = (unsigned long long)va_arg(ap, size_t);    break;
+                    case LEN_T:  arg->u = (unsigned long long)va_arg(ap, ptrdiff_t); break;
+                    default:     arg->u = va_arg(ap, unsigned int);       break;
+                }
+                break;
+
+            case 'f': case 'F': case 'e': case 'E':
+            case 'g': case 'G': case 'a': case 'A':
+                if (spec.len == LEN_LD)
+                    arg->d = (double)va_arg(ap, long double);
+                else
+                    arg->d = va_arg(ap, double);
+                break;
+
+            case 's':
+                LOG_CopyString(rec, arg, va_arg(ap, const char *));
+                break;
+
+            case 'p':
+                arg->p = va_arg(ap, void *);
+                break;
+
+            default:
+                /* %n or unknown: format only what came before */
+                rec->complete = 0;
+                return;
+        }
+        rec->nargs++;
+    }
+}
+
+static void LOG_CaptureHex(LOG_Record_t *rec, const void *buf, size_t len)
+{
+    size_t room = LOG_PAYLOAD_BYTES - rec->used;
+
+    if (!buf)
+        len = 0;
+    if (len > room)
+    {
+        len = room;
+        rec->complete = 0;
+    }
+
+    rec->hex     = 1;
+    rec->hex_off = rec->used;
+    rec->hex_len = (uint8_t)len;
+    if (len > 0)
+        memcpy(&rec->payload[rec->used], buf, len);
+    rec->used = (uint8_t)(rec->used + len);
+}
+
+/*===========================================================
+ *  Formatting (writer thread, or the caller before LOG_Init)
+ *===========================================================*/
+typedef struct
+{
+    char   buf[LOG_LINE_BYTES];
+    size_t n;
+} LOG_Line_t;
+
+static void LOG_Append(LOG_Line_t *line, const char *fmt, ...)
+{
+    if (line->n >= sizeof(line->buf) - 1)
+        return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(&line->buf[line->n], sizeof(line->buf) - line->n, fmt, ap);
+    va_end(ap);
+
+    if (w > 0)
+    {
+        line->n += (size_t)w;
+        if (line->n > sizeof(line->buf) - 1)
+            line->n = sizeof(line->buf) - 1;
+    }
+}
+
+static void LOG_AppendText(LOG_Line_t *line, const char *s, size_t len)
+{
+    size_t room = sizeof(line->buf) - 1 - line->n;
+    if (len > room)
+        len = room;
+    memcpy(&line->buf[line->n], s, len);
+    line->n += len;
+    line->buf[line->n] = '\0';
+}
+
+static void LOG_Render(const LOG_Record_t *rec)
+{
+    LOG_Line_t line;
+    uint8_t    a = 0;
+    const char *p = rec->fmt;
+
+    line.n = 0;
+    line.buf[0] = '\0';
+
+    while (*p)
+    {
+        const char *lit = p;
+        while (*p && *p != '%')
+            p++;
+        LOG_AppendText(&line, lit, (size_t)(p - lit));
+        if (!*p)
+            break;
+
+        p++;
+        if (*p == '%')
+        {
+            LOG_AppendText(&line, "%", 1);
+            p++;
+            continue;
+        }
+
+        LOG_Spec_t spec;
+        const char *next = LOG_ParseSpec(p, &spec);
+
+        if (a + spec.stars + 1U > rec->nargs)
+        {
+            LOG_AppendText(&line, " [...]\n", 7);
+            break;
+        }
+
+        /* rebuild the spec with '*' resolved and a length that
+         * matches how the argument was stored */
+        char spec_fmt[48];
+        size_t k = 0;
+        spec_fmt[k++] = '%';
+        for (size_t i = 0; i < spec.flags_len && k < sizeof(spec_fmt) - 16; i++)
+        {
+            if (spec.flags[i] == '*')
+                k += (size_t)snprintf(&spec_fmt[k], sizeof(spec_fmt) - k,
+                                      "%d", (int)rec->args[a++].i);
+            else
+                spec_fmt[k++] = spec.flags[i];
+        }
+        spec_fmt[k] = '\0';
+
+        const LOG_Arg_t *arg = &rec->args[a++];
+        char tail[4] = { spec.conv, '\0' };
+        switch (spec.conv)
+        {
+            case 'd': case 'i':
+                strcat(spec_fmt, "ll");
+                strcat(spec_fmt, tail);
+                LOG_Append(&line, spec_fmt, arg->i);
+                break;
+            case 'c':
+                strcat(spec_fmt, tail);
+                LOG_Append(&line, spec_fmt, (int)arg->i);
+                break;
+            case 'u': case 'o': case 'x': case 'X':
+                strcat(spec_fmt, "ll");
+                strcat(spec_fmt, tail);
+                LOG_Append(&line, spec_fmt, arg->u);
+                break;
+            case 's':
+                strcat(spec_fmt, tail);
+                LOG_Append(&line, spec_fmt, &rec->payload[arg->str]);
+                break;
+            case 'p':
+                strcat(spec_fmt, tail);
+                LOG_Append(&line, spec_fmt, arg->p);
+                break;
+            default:
+                /* floating point */
+                strcat(spec_fmt, tail);
+                LOG_Append(&line, spec_fmt, arg->d);
+                break;
+        }
+        p = next;
+    }
+
+    if (rec->hex)
+    {
+        for (uint8_t i = 0; i < rec->hex_len; i++)
+            LOG_Append(&line, "%02X ", (uint8_t)rec->payload[rec->hex_off + i]);
+        LOG_AppendText(&line, "\n", 1);
+    }
+
+    fputs(line.buf, stdout);
+    atomic_fetch_add_explicit(&log_written, 1U, memory_order_relaxed);
+    if (!rec->complete)
+        atomic_fetch_add_explicit(&log_truncated, 1U, memory_order_relaxed);
+}
+
+/*===========================================================
+ *  Ring
+ *===========================================================*/
+static LOG_Record_t *LOG_Claim(size_t *pos_out)
+{
+    size_t pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+
+    for (;;)
+    {
+        LOG_Slot_t *slot = &log_ring[pos & LOG_RING_MASK];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+        if (dif == 0)
+        {
+            if (atomic_compare_exchange_weak_explicit(&log_head, &pos, pos + 1,
+                                                      memory_order_relaxed,
+                                                      memory_order_relaxed))
+            {
+                *pos_out = pos;
+                return &slot->rec;
+            }
+        }
+        else if (dif < 0)
+        {
+            return NULL;    /* full */
+        }
+        else
+        {
+            pos = atomic_load_explicit(&log_head, memory_order_relaxed);
+        }
+    }
+}
+
+static void LOG_Publish(size_t pos)
+{
+    atomic_store_explicit(&log_ring[pos & LOG_RING_MASK].seq, pos + 1,
+                          memory_order_release);
+}
+
+/* Format every readable record; returns how many */
+static uint32_t LOG_Drain(void)
+{
+    uint32_t n = 0;
+
+    for (;;)
+    {
+        LOG_Slot_t *slot = &log_ring[log_tail & LOG_RING_MASK];
+        size_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+
+        if (seq != log_tail + 1)
+            break;
+
+        LOG_Render(&slot->rec);
+        atomic_store_explicit(&slot->seq, log_tail + LOG_RING_SIZE,
+                              memory_order_release);
+        log_tail++;
+        n++;
+    }
+    return n;
+}
+
+static void LOG_ReportDropped(uint32_t *reported)
+{
+    uint32_t dropped = atomic_load_explicit(&log_dropped, memory_order_relaxed);
+
+    if (dropped != *reported)
+    {
+        printf("[LOG] %u record(s) dropped\n", (unsigned)(dropped - *reported));
+        *reported = dropped;
+    }
+}
+
+static void LOG_Thread(void *arg)
+{
+    uint32_t reported = 0;
+    (void)arg;
+
+    for (;;)
+    {
+        uint32_t n = LOG_Drain();
+        LOG_ReportDropped(&reported);
+
+        if (n == 0)
+        {
+            fflush(stdout);
+            if (atomic_load(&log_stop))
+                break;
+            PLAT_SleepMs(LOG_IDLE_SLEEP_MS);
+        }
+    }
+
+    atomic_store(&log_done, 1);
+}
+
+/*===========================================================
+ *  Public API
+ *===========================================================*/
+void LOG_Write(int level, const char *fmt, ...)
+{
+    LOG_Record_t  local;
+    LOG_Record_t *rec = &local;
+    size_t pos = 0;
+    int async = atomic_load_explicit(&log_async, memory_order_acquire);
+    va_list ap;
+
+    (void)level;
+    if (!fmt)
+        return;
+
+    if (async)
+    {
+        rec = LOG_Claim(&pos);
+        if (!rec)
+        {
+            atomic_fetch_add_explicit(&log_dropped, 1U, memory_order_relaxed);
+            return;
+        }
+    }
+
+    va_start(ap, fmt);
+    LOG_Capture(rec, fmt, ap);
+    va_end(ap);
+
+    if (async)
+        LOG_Publish(pos);
+    else
+        LOG_Render(rec);
+}
+
+void LOG_WriteHex(int level, const void *buf, size_t len, const char *fmt, ...)
+{
+    LOG_Record_t  local;
+    LOG_Record_t *rec = &local;
+    size_t pos = 0;
+    int async = atomic_load_explicit(&log_async, memory_order_acquire);
+    va_list ap;
+
+    (void)level;
+    if (!fmt)
+        return;
+
+    if (async)
+    {
+        rec = LOG_Claim(&pos);
+        if (!rec)
+        {
+            atomic_fetch_add_explicit(&log_dropped, 1U, memory_order_relaxed);
+            return;
+        }
+    }
+
+    va_start(ap, fmt);
+    LOG_Capture(rec, fmt, ap);
+    va_end(ap);
+    LOG_CaptureHex(rec, buf, len);
+
+    if (async)
+        LOG_Publish(pos);
+    else
+        LOG_Render(rec);
+}
+
+int LOG_Init(void)
+{
+    if (atomic_load(&log_async))
+        return 0;
+
+    fflush(stdout);
+    for (size_t i = 0; i < LOG_RING_SIZE; i++)
+        atomic_store_explicit(&log_ring[i].seq, i, memory_order_relaxed);
+    atomic_store(&log_head, 0);
+    log_tail = 0;
+
+    atomic_store(&log_stop, 0);
+    atomic_store(&log_done, 0);
+    atomic_store(&log_async, 1);
+
+    if (PLAT_ThreadStart(LOG_Thread, NULL) != 0)
+    {
+        atomic_store(&log_async, 0);
+        printf("[ERROR] Log writer thread failed to start, logging synchronously\n");
+        return -1;
+    }
+    return 0;
+}
+
+void LOG_Close(void)
+{
+    if (!atomic_load(&log_async))
+        return;
+
+    atomic_store(&log_stop, 1);
+    while (!atomic_load(&log_done))
+        PLAT_SleepMs(LOG_IDLE_SLEEP_MS);
+
+    /* records that raced the writer's last pass */
+    atomic_store(&log_async, 0);
+    LOG_Drain();
+    fflush(stdout);
+}
+
+void LOG_SetLevel(int level)
+{
+    if (level < LOG_LEVEL_ERROR)
+        level = LOG_LEVEL_ERROR;
+    if (level > LOG_LEVEL_DEBUG)
+        level = LOG_LEVEL_DEBUG;
+    log_level = level;
+}
+
+int LOG_GetLevel(void)
+{
+    return log_level;
+}
+
+void LOG_GetStats(LOG_Stats_t *out)
+{
+    if (!out)
+        return;
+    out->written   = atomic_load_explicit(&log_written, memory_order_relaxed);
+    out->dropped   = atomic_load_explicit(&log_dropped, memory_order_relaxed);
+    out->truncated = atomic_load_explicit(&log_truncated, memory_order_relaxed);
+}
@@ -0,0 +1,102 @@
+#ifndef LCU_LOG_H
+#define LCU_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*===========================================================
+ * Asynchronous logger
+ *
+ * LOG_* calls do not format or write anything: they copy the
+ * format pointer and the raw arguments into a fixed-size record
+ * in a lock-free ring and return. A background thread formats
+ * and writes the records. When the ring is full the record is
+ * dropped and counted; the writer reports the count instead of
+ * the caller ever blocking on the console.
+ *
+ * Two filters:
+ *   LOG_COMPILE_LEVEL  calls above it compile to nothing
+ *   [LOG] LEVEL        calls above it return after one compare
+ *
+ * Format strings must be literals (only the pointer is kept).
+ * %s arguments are copied, so they may be temporaries. %n is
+ * not supported.
+ *===========================================================*/
+#define LOG_LEVEL_ERROR   0
+#define LOG_LEVEL_WARN    1
+#define LOG_LEVEL_INFO    2
+#define LOG_LEVEL_DEBUG   3
+
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_RING_SIZE     256U  /* records; power of two */
+#define LOG_MAX_ARGS      12U   /* conversions per record */
+#define LOG_PAYLOAD_BYTES 128U  /* copied strings / hex bytes per record */
+
+/**
+ * @brief Logger counters since start-up
+ */
+typedef struct
+{
+    uint32_t written;   /**< Records formatted and written    */
+    uint32_t dropped;   /**< Records lost to a full ring      */
+    uint32_t truncated; /**< Records whose strings were cut   */
+} LOG_Stats_t;
+
+/**
+ * @brief  Start the writer thread; until then records are
+ *         formatted synchronously by the caller
+ * @return 0 on success, -1 if the thread could not start
+ */
+int LOG_Init(void);
+
+/**
+ * @brief  Stop the writer thread after it has drained the ring
+ */
+void LOG_Close(void);
+
+/**
+ * @brief  Runtime level (LOG_LEVEL_*), normally from [LOG] LEVEL
+ */
+void LOG_SetLevel(int level);
+int  LOG_GetLevel(void);
+
+/**
+ * @brief  Copy the logger counters
+ */
+void LOG_GetStats(LOG_Stats_t *out);
+
+/* use the macros below */
+extern volatile int log_level;
+
+void LOG_Write(int level, const char *fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    ;
+
+void LOG_WriteHex(int level, const void *buf, size_t len, const char *fmt, ...)
+#if defined(__GNUC__)
+    __attribute__((format(printf, 4, 5)))
+#endif
+    ;
+
+#define LOG_ENABLED(lvl) \
+    ((lvl) <= LOG_COMPILE_LEVEL && (lvl) <= log_level)
+
+#define LOG_AT(lvl, ...) \
+    do { if (LOG_ENABLED(lvl)) LOG_Write((lvl), __VA_ARGS__); } while (0)
+
+#define LOG_ERROR(...)  LOG_AT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#define LOG_WARN(...)   LOG_AT(LOG_LEVEL_WARN,  __VA_ARGS__)
+#define LOG_INFO(...)   LOG_AT(LOG_LEVEL_INFO,  __VA_ARGS__)
+#define LOG_DEBUG(...)  LOG_AT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+
+/* formatted prefix, then "XX XX ...\n"; the bytes share the
+ * payload with %s copies and are cut to what is left of it */
+#define LOG_HEX(lvl, buf, len, ...) \
+    do { if (LOG_ENABLED(lvl)) LOG_WriteHex((lvl), (buf), (len), __VA_ARGS__); } while (0)
+
+#endif /* LCU_LOG_H */
@@ -1,11 +1,6 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
-#include <time.h>
-
-#ifdef _WIN32
-#include <windows.h>
-#endif
 
 #include "ini.h"
 #include "lcu_comm.h"          // TCP server for WCS → LCU
@@ -16,26 +11,95 @@
 #include "drive_feedback.h"
 #include "drive_command.h"
 #include "modbus_functions.h"
+#include "drive_pool.h"
+#include "modbus_stats.h"
+#include "telemetry_acq.h"
+#include "scheduler.h"
+#include "flight_recorder.h"
+#include "platform.h"
+#include "lcu_log.h"
 
 /* --------------------------------------------------
- * Time helper
+ * Publisher thread: heartbeat and telemetry on their own
+ * scheduler grids, from the acquisition thread's samples,
+ * so they keep running while the main thread waits for the WCS
  * -------------------------------------------------- */
-static uint32_t GetTimeMs(void)
+/* ---- TASKS 4/5: one telemetry class, both axes ---- */
+static void Task_Telemetry(void *arg)
 {
-#ifdef _WIN32
-    return GetTickCount();
-#else
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (uint32_t)(ts.tv_sec * 1000U + ts.tv_nsec / 1000000U);
-#endif
+    static int boot_sent;
+    TelemetryMode_t mode = *(const TelemetryMode_t *)arg;
+
+    /* nothing to publish until every drive has been sampled; the
+     * boot info goes out first, on the first pass that can send */
+    if (!ACQ_Ready())
+        return;
+    if (!boot_sent)
+    {
+        Task_Send_Telemetry(AXIS_PAN,  TELEMETRY_ONCE);
+        Task_Send_Telemetry(AXIS_TILT, TELEMETRY_ONCE);
+        boot_sent = 1;
+    }
+
+    Task_Send_Telemetry(AXIS_PAN,  mode);
+    Task_Send_Telemetry(AXIS_TILT, mode);
 }
 
-int main(void)
+static void Task_Heartbeat(void *arg)
 {
-    uint32_t last_heartbeat_ms   = 0;
-    uint32_t last_periodic_ms    = 0;
+    (void)arg;
+    Task_Send_Heartbeat();
+}
 
+static void Task_ModbusStats(void *arg)
+{
+    (void)arg;
+    Task_Send_ModbusStats();
+}
+
+static void Task_Recorder(void *arg)
+{
+    (void)arg;
+    REC_Service();
+}
+
+static void Publisher_Thread(void *arg)
+{
+    static const TelemetryMode_t periodic   = TELEMETRY_PERIODIC;
+    static const TelemetryMode_t continuous = TELEMETRY_CONTINUOUS;
+    static SCHED_t sched;
+    (void)arg;
+
+    /* ---- TASK 2: MQTT internal processing ---- */
+    //MQTT_Loop();   // keep connection alive
+
+    /* rates from [TELEMETRY] and [STATS]. The heartbeat and stats
+     * go first: they never touch the drives' samples and run ahead
+     * of telemetry due at the same time, which waits in
+     * Task_Telemetry for the first samples */
+    if (SCHED_Init(&sched, "publish") != 0 ||
+        SCHED_Add(&sched, "heartbeat",  (uint32_t)telemetry_cfg.HEARTBEAT_MS,
+                  Task_Heartbeat, NULL) != 0 ||
+        (stats_cfg.PUBLISH_SEC > 0 &&
+         SCHED_Add(&sched, "modbus_stats", (uint32_t)stats_cfg.PUBLISH_SEC * 1000U,
+                   Task_ModbusStats, NULL) != 0) ||
+        SCHED_Add(&sched, "periodic",   (uint32_t)telemetry_cfg.PERIODIC_MS,
+                  Task_Telemetry, (void *)&periodic) != 0 ||
+        SCHED_Add(&sched, "continuous", (uint32_t)telemetry_cfg.CONTINUOUS_MS,
+                  Task_Telemetry, (void *)&continuous) != 0)
+    {
+        LOG_ERROR("[ERROR] Telemetry publish schedule could not be set up\n");
+        return;
+    }
+    /* writes out a frozen flight recorder capture */
+    if (recorder_cfg.ENABLE)
+        (void)SCHED_Add(&sched, "recorder", REC_SERVICE_MS, Task_Recorder, NULL);
+
+    SCHED_Run(&sched);
+}
+
+int main(void)
+{
     /* ---------------- LOAD CONFIG ---------------- */
     if (ini_load("config.ini") != 0)
     {
@@ -43,12 +107,9 @@ int main(void)
         return -1;
     }
 
-    /* ---------------- INIT TCP (WCS → LCU) ---------------- */
-    if (LCU_Comm_Init() != 0)
-    {
-        printf("ERROR: LCU TCP communication init failed\n");
-        return -1;
-    }
+    /* ---------------- START LOGGER ---------------- */
+    LOG_SetLevel(log_cfg.LEVEL);
+    LOG_Init();
 
     /* ---------------- INIT MQTT (LCU → WCS) ---------------- */
     if (mqtt_init() != 0)
@@ -57,56 +118,50 @@ int main(void)
         return -1;
     }
 
+    /* ---------------- INIT MODBUS (LCU -> DRIVES) ---------------- */
+    /* opens one link per [DRIVE] and probes optional function codes;
+     * a drive that is not up yet only fails its requests */
+    POOL_Init();
+
     printf("\n=====================================\n");
     printf(" LCU STARTED SUCCESSFULLY\n");
     printf(" TCP  : WCS -> LCU (Commands)\n");
     printf(" MQTT : LCU -> WCS (Heartbeat + Telemetry)\n");
     printf("=====================================\n");
 
-    /* ---------------- SEND BOOT TELEMETRY ---------------- */
-    // Task_Send_Telemetry(AXIS_PAN,  TELEMETRY_ONCE);
-    // Task_Send_Telemetry(AXIS_TILT, TELEMETRY_ONCE);
+    /* ---------------- START ACQUISITION + PUBLISHERS ---------------- */
+    if (ACQ_Start() != 0)
+    {
+        printf("ERROR: telemetry acquisition thread failed to start\n");
+        return -1;
+    }
+    if (PLAT_ThreadStart(Publisher_Thread, NULL) != 0)
+    {
+        printf("ERROR: telemetry publisher thread failed to start\n");
+        return -1;
+    }
+
+    /* ---------------- INIT TCP (WCS → LCU) ---------------- */
+    /* blocks until the WCS connects; telemetry already runs */
+    if (LCU_Comm_Init() != 0)
+    {
+        printf("ERROR: LCU TCP communication init failed\n");
+        return -1;
+    }
 
-    /* ---------------- MAIN LOOP ---------------- */
+    /* ---------------- MAIN LOOP: WCS COMMANDS ---------------- */
     while (1)
     {
-        //uint32_t now = GetTimeMs();
-
         /* ---- TASK 1: Receive TCP Command from WCS ---- */
         Receive_Command_From_WCS();
-        Sleep(10);  // allow other threads to run
-
-        /* ---- TASK 2: MQTT internal processing ---- */
-        //MQTT_Loop();   // keep connection alive
-
-        /* ---- TASK 3: Heartbeat (1 sec) ---- */
-        // if ((now - last_heartbeat_ms) >= 1000U)
-        // {
-        //     Task_Send_Heartbeat();
-        //     last_heartbeat_ms = now;
-        // }
-
-        /* ---- TASK 4: Periodic telemetry (5 sec) ---- */
-        // if ((now - last_periodic_ms) >= 5000U)
-        // {
-        //     Task_Send_Telemetry(AXIS_PAN,  TELEMETRY_PERIODIC);
-        //     Task_Send_Telemetry(AXIS_TILT, TELEMETRY_PERIODIC);
-        //     last_periodic_ms = now;
-        // }
-
-        /* ---- TASK 5: Continuous telemetry ---- */
-        // Task_Send_Telemetry(AXIS_PAN,  TELEMETRY_CONTINUOUS);
-        // Task_Send_Telemetry(AXIS_TILT, TELEMETRY_CONTINUOUS);
-
-#ifdef _WIN32
-        Sleep(10);   // prevent CPU hogging
-#else
-        usleep(10000);
-#endif
+        PLAT_SleepMs(10);  // allow other threads to run
     }
 
     /* ---------------- CLEANUP ---------------- */
+    ACQ_Stop();
     mqtt_close();
+    POOL_Close();
     LCU_Comm_Close();
+    LOG_Close();
     return 0;
 }
@@ -0,0 +1,45 @@
+#ifndef MODBUS_CRC_H
+#define MODBUS_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*===========================================================
+ * CRC16 (Modbus RTU) - poly 0xA001 reflected, init 0xFFFF,
+ * transmitted LSB first
+ *===========================================================*/
+
+/**
+ * @brief Build the slice-by-8 tables (call once at startup;
+ *        MODBUS_Init does this)
+ */
+void MODBUS_CRC_Init(void);
+
+/**
+ * @brief CRC of a frame, picks the fastest variant for its length
+ */
+uint16_t MODBUS_CRC16(const uint8_t *buf, size_t len);
+
+/**
+ * @brief One table lookup per byte
+ */
+uint16_t MODBUS_CRC16_Table(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Eight bytes per step, for block reads
+ *        (falls back to MODBUS_CRC16_Table before MODBUS_CRC_Init)
+ */
+uint16_t MODBUS_CRC16_Slice8(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Reference shift/xor implementation, eight steps per byte
+ */
+uint16_t MODBUS_CRC16_Bitwise(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Check the trailing CRC of a received frame
+ * @return 1 if the last two bytes match the CRC of the rest
+ */
+int MODBUS_CRC_Valid(const uint8_t *frame, size_t len);
+
+#endif /* MODBUS_CRC_H */
@@ -1,159 +1,1220 @@
 #include"axis_helper.h"
 #include "modbus_functions.h"
+#include "modbus_crc.h"
 #include"ini.h"
+#include "modbus_transport.h"
+#include "platform.h"
+#include "lcu_log.h"
+#include "latency_hist.h"
 #include <stdio.h>
 #include <string.h>
-#include <winsock2.h>
-#include <ws2tcpip.h>
 #include <stdint.h>
+#include <stdatomic.h>
 
-/* Configurable defaults (override in config.h if desired) */
-#ifndef MODBUS_RX_TIMEOUT_MS
-#define MODBUS_RX_TIMEOUT_MS   2000   /* ms receive timeout */
-#endif
+/*===========================================================
+ *  Transaction engine state, one per drive link
+ *  lanes    : submitted, waiting for a window slot; one FIFO per
+ *             priority, the safety lane is always served first
+ *  inflight : sent and unanswered, oldest first
+ *  ghosts   : timed-out attempts whose reply may still arrive
+ *  posts    : safety writes posted by threads that do not hold
+ *             the engine, taken onto the safety lane at the next
+ *             MODBUS_Poll
+ *===========================================================*/
+typedef struct
+{
+    uint8_t             hdr[6];     /* unit, func, addr, count/value */
+    uint16_t            expect_len;
+    uint32_t            tag;        /* attempt that went unanswered  */
+    const MODBUS_Txn_t *owner;      /* compared only, never dereferenced */
+    uint64_t            sent_us;
+    uint64_t            expires_us;
+} MODBUS_Ghost_t;
+
+typedef struct
+{
+    MODBUS_Txn_t *head;
+    MODBUS_Txn_t *tail;
+} MODBUS_Lane_t;
+
+enum
+{
+    MODBUS_POST_FREE = 0,
+    MODBUS_POST_FILLING,    /* claimed by the posting thread        */
+    MODBUS_POST_READY,      /* built, waiting for the engine        */
+    MODBUS_POST_TAKEN       /* on the safety lane, engine owns it   */
+};
+
+typedef struct
+{
+    atomic_int    state;    /* MODBUS_POST_*                        */
+    uint64_t      issued_us;
+    MODBUS_Txn_t  txn;
+    uint8_t       rx[16];   /* echo or exception reply              */
+} MODBUS_Post_t;
+
+typedef struct
+{
+    const MODBUS_Transport_t *transport;
+    MODBUS_Link_t link;
+    int           open;
+
+    MODBUS_Lane_t lanes[MODBUS_PRIO_COUNT];
+    MODBUS_Txn_t *inflight[MODBUS_MAX_INFLIGHT + MODBUS_SAFETY_SLOTS];
+    uint8_t       inflight_count;
+    MODBUS_Ghost_t ghosts[MODBUS_MAX_GHOSTS];
+    uint8_t       ghost_count;
+    MODBUS_Post_t posts[MODBUS_SAFETY_POSTS];
+    uint32_t      next_tag;
+    uint32_t      last_rtt_us;
+    MODBUS_Stats_t stats;
+
+    /* retransmission timer, RFC 6298 style */
+    uint32_t      srtt_us;
+    uint32_t      rttvar_us;
+    uint32_t      rto_us;
+    uint8_t       have_rtt;
+    uint32_t      jitter_seed;
+
+    /* loss of contact: counted once until the drive answers again */
+    uint8_t       fail_run;
+    uint8_t       lost;
 
-#ifndef MODBUS_SEND_RETRIES
-#define MODBUS_SEND_RETRIES    3      /* number of resend attempts */
-#endif
+    int8_t        fc23;     /* MODBUS_CAP_*: learned from 0x17 replies */
+} MODBUS_Engine_t;
 
-#ifndef MODBUS_POST_SEND_DELAY_MS
-#define MODBUS_POST_SEND_DELAY_MS 10  /* small delay to give drive time to respond */
-#endif
+static MODBUS_Engine_t  modbus_engines[MODBUS_MAX_LINKS];
+static MODBUS_Engine_t *modbus_active = &modbus_engines[0];
+
+/* ends the engine's socket wait when a safety write is posted */
+static PLAT_Waker_t    *modbus_waker;
 
 /*===========================================================
- *  CRC16 (Modbus RTU) – LSB first
+ *  Initialize Connection
  *===========================================================*/
-static uint16_t MODBUS_CRC16(const uint8_t *buf, uint16_t len)
+void MODBUS_Init(void)
 {
-    uint16_t crc = 0xFFFF;
-    uint16_t i, j;
+    MODBUS_CRC_Init();
 
-    for (i = 0; i < len; i++)
+    for (uint8_t i = 0; i < MODBUS_MAX_LINKS; i++)
     {
-        crc ^= buf[i];
-        for (j = 0; j < 8; j++)
-        {
-            if (crc & 1)
-                crc = (crc >> 1) ^ 0xA001;
-            else
-                crc >>= 1;
-        }
+        memset(&modbus_engines[i], 0, sizeof(modbus_engines[i]));
+        modbus_engines[i].fc23 = MODBUS_CAP_UNKNOWN;
     }
-    return crc;
+    modbus_active = &modbus_engines[0];
+}
+
+int MODBUS_Open(uint8_t link, const DRIVE_CONFIG *drv)
+{
+    if (link >= MODBUS_MAX_LINKS || !drv)
+        return -1;
+
+    MODBUS_Engine_t *eng = &modbus_engines[link];
+    if (eng->open)
+        return -1;
+
+    /* TRANSPORT = UDP (RTU frames) or TCP (Modbus/TCP) */
+    if (strcmp(drv->TRANSPORT, "TCP") == 0 || strcmp(drv->TRANSPORT, "tcp") == 0)
+        eng->transport = &MODBUS_TransportTcp;
+    else
+        eng->transport = &MODBUS_TransportUdp;
+
+    eng->link.drive = drv;
+    eng->link.stats = &eng->stats;
+    eng->link.state = NULL;
+
+    if (eng->transport->open(&eng->link) != 0)
+    {
+        printf("[ERROR] %s: Modbus %s transport failed to open\n",
+               drv->NAME, eng->transport->name);
+        return -1;
+    }
+    eng->open = 1;
+
+    /* after the first transport open: Windows sockets are started */
+    if (!modbus_waker && (modbus_waker = PLAT_WakerCreate()) == NULL)
+        printf("[WARN] Modbus wake-up socket failed; posted safety writes "
+               "wait for the engine's next deadline\n");
+
+    /* [MODBUS] USE_FC23 = -1: find out now whether 0x17 works */
+    if (modbus_cfg.USE_FC23 < 0 && modbus_cfg.FC23_PROBE_REG > 0)
+    {
+        MODBUS_Engine_t *prev = modbus_active;
+        modbus_active = eng;
+        int cap = MODBUS_ProbeReadWrite((uint8_t)drv->UNIT_ID,
+                                        (uint16_t)modbus_cfg.FC23_PROBE_REG);
+        modbus_active = prev;
+        printf("[OK] %s: drive FC23 (read/write multiple): %s\n", drv->NAME,
+               (cap == MODBUS_CAP_YES) ? "supported" :
+               (cap == MODBUS_CAP_NO)  ? "not supported" : "unknown, decided on first use");
+    }
+    return 0;
+}
+
+int MODBUS_Select(uint8_t link)
+{
+    if (link >= MODBUS_MAX_LINKS)
+        return -1;
+    modbus_active = &modbus_engines[link];
+    return 0;
+}
+
+uint8_t MODBUS_Selected(void)
+{
+    return (uint8_t)(modbus_active - modbus_engines);
+}
+
+static uint8_t MODBUS_Window(void)
+{
+    int depth = modbus_cfg.PIPELINE_DEPTH;
+    if (depth < 1) depth = 1;
+    if (depth > (int)MODBUS_MAX_INFLIGHT) depth = (int)MODBUS_MAX_INFLIGHT;
+    return (uint8_t)depth;
+}
+
+/*-----------------------------------------------------------
+ * Retransmission timer
+ * SRTT/RTTVAR as in TCP (RFC 6298): RTO = SRTT + 4 * RTTVAR,
+ * clamped to [RTO_MIN_MS, RTO_MAX_MS]. RTO_INIT_MS applies until
+ * the first sample.
+ *-----------------------------------------------------------*/
+static uint32_t MODBUS_MsToUs(int ms)
+{
+    return (ms > 0) ? (uint32_t)ms * 1000U : 0U;
+}
+
+static uint32_t MODBUS_ClampRto(uint32_t rto_us)
+{
+    uint32_t floor_us = MODBUS_MsToUs(modbus_cfg.RTO_MIN_MS);
+    uint32_t ceil_us  = MODBUS_MsToUs(modbus_cfg.RTO_MAX_MS);
+
+    if (ceil_us < floor_us)
+        ceil_us = floor_us;
+    if (rto_us < floor_us)
+        rto_us = floor_us;
+    if (rto_us > ceil_us)
+        rto_us = ceil_us;
+    return rto_us;
+}
+
+static void MODBUS_RttSample(MODBUS_Engine_t *eng, uint32_t rtt_us)
+{
+    if (!eng->have_rtt)
+    {
+        eng->srtt_us   = rtt_us;
+        eng->rttvar_us = rtt_us / 2U;
+        eng->have_rtt  = 1;
+    }
+    else
+    {
+        uint32_t err = (rtt_us > eng->srtt_us) ?
+                       rtt_us - eng->srtt_us : eng->srtt_us - rtt_us;
+
+        /* beta = 1/4, alpha = 1/8 */
+        eng->rttvar_us = eng->rttvar_us - eng->rttvar_us / 4U + err / 4U;
+        eng->srtt_us   = eng->srtt_us - eng->srtt_us / 8U + rtt_us / 8U;
+    }
+
+    eng->rto_us = MODBUS_ClampRto(eng->srtt_us + 4U * eng->rttvar_us);
+}
+
+static uint32_t MODBUS_BaseRto(MODBUS_Engine_t *eng)
+{
+    return eng->have_rtt ? eng->rto_us
+                                  : MODBUS_ClampRto(MODBUS_MsToUs(modbus_cfg.RTO_INIT_MS));
+}
+
+/* xorshift32; only spreads retries, no quality needed */
+static uint32_t MODBUS_Jitter(MODBUS_Engine_t *eng, uint32_t span)
+{
+    uint32_t x = eng->jitter_seed ? eng->jitter_seed : 0x2545F491U;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    eng->jitter_seed = x;
+    return span ? x % span : 0U;
+}
+
+/*
+ * Timeout for the attempt about to be sent: the RTO doubled for each
+ * earlier attempt plus up to 25% jitter, within the ceiling and the
+ * transaction's remaining call deadline.
+ */
+static uint32_t MODBUS_AttemptTimeout(MODBUS_Engine_t *eng, const MODBUS_Txn_t *txn,
+                                      uint64_t now_us)
+{
+    uint64_t rto = MODBUS_BaseRto(eng);
+
+    for (uint8_t i = 1; i < txn->attempts && rto < 0xFFFFFFFFULL; i++)
+        rto *= 2U;
+    if (txn->attempts > 1)
+        rto += MODBUS_Jitter(eng, (uint32_t)(rto / 4U) + 1U);
+    if (rto > 0xFFFFFFFFULL)
+        rto = 0xFFFFFFFFULL;
+    rto = MODBUS_ClampRto((uint32_t)rto);
+
+    if (txn->deadline_us != 0)
+    {
+        uint64_t left = (txn->deadline_us > now_us) ? txn->deadline_us - now_us : 0;
+        if (rto > left)
+            rto = left;
+    }
+    return (uint32_t)rto;
+}
+
+/* Append CRC to a frame of 'len' bytes, return new length */
+static uint16_t MODBUS_AppendCRC(uint8_t *frame, uint16_t len)
+{
+    uint16_t crc = MODBUS_CRC16(frame, len);
+    frame[len++] = (uint8_t)(crc & 0xFF);   /* LSB first */
+    frame[len++] = (uint8_t)(crc >> 8);
+    return len;
+}
+
+static void MODBUS_TxnReset(MODBUS_Txn_t *txn, uint8_t *rx, uint16_t rx_max)
+{
+    txn->rx       = rx;
+    txn->rx_max   = rx_max;
+    txn->rx_len   = -1;
+    txn->prio     = MODBUS_PRIO_NORMAL;
+    txn->attempts = 0;
+    txn->tag      = 0;
+    txn->sent_us  = 0;
+    txn->submit_us   = 0;
+    txn->timeout_us  = 0;
+    txn->deadline_us = 0;
+    txn->rtt_us   = 0;
+    txn->state    = MODBUS_TXN_IDLE;
+    txn->next     = NULL;
 }
 
 /*===========================================================
- *  UDP Globals
+ *  Transaction builders
  *===========================================================*/
-static SOCKET modbus_socket = INVALID_SOCKET;
-static struct sockaddr_in modbus_target;
-static int modbus_target_len = sizeof(modbus_target);
+int MODBUS_TxnRead(MODBUS_Txn_t *txn, uint8_t slave, uint8_t func,
+                   uint16_t addr, uint16_t count,
+                   uint8_t *rx, uint16_t rx_max)
+{
+    if (!txn || !rx || count == 0 || count > 125)
+        return -1;
+
+    txn->tx[0] = slave;
+    txn->tx[1] = func;
+    txn->tx[2] = (uint8_t)(addr >> 8);
+    txn->tx[3] = (uint8_t)(addr & 0xFF);
+    txn->tx[4] = (uint8_t)(count >> 8);
+    txn->tx[5] = (uint8_t)(count & 0xFF);
+
+    /* CRC included because your drive expects RTU frame over UDP */
+    txn->tx_len = MODBUS_AppendCRC(txn->tx, 6);
+
+    txn->unit_id    = slave;
+    txn->func       = func;
+    txn->expect_len = (uint16_t)(3U + count * 2U + 2U);
+
+    MODBUS_TxnReset(txn, rx, rx_max);
+    return 0;
+}
+
+int MODBUS_TxnWriteSingle(MODBUS_Txn_t *txn, uint8_t slave,
+                          uint16_t addr, uint16_t val,
+                          uint8_t *rx, uint16_t rx_max)
+{
+    if (!txn || !rx)
+        return -1;
+
+    txn->tx[0] = slave;
+    txn->tx[1] = 0x06;
+    txn->tx[2] = (uint8_t)(addr >> 8);
+    txn->tx[3] = (uint8_t)(addr & 0xFF);
+    txn->tx[4] = (uint8_t)(val >> 8);
+    txn->tx[5] = (uint8_t)(val & 0xFF);
+    txn->tx_len = MODBUS_AppendCRC(txn->tx, 6);
+
+    /* response echoes the request */
+    txn->unit_id    = slave;
+    txn->func       = 0x06;
+    txn->expect_len = 8U;
+
+    MODBUS_TxnReset(txn, rx, rx_max);
+    return 0;
+}
+
+int MODBUS_TxnWriteMultiple(MODBUS_Txn_t *txn, uint8_t slave,
+                            uint16_t addr, uint16_t num,
+                            const uint16_t *data,
+                            uint8_t *rx, uint16_t rx_max)
+{
+    uint16_t len = 7;
+
+    if (!txn || !rx || !data || num == 0 || num > 123)
+        return -1;
+
+    txn->tx[0] = slave;
+    txn->tx[1] = 0x10;
+    txn->tx[2] = (uint8_t)(addr >> 8);
+    txn->tx[3] = (uint8_t)(addr & 0xFF);
+    txn->tx[4] = (uint8_t)(num >> 8);
+    txn->tx[5] = (uint8_t)(num & 0xFF);
+    txn->tx[6] = (uint8_t)(num * 2);
+
+    for (uint16_t i = 0; i < num; i++)
+    {
+        txn->tx[len++] = (uint8_t)(data[i] >> 8);
+        txn->tx[len++] = (uint8_t)(data[i] & 0xFF);
+    }
+    txn->tx_len = MODBUS_AppendCRC(txn->tx, len);
+
+    /* response: unit, func, addr(2), count(2), CRC(2) */
+    txn->unit_id    = slave;
+    txn->func       = 0x10;
+    txn->expect_len = 8U;
+
+    MODBUS_TxnReset(txn, rx, rx_max);
+    return 0;
+}
+
+int MODBUS_TxnReadWrite(MODBUS_Txn_t *txn, uint8_t slave,
+                        uint16_t rd_addr, uint16_t rd_num,
+                        uint16_t wr_addr, uint16_t wr_num,
+                        const uint16_t *data,
+                        uint8_t *rx, uint16_t rx_max)
+{
+    uint16_t len = 11;
+
+    if (!txn || !rx || !data || rd_num == 0 || rd_num > 125 ||
+        wr_num == 0 || wr_num > 121)
+        return -1;
+
+    txn->tx[0]  = slave;
+    txn->tx[1]  = 0x17;
+    txn->tx[2]  = (uint8_t)(rd_addr >> 8);
+    txn->tx[3]  = (uint8_t)(rd_addr & 0xFF);
+    txn->tx[4]  = (uint8_t)(rd_num >> 8);
+    txn->tx[5]  = (uint8_t)(rd_num & 0xFF);
+    txn->tx[6]  = (uint8_t)(wr_addr >> 8);
+    txn->tx[7]  = (uint8_t)(wr_addr & 0xFF);
+    txn->tx[8]  = (uint8_t)(wr_num >> 8);
+    txn->tx[9]  = (uint8_t)(wr_num & 0xFF);
+    txn->tx[10] = (uint8_t)(wr_num * 2);
+
+    for (uint16_t i = 0; i < wr_num; i++)
+    {
+        txn->tx[len++] = (uint8_t)(data[i] >> 8);
+        txn->tx[len++] = (uint8_t)(data[i] & 0xFF);
+    }
+    txn->tx_len = MODBUS_AppendCRC(txn->tx, len);
+
+    /* response: unit, func, count, read data, CRC (the write is done first) */
+    txn->unit_id    = slave;
+    txn->func       = 0x17;
+    txn->expect_len = (uint16_t)(3U + rd_num * 2U + 2U);
+
+    MODBUS_TxnReset(txn, rx, rx_max);
+    return 0;
+}
 
 /*===========================================================
- *  Initialize UDP Connection
+ *  Engine internals
  *===========================================================*/
-void MODBUS_Init(void)
+static void MODBUS_QueuePush(MODBUS_Engine_t *eng, MODBUS_Txn_t *txn, int at_head)
+{
+    MODBUS_Lane_t *lane = &eng->lanes[txn->prio];
+
+    txn->state = MODBUS_TXN_QUEUED;
+
+    if (at_head)
+    {
+        txn->next = lane->head;
+        lane->head = txn;
+        if (!lane->tail)
+            lane->tail = txn;
+    }
+    else
+    {
+        txn->next = NULL;
+        if (lane->tail)
+            lane->tail->next = txn;
+        else
+            lane->head = txn;
+        lane->tail = txn;
+    }
+}
+
+/* Unlink 'txn' from its lane; 'prev' is its predecessor or NULL */
+static void MODBUS_QueueUnlink(MODBUS_Engine_t *eng, MODBUS_Txn_t *prev, MODBUS_Txn_t *txn)
+{
+    MODBUS_Lane_t *lane = &eng->lanes[txn->prio];
+
+    if (prev)
+        prev->next = txn->next;
+    else
+        lane->head = txn->next;
+
+    if (lane->tail == txn)
+        lane->tail = prev;
+    txn->next = NULL;
+}
+
+/* Next queued transaction, safety lane first */
+static MODBUS_Txn_t *MODBUS_QueuePop(MODBUS_Engine_t *eng)
 {
-    WSADATA wsa;
-    if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+    for (int p = MODBUS_PRIO_COUNT - 1; p >= 0; p--)
     {
-        printf("[ERROR] WSAStartup failed\n");
+        MODBUS_Txn_t *txn = eng->lanes[p].head;
+        if (txn)
+        {
+            MODBUS_QueueUnlink(eng, NULL, txn);
+            return txn;
+        }
+    }
+    return NULL;
+}
+
+static int MODBUS_QueueEmpty(const MODBUS_Engine_t *eng)
+{
+    for (int p = 0; p < MODBUS_PRIO_COUNT; p++)
+    {
+        if (eng->lanes[p].head)
+            return 0;
+    }
+    return 1;
+}
+
+static void MODBUS_InflightRemove(MODBUS_Engine_t *eng, uint8_t idx)
+{
+    for (uint8_t i = idx; i + 1U < eng->inflight_count; i++)
+        eng->inflight[i] = eng->inflight[i + 1U];
+    eng->inflight_count--;
+}
+
+/*-----------------------------------------------------------
+ * Request shape
+ * Two requests have the same shape when their replies cannot be
+ * told apart: same unit, function and reply length, and for the
+ * echoing writes (0x06 / 0x10) the same address and value/count.
+ *-----------------------------------------------------------*/
+static int MODBUS_Echoes(uint8_t func)
+{
+    return (func == 0x06 || func == 0x10);
+}
+
+static int MODBUS_SameShape(const uint8_t *a, uint16_t a_len,
+                            const uint8_t *b, uint16_t b_len)
+{
+    if (a[0] != b[0] || a[1] != b[1] || a_len != b_len)
+        return 0;
+    if (MODBUS_Echoes(a[1]))
+        return memcmp(&a[2], &b[2], 4) == 0;
+    return 1;
+}
+
+/* Could 'frame' be the reply to request header 'req'? */
+static int MODBUS_Answers(const uint8_t *req, uint16_t expect_len,
+                          const uint8_t *frame, int len)
+{
+    if (frame[0] != req[0])
+        return 0;
+
+    if (frame[1] & 0x80)
+        return ((frame[1] & 0x7F) == req[1] && len == 5);
+
+    if (frame[1] != req[1] || len != (int)expect_len)
+        return 0;
+    if (MODBUS_Echoes(req[1]))
+        return memcmp(&frame[2], &req[2], 4) == 0;
+    return 1;
+}
+
+/*-----------------------------------------------------------
+ * Ghosts: attempts that timed out but may still be answered
+ *-----------------------------------------------------------*/
+static void MODBUS_GhostAdd(MODBUS_Engine_t *eng, const MODBUS_Txn_t *txn)
+{
+    if (eng->ghost_count == MODBUS_MAX_GHOSTS)
+    {
+        /* full: forget the oldest, it is closest to expiry anyway */
+        memmove(&eng->ghosts[0], &eng->ghosts[1],
+                (MODBUS_MAX_GHOSTS - 1U) * sizeof(eng->ghosts[0]));
+        eng->ghost_count--;
+    }
+
+    MODBUS_Ghost_t *g = &eng->ghosts[eng->ghost_count++];
+    memcpy(g->hdr, txn->tx, sizeof(g->hdr));
+    g->expect_len = txn->expect_len;
+    g->tag        = txn->tag;
+    g->owner      = txn;
+    g->sent_us    = txn->sent_us;
+    /* keep the shape blocked for [MODBUS] STALE_MS, or one more RTO
+     * if that is longer; later replies are assumed never to come */
+    uint32_t hold_us = MODBUS_MsToUs(modbus_cfg.STALE_MS);
+    if (hold_us < MODBUS_BaseRto(eng))
+        hold_us = MODBUS_BaseRto(eng);
+    g->expires_us = txn->sent_us + txn->timeout_us + hold_us;
+}
+
+static void MODBUS_GhostRemove(MODBUS_Engine_t *eng, uint8_t idx)
+{
+    for (uint8_t i = idx; i + 1U < eng->ghost_count; i++)
+        eng->ghosts[i] = eng->ghosts[i + 1U];
+    eng->ghost_count--;
+}
+
+static void MODBUS_ExpireGhosts(MODBUS_Engine_t *eng, uint64_t now_us)
+{
+    uint8_t i = 0;
+    while (i < eng->ghost_count)
+    {
+        if (now_us >= eng->ghosts[i].expires_us)
+            MODBUS_GhostRemove(eng, i);
+        else
+            i++;
+    }
+}
+
+/* Number of live ghosts with the same shape as a request header */
+static uint8_t MODBUS_GhostCount(MODBUS_Engine_t *eng, const uint8_t *hdr,
+                                 uint16_t expect_len)
+{
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < eng->ghost_count; i++)
+    {
+        const MODBUS_Ghost_t *g = &eng->ghosts[i];
+        if (MODBUS_SameShape(g->hdr, g->expect_len, hdr, expect_len))
+            n++;
+    }
+    return n;
+}
+
+static int MODBUS_ShapeBusy(MODBUS_Engine_t *eng, const MODBUS_Txn_t *txn)
+{
+    /* transaction IDs tell every reply apart */
+    if (eng->transport->tid)
+        return 0;
+
+    for (uint8_t i = 0; i < eng->inflight_count; i++)
+    {
+        const MODBUS_Txn_t *other = eng->inflight[i];
+        if (MODBUS_SameShape(other->tx, other->expect_len, txn->tx, txn->expect_len))
+            return 1;
+    }
+    return MODBUS_GhostCount(eng, txn->tx, txn->expect_len) > 0;
+}
+
+/* Register address a request starts at (the read range for 0x17) */
+static uint16_t MODBUS_TxnAddr(const MODBUS_Txn_t *txn)
+{
+    return (uint16_t)((txn->tx[2] << 8) | txn->tx[3]);
+}
+
+static void MODBUS_ContactLost(MODBUS_Engine_t *eng)
+{
+    if (!eng->lost)
+    {
+        eng->lost = 1;
+        eng->stats.contact_losses++;
+    }
+}
+
+static void MODBUS_Fail(MODBUS_Engine_t *eng, MODBUS_Txn_t *txn)
+{
+    txn->rx_len = -1;
+    txn->state  = MODBUS_TXN_TIMEOUT;
+    eng->stats.timeouts++;
+    HIST_RecordTimeout(txn->func, MODBUS_TxnAddr(txn));
+
+    if (eng->fail_run < MODBUS_LOST_AFTER)
+        eng->fail_run++;
+    if (eng->fail_run >= MODBUS_LOST_AFTER)
+        MODBUS_ContactLost(eng);
+}
+
+/*
+ * Queued transaction whose latest attempt is 'tag', or NULL. 'owner'
+ * is only compared, never read: once the transaction has completed or
+ * failed it may be gone (a caller's stack frame), and tags are never
+ * reused, so an address match with the same tag is the same attempt.
+ */
+static MODBUS_Txn_t *MODBUS_QueueTake(MODBUS_Engine_t *eng, const MODBUS_Txn_t *owner,
+                                      uint32_t tag)
+{
+    for (int p = 0; p < MODBUS_PRIO_COUNT; p++)
+    {
+        MODBUS_Txn_t *prev = NULL;
+        for (MODBUS_Txn_t *txn = eng->lanes[p].head; txn; prev = txn, txn = txn->next)
+        {
+            if (txn == owner && txn->tag == tag)
+            {
+                MODBUS_QueueUnlink(eng, prev, txn);
+                return txn;
+            }
+        }
+    }
+    return NULL;
+}
+
+/* Hand one batch to the transport and start its attempt timers */
+static void MODBUS_SendBatch(MODBUS_Engine_t *eng, MODBUS_Txn_t **batch, uint8_t n)
+{
+    if (n == 0)
         return;
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        batch[i]->attempts++;
+        batch[i]->tag = ++eng->next_tag;
     }
 
-    modbus_socket = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
-    if (modbus_socket == INVALID_SOCKET)
+    /* one hand-off for the whole batch; a frame the OS did not take
+     * still counts as an attempt and the timeout path retries it */
+    if (eng->transport->send(&eng->link, batch, n) < 0)
     {
-        printf("[ERROR] Failed to create UDP socket! WSAErr=%d\n", WSAGetLastError());
-        WSACleanup();
+        /* link down (TCP not connected): waiting would only stall the
+         * caller, so the whole batch fails now */
+        for (uint8_t i = 0; i < n; i++)
+        {
+            for (uint8_t k = 0; k < eng->inflight_count; k++)
+            {
+                if (eng->inflight[k] == batch[i])
+                {
+                    MODBUS_InflightRemove(eng, k);
+                    break;
+                }
+            }
+            MODBUS_Fail(eng, batch[i]);
+        }
         return;
     }
 
-    /* set receive timeout */
-    DWORD timeout = MODBUS_RX_TIMEOUT_MS;
-    if (setsockopt(modbus_socket, SOL_SOCKET, SO_RCVTIMEO, (const char*)&timeout, sizeof(timeout)) != 0)
+    uint64_t now_us = PLAT_TimeUs();
+    for (uint8_t i = 0; i < n; i++)
     {
-        printf("[WARN] setsockopt SO_RCVTIMEO failed (WSAErr=%d)\n", WSAGetLastError());
+        batch[i]->sent_us    = now_us;
+        batch[i]->timeout_us = MODBUS_AttemptTimeout(eng, batch[i], now_us);
+        if (batch[i]->attempts > 1)
+            eng->stats.retries++;
+        else if (batch[i]->prio == MODBUS_PRIO_SAFETY)
+            HIST_RecordSafetyWire((uint32_t)(now_us - batch[i]->submit_us));
     }
+    eng->stats.tx_frames += n;
+}
 
-    /* Bind LOCAL PC IP + PORT */
-    struct sockaddr_in local = {0};
-    local.sin_family = AF_INET;
-    local.sin_port   = htons(net_cfg.LOCAL_BIND_PORT);
-    local.sin_addr.s_addr = inet_addr(net_cfg.LOCAL_BIND_IP);
+/*
+ * Move queued transactions onto the wire until the window is full.
+ * Without transaction IDs replies of one shape are told apart only by
+ * arrival order, which a single lost datagram breaks, so a request is
+ * held back while another of its shape is in flight or a ghost of its
+ * shape is alive. A safety write is exempt: every request of its exact
+ * shape draws the same echo, so whichever it matches is a true answer.
+ *
+ * Lanes are served highest first, each as its own batch, and the
+ * safety lane may run MODBUS_SAFETY_SLOTS past a full window.
+ */
+static void MODBUS_FillWindow(MODBUS_Engine_t *eng)
+{
+    MODBUS_Txn_t *batch[MODBUS_MAX_INFLIGHT];
+    uint8_t  window = MODBUS_Window();
+    uint64_t now_us = PLAT_TimeUs();
 
-    if (bind(modbus_socket, (struct sockaddr*)&local, sizeof(local)) != 0)
+    for (int p = MODBUS_PRIO_COUNT - 1; p >= 0; p--)
     {
-        printf("[ERROR] Failed local bind! %s:%u (WSAErr=%d)\n",
-               net_cfg.LOCAL_BIND_IP,net_cfg.LOCAL_BIND_PORT, WSAGetLastError());
-        closesocket(modbus_socket);
-        modbus_socket = INVALID_SOCKET;
-        WSACleanup();
-        return;
+        uint8_t limit = (p == MODBUS_PRIO_SAFETY) ?
+                        (uint8_t)(window + MODBUS_SAFETY_SLOTS) : window;
+        uint8_t n = 0;
+        MODBUS_Txn_t *prev = NULL;
+        MODBUS_Txn_t *txn  = eng->lanes[p].head;
+
+        while (eng->inflight_count < limit && txn)
+        {
+            MODBUS_Txn_t *next = txn->next;
+
+            if (txn->deadline_us != 0 && now_us >= txn->deadline_us)
+            {
+                /* waited out its whole call deadline in the queue */
+                MODBUS_QueueUnlink(eng, prev, txn);
+                MODBUS_Fail(eng, txn);
+                txn = next;
+                continue;
+            }
+
+            int echo = (txn->func == 0x06 || txn->func == 0x10);
+            if (!(p == MODBUS_PRIO_SAFETY && echo) && MODBUS_ShapeBusy(eng, txn))
+            {
+                prev = txn;
+                txn  = next;
+                continue;
+            }
+            MODBUS_QueueUnlink(eng, prev, txn);
+
+            txn->state = MODBUS_TXN_INFLIGHT;
+            eng->inflight[eng->inflight_count++] = txn;
+            batch[n++] = txn;
+
+            if (n == MODBUS_MAX_INFLIGHT)
+            {
+                MODBUS_SendBatch(eng, batch, n);
+                n = 0;
+            }
+            txn = next;
+        }
+
+        MODBUS_SendBatch(eng, batch, n);
     }
+}
+
+/* Retry or fail every in-flight transaction past its deadline */
+static void MODBUS_ExpireInflight(MODBUS_Engine_t *eng, uint64_t now_us)
+{
+    MODBUS_Txn_t *requeue[MODBUS_MAX_INFLIGHT + MODBUS_SAFETY_SLOTS];
+    uint8_t n = 0;
+    uint8_t i = 0;
+
+    while (i < eng->inflight_count)
+    {
+        MODBUS_Txn_t *txn = eng->inflight[i];
+        if (now_us - txn->sent_us < txn->timeout_us)
+        {
+            i++;
+            continue;
+        }
+
+        MODBUS_InflightRemove(eng, i);
+        MODBUS_GhostAdd(eng, txn);
+
+        int attempts_left = txn->attempts < modbus_cfg.MAX_ATTEMPTS;
+        int time_left     = txn->deadline_us == 0 || now_us < txn->deadline_us;
+        if (attempts_left && time_left)
+            requeue[n++] = txn;
+        else
+            MODBUS_Fail(eng, txn);
+    }
+
+    /* resend ahead of newer work of the same lane, oldest first */
+    while (n > 0)
+        MODBUS_QueuePush(eng, requeue[--n], 1);
+}
+
+/*
+ * Reject frames that cannot be a reply from an RTU drive before any
+ * decoder sees them: bad CRC, impossible length, or a read reply whose
+ * byte count disagrees with the datagram size.
+ */
+static int MODBUS_ValidateFrame(MODBUS_Engine_t *eng, const uint8_t *frame, int len)
+{
+    if (len < 5 || len > (int)MODBUS_MAX_ADU)
+    {
+        eng->stats.bad_frames++;
+        return 0;
+    }
+
+    if (eng->transport->crc && modbus_cfg.VERIFY_CRC &&
+        !MODBUS_CRC_Valid(frame, (size_t)len))
+    {
+        eng->stats.crc_errors++;
+        return 0;
+    }
+
+    uint8_t func = frame[1];
+    int ok;
+    if (func & 0x80)
+        ok = (len == 5);                          /* unit, func, code, CRC */
+    else if (func == 0x03 || func == 0x04 || func == 0x17)
+        ok = (frame[2] + 5 == len);               /* unit, func, count, data, CRC */
+    else if (func == 0x06 || func == 0x10)
+        ok = (len == 8);                          /* echo of addr + value/count */
     else
+        ok = 0;
+
+    if (!ok)
+        eng->stats.bad_frames++;
+    return ok;
+}
+
+/*
+ * 'exact' is set when the reply is known to answer the attempt sent at
+ * 'sent_us'. Karn's rule: only such replies feed the RTT estimate, so a
+ * retried request counts only when a transaction ID names the attempt.
+ */
+static void MODBUS_Complete(MODBUS_Engine_t *eng, MODBUS_Txn_t *txn,
+                            const uint8_t *frame, int len,
+                            uint64_t sent_us, uint64_t now_us, int exact)
+{
+    uint16_t copy = (uint16_t)len;
+    if (copy > txn->rx_max)
+        copy = txn->rx_max;
+    memcpy(txn->rx, frame, copy);
+
+    txn->rx_len = len;
+    txn->rtt_us = (uint32_t)(now_us - sent_us);
+    txn->state  = MODBUS_TXN_DONE;
+    eng->last_rtt_us = txn->rtt_us;
+    eng->fail_run = 0;
+    eng->lost     = 0;
+
+    if (txn->attempts > 1)
+        eng->stats.recovered++;
+    if (exact)
+        MODBUS_RttSample(eng, txn->rtt_us);
+
+    /* caller's view: queueing and retries included */
+    int exception = (frame[1] & 0x80) != 0;
+    if (exception)
+        eng->stats.exceptions++;
+    HIST_Record(txn->func, MODBUS_TxnAddr(txn),
+                (uint32_t)(now_us - txn->submit_us), exception);
+
+    /* any 0x17 reply settles whether the drive implements it */
+    if (txn->func == 0x17)
     {
-        printf("[OK] Bound to local %s:%u\n",
-               net_cfg.LOCAL_BIND_IP,net_cfg.LOCAL_BIND_PORT);
+        if (!(frame[1] & 0x80))
+            eng->fc23 = MODBUS_CAP_YES;
+        else if (frame[2] == 0x01)      /* ILLEGAL FUNCTION */
+            eng->fc23 = MODBUS_CAP_NO;
     }
+}
+
+/*
+ * Hand a received frame to the in-flight request it answers: by
+ * transaction ID when the transport has one, else the oldest request
+ * of the same shape.
+ */
+static void MODBUS_MatchResponse(MODBUS_Engine_t *eng, const MODBUS_Frame_t *f,
+                                 uint64_t now_us)
+{
+    const uint8_t *frame = f->data;
+    int len = f->len;
+    uint8_t by_tid = eng->transport->tid;
+
+    if (len < 5)
+        return;
+
+    for (uint8_t i = 0; i < eng->inflight_count; i++)
+    {
+        MODBUS_Txn_t *txn = eng->inflight[i];
+        if (by_tid && (uint16_t)txn->tag != f->tid)
+            continue;
+        if (!MODBUS_Answers(txn->tx, txn->expect_len, frame, len))
+            continue;
+
+        MODBUS_Complete(eng, txn, frame, len, txn->sent_us, now_us,
+                        txn->attempts == 1 || by_tid);
+        MODBUS_InflightRemove(eng, i);
+        return;
+    }
+
+    /* late reply to a timed-out attempt: it retires the oldest ghost */
+    for (uint8_t i = 0; i < eng->ghost_count; i++)
+    {
+        MODBUS_Ghost_t *g = &eng->ghosts[i];
+        if (by_tid && (uint16_t)g->tag != f->tid)
+            continue;
+        if (!MODBUS_Answers(g->hdr, g->expect_len, frame, len))
+            continue;
 
-    /* DRIVE IP + PORT */
-    memset(&modbus_target, 0, sizeof(modbus_target));
-    modbus_target.sin_family = AF_INET;
-    modbus_target.sin_port   = htons(net_cfg.DRIVE_PORT_UDP);
-    modbus_target.sin_addr.s_addr = inet_addr(net_cfg.DRIVE_IP_ADDR);
+        /* the only ghost of its shape (or the one its TID names) and
+         * its owner is still waiting to resend: use the reply */
+        MODBUS_Txn_t *owner = NULL;
+        if (by_tid || MODBUS_GhostCount(eng, g->hdr, g->expect_len) == 1)
+            owner = MODBUS_QueueTake(eng, g->owner, g->tag);
 
-    printf("[OK] Target Drive Set -> %s:%u\n",
-           net_cfg.DRIVE_IP_ADDR,net_cfg.DRIVE_PORT_UDP);
+        if (owner)
+            MODBUS_Complete(eng, owner, frame, len, g->sent_us, now_us, by_tid);
+        else
+            eng->stats.stale++;
+
+        MODBUS_GhostRemove(eng, i);
+        return;
+    }
+
+    /* no owner: duplicate or unsolicited datagram, drop it */
+    eng->stats.unmatched++;
+}
+
+/* Read every reply the transport already holds */
+static void MODBUS_ReceivePending(MODBUS_Engine_t *eng)
+{
+    static MODBUS_Frame_t frames[MODBUS_RX_BATCH];
+    int n;
+
+    do
+    {
+        n = eng->transport->recv(&eng->link, frames, (int)MODBUS_RX_BATCH);
+
+        uint64_t now_us = PLAT_TimeUs();
+        for (int i = 0; i < n; i++)
+        {
+            if (MODBUS_ValidateFrame(eng, frames[i].data, frames[i].len))
+                MODBUS_MatchResponse(eng, &frames[i], now_us);
+        }
+    } while (n == (int)MODBUS_RX_BATCH);
+}
+
+/* Earliest time the engine must act again; 0 when nothing is pending */
+static uint64_t MODBUS_NextDeadline(MODBUS_Engine_t *eng)
+{
+    uint64_t deadline = 0;
+
+    for (uint8_t i = 0; i < eng->inflight_count; i++)
+    {
+        const MODBUS_Txn_t *txn = eng->inflight[i];
+        uint64_t expires = txn->sent_us + txn->timeout_us;
+        if (deadline == 0 || expires < deadline)
+            deadline = expires;
+    }
+
+    /* queued work held back by a ghost may go once the ghost expires */
+    if (!MODBUS_QueueEmpty(eng))
+    {
+        for (uint8_t i = 0; i < eng->ghost_count; i++)
+        {
+            uint64_t expires = eng->ghosts[i].expires_us;
+            if (deadline == 0 || expires < deadline)
+                deadline = expires;
+        }
+    }
+
+    return deadline;
+}
+
+/* Queue a transaction whose call started at 'issued_us' */
+static void MODBUS_Enqueue(MODBUS_Engine_t *eng, MODBUS_Txn_t *txn, uint64_t issued_us)
+{
+    /* idle link: anything already waiting on the socket is stale */
+    if (eng->inflight_count == 0 && MODBUS_QueueEmpty(eng))
+        MODBUS_ReceivePending(eng);
+
+    txn->submit_us   = issued_us;
+    txn->deadline_us = (modbus_cfg.CALL_DEADLINE_MS > 0) ?
+                       issued_us + (uint64_t)modbus_cfg.CALL_DEADLINE_MS * 1000ULL : 0;
+    MODBUS_QueuePush(eng, txn, 0);
+}
+
+/* Move posted safety writes onto the safety lane */
+static void MODBUS_TakePosts(MODBUS_Engine_t *eng)
+{
+    for (uint8_t i = 0; i < MODBUS_SAFETY_POSTS; i++)
+    {
+        MODBUS_Post_t *p = &eng->posts[i];
+        if (atomic_load_explicit(&p->state, memory_order_acquire) != MODBUS_POST_READY)
+            continue;
+
+        MODBUS_Enqueue(eng, &p->txn, p->issued_us);
+        atomic_store_explicit(&p->state, MODBUS_POST_TAKEN, memory_order_relaxed);
+    }
 }
 
 /*===========================================================
- *  Internal: send then receive with retry
- *  (keeps CRC and RTU frame over UDP)
+ *  Engine API
  *===========================================================*/
-static int32_t MODBUS_SendAndRecv(const uint8_t *tx, uint16_t tx_len,
-                                  uint8_t *rx, uint16_t rx_max)
+int MODBUS_Submit(MODBUS_Txn_t *txn)
 {
-    int32_t res = -1;
-    for (int attempt = 0; attempt < MODBUS_SEND_RETRIES; ++attempt)
+    MODBUS_Engine_t *eng = modbus_active;
+
+    if (!txn || txn->tx_len == 0 || !eng->open)
+        return -1;
+
+    MODBUS_Enqueue(eng, txn, PLAT_TimeUs());
+
+    /* safety work goes out now, not at the caller's next poll */
+    if (txn->prio == MODBUS_PRIO_SAFETY)
+        MODBUS_FillWindow(eng);
+    return 0;
+}
+
+/*
+ * Every open link is pumped on each call: one wait covers the sockets
+ * of all drives, so requests to several drives overlap on the wire
+ * instead of each drive costing its own round trips.
+ */
+int MODBUS_Poll(void)
+{
+    MODBUS_Engine_t *busy[MODBUS_MAX_LINKS];
+    uint8_t  ready[MODBUS_MAX_LINKS];
+    intptr_t socks[MODBUS_MAX_LINKS + 1U];
+    uint8_t  owner[MODBUS_MAX_LINKS];
+    uint8_t  hit[MODBUS_MAX_LINKS + 1U];
+    uint8_t  nbusy = 0;
+    int      nsocks = 0;
+    int      buffered = 0;
+    uint64_t deadline = 0;
+    int      pending = 0;
+
+    for (uint8_t l = 0; l < MODBUS_MAX_LINKS; l++)
     {
-        int sent = sendto(modbus_socket, (const char*)tx, tx_len, 0,
-                          (struct sockaddr*)&modbus_target, modbus_target_len);
-        if (sent != tx_len)
+        MODBUS_Engine_t *eng = &modbus_engines[l];
+        if (!eng->open)
+            continue;
+
+        MODBUS_ExpireGhosts(eng, PLAT_TimeUs());
+        MODBUS_TakePosts(eng);
+        MODBUS_FillWindow(eng);
+
+        uint64_t next = MODBUS_NextDeadline(eng);
+        if (next == 0)
+            continue;
+        if (deadline == 0 || next < deadline)
+            deadline = next;
+
+        /* a link without a socket (TCP down) only runs its deadlines */
+        int held = 0;
+        intptr_t h = eng->transport->handle(&eng->link, &held);
+        if (h >= 0)
         {
-            printf("[WARN] sendto sent=%d expected=%d (WSAErr=%d)\n", sent, tx_len, WSAGetLastError());
-            /* continue retrying */
+            owner[nsocks]   = nbusy;
+            socks[nsocks++] = h;
         }
+        ready[nbusy]  = (uint8_t)held;
+        busy[nbusy++] = eng;
+        buffered |= held;
+    }
 
-        /* small delay to let drive respond (many drives need a few ms) */
-        Sleep(MODBUS_POST_SEND_DELAY_MS);
+    if (nbusy > 0)
+    {
+        /* wait no longer than the earliest deadline, and not at all
+         * when a link already holds replies in user space */
+        uint64_t now_us  = PLAT_TimeUs();
+        uint64_t wait_us = (buffered || deadline <= now_us) ? 0 : deadline - now_us;
+
+        /* a posted safety write ends the wait; the next call takes it */
+        int nwait = nsocks;
+        if (modbus_waker)
+            socks[nwait++] = PLAT_WakerHandle(modbus_waker);
+
+        int res = PLAT_WaitReadable(socks, hit, nwait, wait_us);
+        if (res < 0)
+            LOG_WARN("[WARN] Modbus socket wait failed\n");
+        if (res > 0 && nwait > nsocks && hit[nsocks])
+            PLAT_WakerDrain(modbus_waker);
 
-        /* receive into correct buffer (rx) */
-        res = recvfrom(modbus_socket, (char*)rx, rx_max, 0, NULL, NULL);
-        if (res > 0)
+        for (int i = 0; i < nsocks; i++)
         {
-            /* success */
-            break;
+            busy[owner[i]]->stats.syscalls++;
+            if (res > 0 && hit[i])
+                ready[owner[i]] = 1;
         }
-        else
+
+        for (uint8_t i = 0; i < nbusy; i++)
         {
-            int err = WSAGetLastError();
-            if (err == WSAETIMEDOUT || err == WSAEWOULDBLOCK)
-            {
-                /* timeout, will retry */
-                //printf("[DEBUG] recv timeout, attempt=%d\n", attempt+1);
-            }
-            else
-            {
-                printf("[WARN] recvfrom failed (WSAErr=%d)\n", err);
-                /* still retry a few times */
-            }
+            if (ready[i])
+                MODBUS_ReceivePending(busy[i]);
         }
+
+        now_us = PLAT_TimeUs();
+        for (uint8_t i = 0; i < nbusy; i++)
+            MODBUS_ExpireInflight(busy[i], now_us);
+    }
+
+    for (uint8_t l = 0; l < MODBUS_MAX_LINKS; l++)
+    {
+        const MODBUS_Engine_t *eng = &modbus_engines[l];
+        pending += eng->inflight_count + (MODBUS_QueueEmpty(eng) ? 0 : 1);
+    }
+    return pending;
+}
+
+uint32_t MODBUS_GetLastRttUs(void)
+{
+    return modbus_active->last_rtt_us;
+}
+
+void MODBUS_GetStats(MODBUS_Stats_t *out)
+{
+    MODBUS_Engine_t *eng = modbus_active;
+
+    if (!out)
+        return;
+
+    *out = eng->stats;
+    out->srtt_us   = eng->srtt_us;
+    out->rttvar_us = eng->rttvar_us;
+    out->rto_us    = MODBUS_BaseRto(eng);
+}
+
+int32_t MODBUS_Wait(MODBUS_Txn_t *txn)
+{
+    if (!txn)
+        return -1;
+
+    while (txn->state == MODBUS_TXN_QUEUED || txn->state == MODBUS_TXN_INFLIGHT)
+        (void)MODBUS_Poll();
+
+    return (txn->state == MODBUS_TXN_DONE) ? txn->rx_len : -1;
+}
+
+void MODBUS_WaitAll(void)
+{
+    while (MODBUS_Poll() > 0)
+    {
+        /* keep pumping */
     }
+}
 
+int MODBUS_PostSafetyWrite(uint8_t link, uint8_t slave, uint16_t addr, uint16_t val,
+                           uint64_t issued_us)
+{
+    if (link >= MODBUS_MAX_LINKS || !modbus_engines[link].open)
+        return -1;
+
+    MODBUS_Engine_t *eng = &modbus_engines[link];
+    for (uint8_t i = 0; i < MODBUS_SAFETY_POSTS; i++)
+    {
+        MODBUS_Post_t *p = &eng->posts[i];
+        int expected = MODBUS_POST_FREE;
+
+        if (!atomic_compare_exchange_strong(&p->state, &expected, MODBUS_POST_FILLING))
+            continue;
+
+        /* the slot is ours until it is READY */
+        (void)MODBUS_TxnWriteSingle(&p->txn, slave, addr, val, p->rx, sizeof(p->rx));
+        p->txn.prio  = MODBUS_PRIO_SAFETY;
+        p->txn.state = MODBUS_TXN_QUEUED;
+        p->issued_us = issued_us;
+        atomic_store_explicit(&p->state, MODBUS_POST_READY, memory_order_release);
+        if (modbus_waker)
+            PLAT_WakerSignal(modbus_waker);
+        return i;
+    }
+    return -1;
+}
+
+int32_t MODBUS_WaitPosted(uint8_t link, int post)
+{
+    if (link >= MODBUS_MAX_LINKS || post < 0 || post >= (int)MODBUS_SAFETY_POSTS)
+        return -1;
+
+    MODBUS_Engine_t *eng = &modbus_engines[link];
+    MODBUS_Post_t   *p   = &eng->posts[post];
+
+    /* the first poll takes it if the previous holder did not */
+    while (eng->open &&
+           (atomic_load_explicit(&p->state, memory_order_acquire) != MODBUS_POST_TAKEN ||
+            p->txn.state == MODBUS_TXN_QUEUED || p->txn.state == MODBUS_TXN_INFLIGHT))
+        (void)MODBUS_Poll();
+
+    int32_t res = (p->txn.state == MODBUS_TXN_DONE) ? p->txn.rx_len : -1;
+    atomic_store_explicit(&p->state, MODBUS_POST_FREE, memory_order_release);
     return res;
 }
 
+/*===========================================================
+ *  Internal: blocking send then receive with retry
+ *  (keeps CRC and RTU frame over UDP)
+ *===========================================================*/
+static int32_t MODBUS_SendAndRecv(MODBUS_Txn_t *txn)
+{
+    if (MODBUS_Submit(txn) != 0)
+        return -1;
+
+    return MODBUS_Wait(txn);
+}
+
+static void MODBUS_DumpRx(const uint8_t *rx, int32_t res)
+{
+    /* debug print: raw response */
+    LOG_HEX(LOG_LEVEL_DEBUG, rx, (res > 0) ? (size_t)res : 0U,
+            "[RX %d | %lu us] ", (int)res, (unsigned long)modbus_active->last_rtt_us);
+}
+
 /*===========================================================
  *  Internal Common Function: Send (03 / 04)
  *===========================================================*/
@@ -161,30 +1222,15 @@ static int32_t MODBUS_SendSimple(uint8_t slave, uint8_t func,
                                  uint16_t addr, uint16_t count,
                                  uint8_t *rx)
 {
-    uint8_t tx[8];
-    uint16_t crc;
-
-    tx[0] = slave;
-    tx[1] = func;
-    tx[2] = (uint8_t)(addr >> 8);
-    tx[3] = (uint8_t)(addr & 0xFF);
-    tx[4] = (uint8_t)(count >> 8);
-    tx[5] = (uint8_t)(count & 0xFF);
+    MODBUS_Txn_t txn;
 
-    /* CRC included because your drive expects RTU frame over UDP */
-    crc = MODBUS_CRC16(tx, 6);
-    tx[6] = (uint8_t)(crc & 0xFF);   /* LSB first */
-    tx[7] = (uint8_t)(crc >> 8);
+    if (MODBUS_TxnRead(&txn, slave, func, addr, count, rx, 256) != 0)
+        return -1;
 
-    int32_t res = MODBUS_SendAndRecv(tx, 8, rx, 256);
+    int32_t res = MODBUS_SendAndRecv(&txn);
 
     if (res > 0)
-    {
-        /* debug print: raw response */
-        printf("[RX %d] ", res);
-        for (int i = 0; i < res; ++i) printf("%02X ", rx[i]);
-        printf("\n");
-    }
+        MODBUS_DumpRx(rx, res);
     return res;
 }
 
@@ -205,34 +1251,17 @@ int32_t MODBUS_WriteHolding(uint8_t slave_id,
                             uint16_t reg_count,
                             uint8_t *rx_buf)
 {
+    MODBUS_Txn_t txn;
+
     if (reg_count == 0 || reg_count > 20)
         return -1;
 
-    uint8_t tx[64];
-    uint16_t idx = 0;
-
-    tx[idx++] = slave_id;              // Slave ID
-    tx[idx++] = 0x10;                  // Function Code 16
-    tx[idx++] = start_addr >> 8;       // Start addr high
-    tx[idx++] = start_addr & 0xFF;     // Start addr low
-    tx[idx++] = reg_count >> 8;        // Register count high
-    tx[idx++] = reg_count & 0xFF;      // Register count low
-    tx[idx++] = reg_count * 2;         // Byte count
-
-    // Register data
-    for (uint16_t i = 0; i < reg_count; i++)
-    {
-        tx[idx++] = values[i] >> 8;
-        tx[idx++] = values[i] & 0xFF;
-    }
-
-    // CRC
-    uint16_t crc = MODBUS_CRC16(tx, idx);
-    tx[idx++] = crc & 0xFF;            // CRC Low
-    tx[idx++] = crc >> 8;              // CRC High
+    if (MODBUS_TxnWriteMultiple(&txn, slave_id, start_addr, reg_count,
+                                values, rx_buf, 256) != 0)
+        return -1;
 
     // Send + Receive
-    return MODBUS_SendAndRecv(tx, idx, rx_buf, 256);
+    return MODBUS_SendAndRecv(&txn);
 }
 
 
@@ -250,29 +1279,23 @@ int32_t MODBUS_ReadInput(uint8_t id, uint16_t addr,
  *===========================================================*/
 int32_t MODBUS_WriteSingle(uint8_t id, uint16_t addr, uint16_t val)
 {
-    uint8_t tx[8];
-    uint8_t rx[256];
-    uint16_t crc;
+    return MODBUS_WriteSinglePrio(id, addr, val, MODBUS_PRIO_NORMAL);
+}
 
-    tx[0] = id;
-    tx[1] = 0x06;
-    tx[2] = (uint8_t)(addr >> 8);
-    tx[3] = (uint8_t)(addr & 0xFF);
-    tx[4] = (uint8_t)(val >> 8);
-    tx[5] = (uint8_t)(val & 0xFF);
+int32_t MODBUS_WriteSinglePrio(uint8_t id, uint16_t addr, uint16_t val,
+                               MODBUS_Prio_t prio)
+{
+    MODBUS_Txn_t txn;
+    uint8_t rx[256];
 
-    crc = MODBUS_CRC16(tx, 6);
-    tx[6] = (uint8_t)(crc & 0xFF);
-    tx[7] = (uint8_t)(crc >> 8);
+    if (MODBUS_TxnWriteSingle(&txn, id, addr, val, rx, sizeof(rx)) != 0)
+        return -1;
+    txn.prio = (uint8_t)prio;
 
-    int32_t res = MODBUS_SendAndRecv(tx, 8, rx, sizeof(rx));
+    int32_t res = MODBUS_SendAndRecv(&txn);
 
     if (res > 0)
-    {
-        printf("[RX %d] ", res);
-        for (int i = 0; i < res; ++i) printf("%02X ", rx[i]);
-        printf("\n");
-    }
+        MODBUS_DumpRx(rx, res);
     return res;
 }
 
@@ -282,41 +1305,64 @@ int32_t MODBUS_WriteSingle(uint8_t id, uint16_t addr, uint16_t val)
 int32_t MODBUS_WriteMultiple(uint8_t id, uint16_t addr,
                              uint16_t num, const uint16_t *data)
 {
-    uint8_t tx[260];
+    MODBUS_Txn_t txn;
     uint8_t rx[256];
-    uint16_t crc;
-    uint16_t i;
-    uint16_t len = 7;
 
-    tx[0] = id;
-    tx[1] = 0x10;
-    tx[2] = (uint8_t)(addr >> 8);
-    tx[3] = (uint8_t)(addr & 0xFF);
-    tx[4] = (uint8_t)(num >> 8);
-    tx[5] = (uint8_t)(num & 0xFF);
-    tx[6] = (uint8_t)(num * 2);
+    if (MODBUS_TxnWriteMultiple(&txn, id, addr, num, data, rx, sizeof(rx)) != 0)
+        return -1;
 
-    for (i = 0; i < num; i++)
-    {
-        tx[len++] = (uint8_t)(data[i] >> 8);
-        tx[len++] = (uint8_t)(data[i] & 0xFF);
-    }
+    int32_t res = MODBUS_SendAndRecv(&txn);
+
+    if (res > 0)
+        MODBUS_DumpRx(rx, res);
+    return res;
+}
+
+/*===========================================================
+ *  READ/WRITE MULTIPLE REGISTERS (0x17)
+ *===========================================================*/
+int32_t MODBUS_ReadWriteMultiple(uint8_t id,
+                                 uint16_t rd_addr, uint16_t rd_num,
+                                 uint16_t wr_addr, uint16_t wr_num,
+                                 const uint16_t *data, uint8_t *rx)
+{
+    MODBUS_Txn_t txn;
 
-    crc = MODBUS_CRC16(tx, len);
-    tx[len++] = (uint8_t)(crc & 0xFF);
-    tx[len++] = (uint8_t)(crc >> 8);
+    if (MODBUS_TxnReadWrite(&txn, id, rd_addr, rd_num, wr_addr, wr_num,
+                            data, rx, 256) != 0)
+        return -1;
 
-    int32_t res = MODBUS_SendAndRecv(tx, len+2, rx, sizeof(rx));
+    int32_t res = MODBUS_SendAndRecv(&txn);
 
     if (res > 0)
-    {
-        printf("[RX %d] ", res);
-        for (int i = 0; i < res; ++i) printf("%02X ", rx[i]);
-        printf("\n");
-    }
+        MODBUS_DumpRx(rx, res);
     return res;
 }
 
+int MODBUS_UseReadWrite(void)
+{
+    if (modbus_cfg.USE_FC23 >= 0)
+        return modbus_cfg.USE_FC23 != 0;
+
+    /* auto: try it until the drive has refused it once */
+    return modbus_active->fc23 != MODBUS_CAP_NO;
+}
+
+int MODBUS_ProbeReadWrite(uint8_t id, uint16_t addr)
+{
+    uint8_t rx[256];
+
+    /* write the register's own value back, so the probe changes nothing */
+    int32_t res = MODBUS_ReadHolding(id, addr, 1U, rx);
+    if (res < 7 || (rx[1] & 0x80) != 0)
+        return modbus_active->fc23;
+
+    uint16_t value = (uint16_t)((rx[3] << 8) | rx[4]);
+    (void)MODBUS_ReadWriteMultiple(id, addr, 1U, addr, 1U, &value, rx);
+
+    return modbus_active->fc23;
+}
+
 /*===========================================================
  *  CHECK DRIVE CONNECTION
  *===========================================================*/
@@ -328,51 +1374,62 @@ int32_t MODBUS_CheckConnection(void)
      * Best register for connection check:
      * Read Input Register 384 → Version (always present)
      */
-    int32_t res = MODBUS_ReadHolding(modbus_cfg.UNIT_ID,230, 2, rx);
+    int32_t res = MODBUS_ReadHolding((uint8_t)modbus_active->link.drive->UNIT_ID, 230, 2, rx);
 
     if (res <= 0)
     {
         /* no response */
+        MODBUS_ContactLost(modbus_active);
         return -1;
     }
 
     /* basic sanity: response should at least have unit + func + bytecount */
     if (res < 5)
     {
+        MODBUS_ContactLost(modbus_active);
         return -1;
     }
 
     /* check for exception (function code | 0x80) */
     if ((rx[1] & 0x80) != 0)
     {
+        MODBUS_ContactLost(modbus_active);
         return -1;
     }
 
-    /* Optionally: validate CRC on response (if your drive uses RTU CRC in response) */
-    if (res >= 5)
-    {
-        uint16_t recv_crc = (uint16_t)rx[res-2] | ((uint16_t)rx[res-1] << 8);
-        uint16_t calc_crc = MODBUS_CRC16(rx, (uint16_t)(res - 2));
-        if (recv_crc != calc_crc)
-        {
-            printf("[WARN] CRC mismatch: recv=0x%04X calc=0x%04X\n", recv_crc, calc_crc);
-            /* don't immediately fail—some custom drives may not include CRC; decide as needed */
-            /* return -1; */
-        }
-    }
+    /* CRC (UDP only) was already checked by the engine (VERIFY_CRC) */
 
     return 0;  /* OK -> drive reachable */
 }
 
 /*===========================================================
- *  Close UDP Connection
+ *  Close Connection
  *===========================================================*/
 void MODBUS_Close(void)
 {
-    if (modbus_socket != INVALID_SOCKET)
+    /* before the transports: on Windows the last close ends sockets */
+    PLAT_WakerDestroy(modbus_waker);
+    modbus_waker = NULL;
+
+    for (uint8_t l = 0; l < MODBUS_MAX_LINKS; l++)
     {
-        closesocket(modbus_socket);
-        modbus_socket = INVALID_SOCKET;
-        WSACleanup();
+        MODBUS_Engine_t *eng = &modbus_engines[l];
+
+        /* fail anything still pending so waiters do not spin */
+        MODBUS_Txn_t *txn;
+        while ((txn = MODBUS_QueuePop(eng)) != NULL)
+            txn->state = MODBUS_TXN_TIMEOUT;
+        while (eng->inflight_count > 0)
+        {
+            eng->inflight[0]->state = MODBUS_TXN_TIMEOUT;
+            MODBUS_InflightRemove(eng, 0);
+        }
+        eng->ghost_count = 0;
+
+        if (eng->open)
+        {
+            eng->transport->close(&eng->link);
+            eng->open = 0;
+        }
     }
 }
@@ -2,18 +2,232 @@
 #define MODBUS_FUNCTIONS_H
 
 #include <stdint.h>
+#include "ini.h"
+
+/*===========================================================
+ * Transaction engine
+ *===========================================================*/
+#define MODBUS_MAX_ADU        260U  /* largest RTU frame incl. CRC      */
+#define MODBUS_MAX_INFLIGHT   16U   /* hard cap on PIPELINE_DEPTH        */
+#define MODBUS_MAX_GHOSTS     32U   /* unanswered attempts remembered    */
+#define MODBUS_MAX_LINKS      8U    /* drives, one engine each           */
+#define MODBUS_SAFETY_SLOTS   2U    /* in-flight slots only safety may use */
+#define MODBUS_LOST_AFTER     3U    /* failed transactions in a row that
+                                       count as loss of contact          */
+#define MODBUS_SAFETY_POSTS   4U    /* posted safety writes per link     */
+
+typedef enum
+{
+    MODBUS_TXN_IDLE = 0,
+    MODBUS_TXN_QUEUED,      /* waiting for a free window slot  */
+    MODBUS_TXN_INFLIGHT,    /* sent, waiting for the response  */
+    MODBUS_TXN_DONE,        /* response matched and copied     */
+    MODBUS_TXN_TIMEOUT      /* attempts or call deadline used up */
+} MODBUS_TxnState_t;
+
+/**
+ * @brief Queue lane of a transaction. A higher lane is always sent
+ *        first and may use MODBUS_SAFETY_SLOTS beyond a full window,
+ *        so a stop command never waits behind slow telemetry.
+ */
+typedef enum
+{
+    MODBUS_PRIO_NORMAL = 0,  /* telemetry, parameters, motion   */
+    MODBUS_PRIO_SAFETY,      /* E-stop, halt, disable, limit trips */
+    MODBUS_PRIO_COUNT
+} MODBUS_Prio_t;
+
+/**
+ * @brief One request/response exchange with the drive.
+ *
+ * Responses carry no transaction ID in RTU framing, so a reply is
+ * matched to the in-flight request with the same unit ID, function
+ * code and expected response length (plus the echoed address and
+ * value/count for 0x06 / 0x10). Only one request of each such shape
+ * is in flight at a time. Over Modbus/TCP the MBAP transaction ID
+ * (low 16 bits of 'tag') picks the request instead.
+ *
+ * An attempt that times out is remembered as a "ghost" for a short
+ * stale window. While a ghost of the same shape is alive no request
+ * of that shape is sent, so a late reply can only land on the ghost
+ * and is dropped instead of being taken as the next request's answer.
+ */
+typedef struct MODBUS_Txn
+{
+    uint8_t  tx[MODBUS_MAX_ADU];   /**< Request frame incl. CRC        */
+    uint16_t tx_len;
+
+    uint8_t  unit_id;              /**< Match key: unit ID             */
+    uint8_t  func;                 /**< Match key: function code       */
+    uint16_t expect_len;           /**< Match key: response bytes      */
+
+    uint8_t *rx;                   /**< Caller buffer for the response */
+    uint16_t rx_max;
+    int32_t  rx_len;               /**< Bytes received, -1 on timeout  */
+
+    uint8_t  prio;                 /**< MODBUS_Prio_t, NORMAL by default */
+    uint8_t  attempts;
+    uint64_t submit_us;            /**< Time of MODBUS_Submit, or when a
+                                        posted write was issued        */
+    uint32_t tag;                  /**< Engine sequence of the latest attempt */
+    uint64_t sent_us;              /**< Time of the latest attempt     */
+    uint32_t timeout_us;           /**< Deadline of the latest attempt */
+    uint64_t deadline_us;          /**< Give up after this (0 = none)  */
+    uint32_t rtt_us;               /**< Send-to-match time of the reply */
+    volatile MODBUS_TxnState_t state;
+
+    struct MODBUS_Txn *next;       /**< Engine queue link              */
+} MODBUS_Txn_t;
+
+/**
+ * @brief  Build a read request (0x03 / 0x04) into a transaction
+ * @return 0 on success, -1 on invalid arguments
+ */
+int MODBUS_TxnRead(MODBUS_Txn_t *txn, uint8_t slave_id, uint8_t func,
+                   uint16_t start_addr, uint16_t num_regs,
+                   uint8_t *rx_buf, uint16_t rx_max);
+
+/**
+ * @brief  Build a write single register request (0x06)
+ */
+int MODBUS_TxnWriteSingle(MODBUS_Txn_t *txn, uint8_t slave_id,
+                          uint16_t reg_addr, uint16_t value,
+                          uint8_t *rx_buf, uint16_t rx_max);
+
+/**
+ * @brief  Build a write multiple registers request (0x10)
+ */
+int MODBUS_TxnWriteMultiple(MODBUS_Txn_t *txn, uint8_t slave_id,
+                            uint16_t start_addr, uint16_t num_regs,
+                            const uint16_t *data,
+                            uint8_t *rx_buf, uint16_t rx_max);
+
+/**
+ * @brief  Build a read/write multiple registers request (0x17).
+ *         The drive writes first, so reading the written range back
+ *         verifies the write in the same round trip.
+ */
+int MODBUS_TxnReadWrite(MODBUS_Txn_t *txn, uint8_t slave_id,
+                        uint16_t rd_addr, uint16_t rd_num,
+                        uint16_t wr_addr, uint16_t wr_num,
+                        const uint16_t *data,
+                        uint8_t *rx_buf, uint16_t rx_max);
+
+/**
+ * @brief  Queue a built transaction on the selected link; it is sent
+ *         as soon as that link's window (PIPELINE_DEPTH) has room. It fails once
+ *         [MODBUS] MAX_ATTEMPTS or CALL_DEADLINE_MS run out.
+ *         Set txn->prio after building to pick its lane; a safety
+ *         transaction is sent before this call returns.
+ * @return 0 on success, -1 on error
+ */
+int MODBUS_Submit(MODBUS_Txn_t *txn);
+
+/**
+ * @brief  Drive every open link once: fill the windows, then wait until
+ *         a response arrives on any link or the earliest deadline passes
+ * @return Number of transactions still queued or in flight, all links
+ */
+int MODBUS_Poll(void);
+
+/**
+ * @brief  Run the engine until the given transaction completes
+ * @return Bytes received or -1 on timeout
+ */
+int32_t MODBUS_Wait(MODBUS_Txn_t *txn);
+
+/**
+ * @brief  Run the engine until every submitted transaction completes
+ */
+void MODBUS_WaitAll(void);
+
+/**
+ * @brief  Post a safety-lane write single register (0x06) to link
+ *         'link' from any thread, without POOL_Lock. Whichever
+ *         thread runs the engine puts it on the wire at its next
+ *         MODBUS_Poll, ahead of that thread's own queued work.
+ * @param  issued_us When the command was issued (PLAT_TimeUs); the
+ *         call deadline and the safety wire latency count from it
+ * @return Post handle for MODBUS_WaitPosted, or -1 if the link is
+ *         not open or all MODBUS_SAFETY_POSTS slots are taken
+ */
+int MODBUS_PostSafetyWrite(uint8_t link, uint8_t slave_id, uint16_t reg_addr,
+                           uint16_t value, uint64_t issued_us);
+
+/**
+ * @brief  Run the engine until a posted write completes, then free
+ *         its slot; the caller holds POOL_Lock
+ * @return Bytes received, or -1 on failure
+ */
+int32_t MODBUS_WaitPosted(uint8_t link, int post);
+
+/**
+ * @brief Transport counters of one link since MODBUS_Open
+ */
+typedef struct
+{
+    uint32_t tx_frames;     /**< Requests put on the wire, incl. retries */
+    uint32_t rx_frames;     /**< Datagrams received                      */
+    uint32_t crc_errors;    /**< Dropped: CRC mismatch                   */
+    uint32_t bad_frames;    /**< Dropped: malformed header or length     */
+    uint32_t unmatched;     /**< Dropped: valid, but no request owns it  */
+    uint32_t stale;         /**< Dropped: late reply to a timed-out try  */
+    uint32_t foreign;       /**< Dropped: sender is not the drive        */
+    uint32_t syscalls;      /**< Socket send/recv/wait calls made        */
+    uint32_t timeouts;      /**< Transactions that failed: out of attempts,
+                                 past the call deadline or link down     */
+    uint32_t retries;       /**< Attempts after the first                */
+    uint32_t recovered;     /**< Transactions answered after a retry     */
+    uint32_t exceptions;    /**< Replies that were exception responses   */
+    uint32_t srtt_us;       /**< Smoothed round-trip time                */
+    uint32_t rttvar_us;     /**< Round-trip time variation               */
+    uint32_t rto_us;        /**< Current first-attempt timeout           */
+    uint32_t connects;      /**< Times the link to the drive came up;
+                                 a change means drive state may be lost  */
+    uint32_t contact_losses;/**< Times the drive stopped answering:
+                                 MODBUS_LOST_AFTER failures in a row or a
+                                 failed MODBUS_CheckConnection; a change
+                                 means drive state may be lost too (a
+                                 UDP drive power-cycles unnoticed)       */
+} MODBUS_Stats_t;
+
+/**
+ * @brief  Copy the transport counters of the selected link
+ */
+void MODBUS_GetStats(MODBUS_Stats_t *out);
+
+/**
+ * @brief  Round-trip time of the most recently matched response
+ * @return Microseconds from the last send attempt to the reply
+ */
+uint32_t MODBUS_GetLastRttUs(void);
 
 /*===========================================================
  * Function Prototypes
  *===========================================================*/
 
 /**
- * @brief  Initialize UDP socket for Modbus communication
+ * @brief  Reset the engine; no link is open afterwards
  */
 void MODBUS_Init(void);
 
 /**
- * @brief  Close UDP socket and cleanup
+ * @brief  Open link 'link' to one drive, over the drive's TRANSPORT
+ *         (UDP or TCP), and probe FC23 when [MODBUS] USE_FC23 = -1
+ * @return 0 on success, -1 on error
+ */
+int MODBUS_Open(uint8_t link, const DRIVE_CONFIG *drv);
+
+/**
+ * @brief  Make 'link' the target of MODBUS_Submit and of the calls
+ *         below that name no link (stats, FC23, checks)
+ * @return 0 on success, -1 if 'link' is out of range
+ */
+int MODBUS_Select(uint8_t link);
+uint8_t MODBUS_Selected(void);
+
+/**
+ * @brief  Close every link and fail pending transactions
  */
 void MODBUS_Close(void);
 
@@ -45,12 +259,48 @@ int32_t MODBUS_ReadInput(uint8_t slave_id, uint16_t start_addr,
 int32_t MODBUS_WriteSingle(uint8_t slave_id, uint16_t reg_addr,
                            uint16_t value);
 
+/**
+ * @brief  Write Single Register (0x06) on the given lane; a
+ *         MODBUS_PRIO_SAFETY write is sent ahead of queued work
+ *         and does not wait for a free window slot
+ */
+int32_t MODBUS_WriteSinglePrio(uint8_t slave_id, uint16_t reg_addr,
+                               uint16_t value, MODBUS_Prio_t prio);
+
 /**
  * @brief  Write Multiple Registers (Function Code 0x10)
  */
 int32_t MODBUS_WriteMultiple(uint8_t slave_id, uint16_t start_addr,
                              uint16_t num_regs, const uint16_t *data);
 
+/**
+ * @brief  Read/Write Multiple Registers (Function Code 0x17)
+ */
+int32_t MODBUS_ReadWriteMultiple(uint8_t slave_id,
+                                 uint16_t rd_addr, uint16_t rd_num,
+                                 uint16_t wr_addr, uint16_t wr_num,
+                                 const uint16_t *data, uint8_t *rx_buf);
+
+/* What is known about an optional drive feature */
+#define MODBUS_CAP_UNKNOWN   (-1)
+#define MODBUS_CAP_NO        0
+#define MODBUS_CAP_YES       1
+
+/**
+ * @brief  Find out whether the drive implements 0x17 by rewriting
+ *         holding register 'addr' with the value it already holds.
+ *         Called from MODBUS_Open when [MODBUS] USE_FC23 = -1.
+ * @return MODBUS_CAP_YES / _NO, or _UNKNOWN if the drive did not answer
+ */
+int MODBUS_ProbeReadWrite(uint8_t slave_id, uint16_t addr);
+
+/**
+ * @brief  Whether callers should use 0x17: forced by [MODBUS] USE_FC23,
+ *         else until the drive has answered it with ILLEGAL FUNCTION
+ * @return 1 to use 0x17, 0 to use 0x10 plus a 0x03 read
+ */
+int MODBUS_UseReadWrite(void);
+
 /**
  * @brief Check if drive is reachable
  * @return 0 on success, -1 on failure
@@ -0,0 +1,158 @@
+#include "modbus_stats.h"
+#include "mqtt_client.h"
+#include "ini.h"
+#include "modbus_functions.h"
+#include "drive_pool.h"
+#include "latency_hist.h"
+#include "scheduler.h"
+#include "cJSON.h"
+#include <stdio.h>
+#include <string.h>
+
+static void add_hist(cJSON *o, const HIST_t *h)
+{
+    if (h->count == 0)
+        return;
+
+    cJSON_AddNumberToObject(o, "min_us", h->min_us);
+    cJSON_AddNumberToObject(o, "p50_us", HIST_Percentile(h, 50.0));
+    cJSON_AddNumberToObject(o, "p90_us", HIST_Percentile(h, 90.0));
+    cJSON_AddNumberToObject(o, "p99_us", HIST_Percentile(h, 99.0));
+    cJSON_AddNumberToObject(o, "max_us", h->max_us);
+}
+
+static void add_series(cJSON *arr, const HIST_Series_t *s, int with_range)
+{
+    cJSON *o = cJSON_CreateObject();
+    if (!o)
+        return;
+
+    cJSON_AddNumberToObject(o, "fc", s->func);
+    if (with_range)
+    {
+        cJSON_AddNumberToObject(o, "reg_from", s->range_start);
+        cJSON_AddNumberToObject(o, "reg_to", s->range_start + stats_cfg.REG_RANGE - 1);
+    }
+    cJSON_AddNumberToObject(o, "count",      s->hist.count);
+    cJSON_AddNumberToObject(o, "timeouts",   s->timeouts);
+    cJSON_AddNumberToObject(o, "exceptions", s->exceptions);
+    add_hist(o, &s->hist);
+    cJSON_AddItemToArray(arr, o);
+}
+
+/* Link counters since start-up, summed over every drive */
+static void add_counters(cJSON *body)
+{
+    MODBUS_Stats_t sum;
+
+    memset(&sum, 0, sizeof(sum));
+    POOL_Lock();
+    int prev = POOL_Selected();
+    for (int d = 0; d < POOL_Count(); d++)
+    {
+        MODBUS_Stats_t st;
+        (void)POOL_Select(d);
+        MODBUS_GetStats(&st);
+        sum.tx_frames  += st.tx_frames;
+        sum.retries    += st.retries;
+        sum.timeouts   += st.timeouts;
+        sum.crc_errors += st.crc_errors;
+        sum.exceptions += st.exceptions;
+    }
+    (void)POOL_Select(prev);
+    POOL_Unlock();
+
+    cJSON *c = cJSON_AddObjectToObject(body, "totals");
+    if (!c)
+        return;
+    cJSON_AddNumberToObject(c, "tx_frames",  sum.tx_frames);
+    cJSON_AddNumberToObject(c, "retries",    sum.retries);
+    cJSON_AddNumberToObject(c, "timeouts",   sum.timeouts);
+    cJSON_AddNumberToObject(c, "crc_errors", sum.crc_errors);
+    cJSON_AddNumberToObject(c, "exceptions", sum.exceptions);
+}
+
+/* Scheduler tasks: runs, skipped deadlines and start jitter */
+static void add_tasks(cJSON *body)
+{
+    static SCHED_Report_t rep[SCHED_MAX_SCHEDULERS * SCHED_MAX_TASKS];   /* ~25 kB */
+    int n = SCHED_Snapshot(rep, (int)(sizeof(rep) / sizeof(rep[0])));
+
+    cJSON *arr = cJSON_AddArrayToObject(body, "tasks");
+    for (int i = 0; arr && i < n; i++)
+    {
+        cJSON *o = cJSON_CreateObject();
+        if (!o)
+            return;
+
+        cJSON_AddStringToObject(o, "sched", rep[i].sched);
+        cJSON_AddStringToObject(o, "task",  rep[i].task);
+        cJSON_AddNumberToObject(o, "period_ms",   rep[i].period_us / 1000U);
+        cJSON_AddNumberToObject(o, "runs",        rep[i].runs);
+        cJSON_AddNumberToObject(o, "overruns",    rep[i].overruns);
+        cJSON_AddNumberToObject(o, "max_exec_us", rep[i].max_exec_us);
+
+        /* late = start minus deadline */
+        cJSON *late = cJSON_AddObjectToObject(o, "late");
+        if (late)
+            add_hist(late, &rep[i].late);
+        cJSON_AddItemToArray(arr, o);
+    }
+}
+
+void Task_Send_ModbusStats(void)
+{
+    static HIST_Snapshot_t snap;    /* ~20 kB: keep it off the stack */
+
+    /* the engine records under the pool lock */
+    POOL_Lock();
+    HIST_Snapshot(&snap);
+    POOL_Unlock();
+
+    cJSON *root = cJSON_CreateObject();
+    if (!root)
+        return;
+
+    cJSON_AddNumberToObject(root, "v", 1);
+    cJSON_AddStringToObject(root, "id", "modbus_stats");
+    cJSON_AddStringToObject(root, "type", "Event");
+    cJSON_AddStringToObject(root, "name", "ModbusLatency");
+    cJSON_AddStringToObject(root, "src", "middleware");
+
+    cJSON *body = cJSON_AddObjectToObject(root, "body");
+    if (body)
+    {
+        cJSON_AddNumberToObject(body, "period_ms", snap.period_ms);
+        cJSON_AddNumberToObject(body, "dropped", snap.dropped);
+        add_counters(body);
+
+        /* latency is submit-to-reply, retries and queueing included */
+        cJSON *funcs  = cJSON_AddArrayToObject(body, "functions");
+        cJSON *ranges = cJSON_AddArrayToObject(body, "ranges");
+        for (uint8_t i = 0; funcs && i < snap.func_count; i++)
+            add_series(funcs, &snap.funcs[i], 0);
+        for (uint8_t i = 0; ranges && i < snap.range_count; i++)
+            add_series(ranges, &snap.ranges[i], 1);
+
+        /* E-stop / halt / disable: issue to first send */
+        cJSON *wire = cJSON_AddObjectToObject(body, "safety_to_wire");
+        if (wire)
+        {
+            cJSON_AddNumberToObject(wire, "count", snap.safety_wire.count);
+            add_hist(wire, &snap.safety_wire);
+        }
+
+        add_tasks(body);
+    }
+
+    char *json = cJSON_PrintUnformatted(root);
+    if (json)
+    {
+        mqtt_publish(net_cfg.MQTT_TOPIC_STATS,
+                     json,
+                     strlen(json));
+        cJSON_free(json);
+    }
+
+    cJSON_Delete(root);
+}
@@ -0,0 +1,8 @@
+#ifndef MODBUS_STATS_H
+#define MODBUS_STATS_H
+
+/* Publish the Modbus latency snapshot ([STATS]) over MQTT and
+ * start a new interval */
+void Task_Send_ModbusStats(void);
+
+#endif
@@ -0,0 +1,436 @@
+#include "modbus_transport.h"
+#include "ini.h"
+#include "platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#define TCP_ERRNO         WSAGetLastError()
+#define TCP_WOULDBLOCK(e) ((e) == WSAEWOULDBLOCK)
+#define TCP_INPROGRESS(e) ((e) == WSAEWOULDBLOCK)
+typedef int tcp_optlen_t;
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#define SOCKET            int
+#define INVALID_SOCKET    (-1)
+#define closesocket       close
+#define TCP_ERRNO         errno
+#define TCP_WOULDBLOCK(e) ((e) == EAGAIN || (e) == EWOULDBLOCK)
+#define TCP_INPROGRESS(e) ((e) == EINPROGRESS)
+typedef socklen_t tcp_optlen_t;
+#endif
+
+/*===========================================================
+ *  Modbus/TCP (MBAP) framing
+ *
+ *  MBAP header : TID(2) PID(2)=0 LEN(2) UNIT(1), then the PDU.
+ *  Requests are the engine's RTU frames minus the CRC; replies
+ *  are handed back RTU-shaped (unit + PDU + 2 zero bytes where
+ *  the CRC would be) so lengths and decoders stay the same.
+ *  The TID is the low 16 bits of the attempt tag.
+ *===========================================================*/
+#define MBAP_HDR_LEN          7U
+#define MBAP_MAX_LEN          254U      /* unit + largest PDU */
+#define TCP_CONNECT_TIMEOUT_MS 1000U    /* give up on a connect in progress */
+#define TCP_RECONNECT_MS       1000U    /* wait after a failed connect */
+#define TCP_SEND_STALL_MS      100U     /* give up on a full send buffer */
+
+typedef struct
+{
+    SOCKET             sock;
+    struct sockaddr_in target;
+    int                connecting;      /* connect() started, not finished */
+    uint32_t           connect_ms;      /* when it was started */
+    uint32_t           next_connect_ms;
+    int                have_connect_time;
+
+    /* reassembly of the reply byte stream */
+    uint8_t            rx[MODBUS_RX_BATCH * (6U + MBAP_MAX_LEN)];
+    size_t             rx_fill;
+
+    /* one window of requests, MBAP framed */
+    uint8_t            tx[MODBUS_MAX_INFLIGHT * (6U + MBAP_MAX_LEN)];
+} TCP_State_t;
+
+#define TCP(link)   ((TCP_State_t *)(link)->state)
+
+static int TCP_SetNonBlocking(SOCKET s)
+{
+#ifdef _WIN32
+    u_long nonblocking = 1;
+    return ioctlsocket(s, FIONBIO, &nonblocking);
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    return (flags < 0) ? -1 : fcntl(s, F_SETFL, flags | O_NONBLOCK);
+#endif
+}
+
+/* select() for write on the link socket; 1 ready, 0 timeout, -1 error */
+static int TCP_SelectWrite(MODBUS_Link_t *link, uint64_t wait_us)
+{
+    SOCKET s = TCP(link)->sock;
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(s, &fds);
+
+    struct timeval tv;
+    tv.tv_sec  = (long)(wait_us / 1000000ULL);
+    tv.tv_usec = (long)(wait_us % 1000000ULL);
+
+    int ready = select((int)s + 1, NULL, &fds, NULL, &tv);
+    link->stats->syscalls++;
+    if (ready < 0)
+        return -1;
+    return (ready > 0) ? 1 : 0;
+}
+
+static void TCP_Drop(MODBUS_Link_t *link, const char *why)
+{
+    TCP_State_t *st = TCP(link);
+    if (st->sock == INVALID_SOCKET)
+        return;
+
+    printf("[WARN] %s: Modbus/TCP connection dropped: %s (err=%d)\n",
+           link->drive->NAME, why, TCP_ERRNO);
+    closesocket(st->sock);
+    st->sock    = INVALID_SOCKET;
+    st->rx_fill = 0;
+}
+
+/*-----------------------------------------------------------
+ * Connection setup
+ * connect() is only started here and finished by TCP_ConnectPoll
+ * from the send and handle paths once the socket is writable, so
+ * a drive that is away never stalls the engine (and with it every
+ * other drive). Until then the link refuses requests.
+ *-----------------------------------------------------------*/
+static void TCP_ConnectFailed(MODBUS_Link_t *link)
+{
+    TCP_State_t *st = TCP(link);
+
+    if (st->sock != INVALID_SOCKET)
+        closesocket(st->sock);
+    st->sock       = INVALID_SOCKET;
+    st->connecting = 0;
+
+    /* back off from the failure, not from the attempt */
+    st->next_connect_ms   = PLAT_TimeMs() + TCP_RECONNECT_MS;
+    st->have_connect_time = 1;
+}
+
+static void TCP_Connected(MODBUS_Link_t *link)
+{
+    TCP_State_t *st = TCP(link);
+
+    st->connecting = 0;
+    st->rx_fill    = 0;
+    link->stats->connects++;
+    printf("[OK] %s: Modbus/TCP connected -> %s:%d\n",
+           link->drive->NAME, link->drive->DRIVE_IP_ADDR, link->drive->TCP_PORT);
+}
+
+/* Start a connect; 0 when connected or in progress, -1 on failure */
+static int TCP_Connect(MODBUS_Link_t *link)
+{
+    TCP_State_t *st = TCP(link);
+    uint32_t now_ms = PLAT_TimeMs();
+
+    /* rate-limit reconnects while the drive is away */
+    if (st->have_connect_time && (int32_t)(now_ms - st->next_connect_ms) < 0)
+        return -1;
+
+    st->sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (st->sock == INVALID_SOCKET)
+    {
+        printf("[ERROR] Failed to create TCP socket! err=%d\n", TCP_ERRNO);
+        TCP_ConnectFailed(link);
+        return -1;
+    }
+
+    /* requests are small and latency bound */
+    int opt = 1;
+    setsockopt(st->sock, IPPROTO_TCP, TCP_NODELAY, (char *)&opt, sizeof(opt));
+    setsockopt(st->sock, SOL_SOCKET, SO_KEEPALIVE, (char *)&opt, sizeof(opt));
+
+    if (TCP_SetNonBlocking(st->sock) != 0)
+    {
+        printf("[WARN] TCP non-blocking mode failed (err=%d)\n", TCP_ERRNO);
+    }
+
+    int res = connect(st->sock, (struct sockaddr *)&st->target, sizeof(st->target));
+    link->stats->syscalls++;
+    if (res == 0)
+    {
+        TCP_Connected(link);
+        return 0;
+    }
+    if (!TCP_INPROGRESS(TCP_ERRNO))
+    {
+        TCP_ConnectFailed(link);
+        return -1;
+    }
+
+    st->connecting = 1;
+    st->connect_ms = now_ms;
+    return 0;
+}
+
+/* Finish a connect in progress without waiting; 0 once connected */
+static int TCP_ConnectPoll(MODBUS_Link_t *link)
+{
+    TCP_State_t *st = TCP(link);
+
+    if (!st->connecting)
+        return (st->sock != INVALID_SOCKET) ? 0 : -1;
+
+    /* Windows reports a refused connect in the except set only */
+    fd_set wfds, efds;
+    FD_ZERO(&wfds);
+    FD_ZERO(&efds);
+    FD_SET(st->sock, &wfds);
+    FD_SET(st->sock, &efds);
+    struct timeval tv = { 0, 0 };
+
+    int ready = select((int)st->sock + 1, NULL, &wfds, &efds, &tv);
+    link->stats->syscalls++;
+    if (ready == 0)
+    {
+        if (PLAT_TimeMs() - st->connect_ms >= TCP_CONNECT_TIMEOUT_MS)
+            TCP_ConnectFailed(link);
+        return -1;
+    }
+
+    int so_error = 0;
+    tcp_optlen_t len = sizeof(so_error);
+    if (ready < 0 ||
+        getsockopt(st->sock, SOL_SOCKET, SO_ERROR, (char *)&so_error, &len) != 0 ||
+        so_error != 0)
+    {
+        TCP_ConnectFailed(link);
+        return -1;
+    }
+
+    TCP_Connected(link);
+    return 0;
+}
+
+/*===========================================================
+ *  Transport ops
+ *===========================================================*/
+static int TCP_Open(MODBUS_Link_t *link)
+{
+    const DRIVE_CONFIG *drv = link->drive;
+
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+    {
+        printf("[ERROR] WSAStartup failed\n");
+        return -1;
+    }
+#endif
+
+    TCP_State_t *st = calloc(1, sizeof(*st));
+    if (!st)
+    {
+#ifdef _WIN32
+        WSACleanup();
+#endif
+        return -1;
+    }
+    link->state = st;
+
+    st->sock = INVALID_SOCKET;
+    st->target.sin_family = AF_INET;
+    st->target.sin_port   = htons((uint16_t)drv->TCP_PORT);
+    st->target.sin_addr.s_addr = inet_addr(drv->DRIVE_IP_ADDR);
+
+    /* a drive that is not up yet is reconnected on a later send */
+    if (TCP_Connect(link) != 0)
+    {
+        printf("[WARN] %s: Modbus/TCP connect to %s:%d failed, will retry\n",
+               drv->NAME, drv->DRIVE_IP_ADDR, drv->TCP_PORT);
+    }
+    return 0;
+}
+
+static void TCP_Close(MODBUS_Link_t *link)
+{
+    TCP_State_t *st = TCP(link);
+    if (!st)
+        return;
+
+    if (st->sock != INVALID_SOCKET)
+        closesocket(st->sock);
+    free(st);
+    link->state = NULL;
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+static int TCP_Send(MODBUS_Link_t *link, MODBUS_Txn_t *const *txns, uint8_t count)
+{
+    TCP_State_t *st = TCP(link);
+    uint8_t *buf = st->tx;
+    size_t len = 0;
+
+    /* no connection yet: the engine fails the batch at once */
+    if (st->sock == INVALID_SOCKET && TCP_Connect(link) != 0)
+        return -1;
+    if (TCP_ConnectPoll(link) != 0)
+        return -1;
+
+    /* every request of the batch goes out in one send() */
+    for (uint8_t i = 0; i < count && i < MODBUS_MAX_INFLIGHT; i++)
+    {
+        const MODBUS_Txn_t *txn = txns[i];
+        uint16_t adu = (uint16_t)(txn->tx_len - 2U);    /* unit + PDU, no CRC */
+        uint16_t tid = (uint16_t)txn->tag;
+
+        buf[len++] = (uint8_t)(tid >> 8);
+        buf[len++] = (uint8_t)(tid & 0xFF);
+        buf[len++] = 0;
+        buf[len++] = 0;
+        buf[len++] = (uint8_t)(adu >> 8);
+        buf[len++] = (uint8_t)(adu & 0xFF);
+        memcpy(&buf[len], txn->tx, adu);
+        len += adu;
+    }
+
+    size_t done = 0;
+    while (done < len)
+    {
+        int res = send(st->sock, (const char *)&buf[done], (int)(len - done), 0);
+        link->stats->syscalls++;
+        if (res > 0)
+        {
+            done += (size_t)res;
+            continue;
+        }
+
+        /* a partial frame would desync the stream: wait or drop */
+        if (res < 0 && TCP_WOULDBLOCK(TCP_ERRNO) &&
+            TCP_SelectWrite(link, (uint64_t)TCP_SEND_STALL_MS * 1000ULL) > 0)
+            continue;
+
+        TCP_Drop(link, "send failed");
+        return 0;
+    }
+    return count;
+}
+
+/* Complete MBAP frame at the front of the stream buffer? */
+static int TCP_FrameReady(const TCP_State_t *st)
+{
+    if (st->rx_fill < MBAP_HDR_LEN)
+        return 0;
+    uint16_t adu = (uint16_t)((st->rx[4] << 8) | st->rx[5]);
+    return st->rx_fill >= 6U + adu;
+}
+
+static intptr_t TCP_Handle(MODBUS_Link_t *link, int *buffered)
+{
+    TCP_State_t *st = TCP(link);
+
+    /* while down or connecting nothing can arrive */
+    if (!st || TCP_ConnectPoll(link) != 0)
+    {
+        *buffered = 0;
+        return -1;
+    }
+    *buffered = TCP_FrameReady(st);
+    return (intptr_t)st->sock;
+}
+
+static int TCP_Recv(MODBUS_Link_t *link, MODBUS_Frame_t *frames, int max)
+{
+    TCP_State_t *st = TCP(link);
+    int n = 0;
+
+    if (st->sock == INVALID_SOCKET || st->connecting)
+        return 0;
+
+    /* pull whatever the kernel holds, as far as the buffer allows */
+    if (st->rx_fill < sizeof(st->rx))
+    {
+        int res = recv(st->sock, (char *)&st->rx[st->rx_fill],
+                       (int)(sizeof(st->rx) - st->rx_fill), 0);
+        link->stats->syscalls++;
+        if (res == 0)
+        {
+            TCP_Drop(link, "closed by drive");
+            return 0;
+        }
+        if (res < 0)
+        {
+            if (!TCP_WOULDBLOCK(TCP_ERRNO))
+            {
+                TCP_Drop(link, "recv failed");
+                return 0;
+            }
+        }
+        else
+        {
+            st->rx_fill += (size_t)res;
+        }
+    }
+
+    size_t pos = 0;
+    while (n < max && st->rx_fill - pos >= MBAP_HDR_LEN)
+    {
+        const uint8_t *hdr = &st->rx[pos];
+        uint16_t pid = (uint16_t)((hdr[2] << 8) | hdr[3]);
+        uint16_t adu = (uint16_t)((hdr[4] << 8) | hdr[5]);
+
+        if (pid != 0 || adu < 2U || adu > MBAP_MAX_LEN)
+        {
+            /* no way to find the next frame boundary */
+            link->stats->bad_frames++;
+            TCP_Drop(link, "bad MBAP header");
+            return n;
+        }
+        if (st->rx_fill - pos < 6U + adu)
+            break;
+
+        MODBUS_Frame_t *f = &frames[n++];
+        memcpy(f->data, &hdr[6], adu);
+        f->data[adu]      = 0;
+        f->data[adu + 1U] = 0;
+        f->len = adu + 2;
+        f->tid = (uint16_t)((hdr[0] << 8) | hdr[1]);
+
+        link->stats->rx_frames++;
+        pos += 6U + adu;
+    }
+
+    if (pos > 0)
+    {
+        memmove(st->rx, &st->rx[pos], st->rx_fill - pos);
+        st->rx_fill -= pos;
+    }
+    return n;
+}
+
+const MODBUS_Transport_t MODBUS_TransportTcp =
+{
+    "tcp",
+    0,          /* no CRC on the wire      */
+    1,          /* replies carry the TID   */
+    TCP_Open,
+    TCP_Close,
+    TCP_Send,
+    TCP_Handle,
+    TCP_Recv,
+};
@@ -0,0 +1,81 @@
+#ifndef MODBUS_TRANSPORT_H
+#define MODBUS_TRANSPORT_H
+
+#include <stdint.h>
+#include "modbus_functions.h"
+#include "ini.h"
+
+/*===========================================================
+ * Transport backend used by the transaction engine
+ *
+ * The engine owns queuing, matching and retries; a backend only
+ * moves finished frames between the engine and the wire.
+ *===========================================================*/
+#define MODBUS_RX_BATCH   MODBUS_MAX_INFLIGHT   /* frames per recv call */
+
+typedef struct
+{
+    uint8_t  data[MODBUS_MAX_ADU];  /**< RTU-shaped: unit, PDU, CRC       */
+    int      len;
+    uint16_t tid;                   /**< Request tag echoed by the wire,
+                                         when the transport has one     */
+} MODBUS_Frame_t;
+
+/**
+ * @brief One drive connection: one engine, one backend instance
+ */
+typedef struct
+{
+    const DRIVE_CONFIG *drive;      /**< Endpoint: address, ports, bind   */
+    MODBUS_Stats_t     *stats;      /**< Engine counters; the backend adds
+                                         syscalls, foreign-sender drops
+                                         and (re)connects to them        */
+    void               *state;      /**< Backend private, set by open     */
+} MODBUS_Link_t;
+
+typedef struct
+{
+    const char *name;
+    uint8_t     crc;        /**< Frames carry an RTU CRC to verify     */
+    uint8_t     tid;        /**< Replies echo (uint16_t)txn->tag       */
+
+    /**
+     * @brief  Open the link to link->drive
+     * @return 0 on success, -1 on error
+     */
+    int  (*open)(MODBUS_Link_t *link);
+
+    void (*close)(MODBUS_Link_t *link);
+
+    /**
+     * @brief  Put the request frames of 'count' transactions on the wire
+     * @return Number of frames handed to the OS, or -1 when the link
+     *         cannot carry requests now (TCP connecting or down); the
+     *         engine then fails the whole batch at once
+     */
+    int  (*send)(MODBUS_Link_t *link, MODBUS_Txn_t *const *txns, uint8_t count);
+
+    /**
+     * @brief  Socket the engine waits on for this link; the engine
+     *         waits on the sockets of every open link at once
+     * @param  buffered Set to 1 when replies are already held in user
+     *                  space, so the engine must not wait
+     * @return OS socket handle, or -1 while there is none (TCP down)
+     */
+    intptr_t (*handle)(MODBUS_Link_t *link, int *buffered);
+
+    /**
+     * @brief  Read replies that are already queued, without blocking
+     * @return Number of frames stored (0..max)
+     */
+    int  (*recv)(MODBUS_Link_t *link, MODBUS_Frame_t *frames, int max);
+} MODBUS_Transport_t;
+
+/* RTU frames over UDP: sendto/recvfrom on Windows, sendmmsg/recvmmsg
+ * on a connected socket on Linux */
+extern const MODBUS_Transport_t MODBUS_TransportUdp;
+
+/* Modbus/TCP: one persistent connection, MBAP transaction IDs, no CRC */
+extern const MODBUS_Transport_t MODBUS_TransportTcp;
+
+#endif /* MODBUS_TRANSPORT_H */
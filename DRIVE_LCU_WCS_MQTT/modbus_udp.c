@@ -0,0 +1,356 @@
+#ifndef _WIN32
+#define _GNU_SOURCE             /* sendmmsg / recvmmsg */
+#endif
+
+#include "modbus_transport.h"
+#include "ini.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+/*===========================================================
+ *  Per-link state
+ *===========================================================*/
+#ifndef _WIN32
+#define SOCKET          int
+#define INVALID_SOCKET  (-1)
+#endif
+
+typedef struct
+{
+    SOCKET             sock;
+    struct sockaddr_in target;
+} UDP_State_t;
+
+#define UDP(link)   ((UDP_State_t *)(link)->state)
+
+/* Allocate the link state and fill in the drive address */
+static UDP_State_t *UDP_NewState(MODBUS_Link_t *link)
+{
+    UDP_State_t *st = calloc(1, sizeof(*st));
+    if (!st)
+        return NULL;
+
+    st->sock = INVALID_SOCKET;
+    st->target.sin_family = AF_INET;
+    st->target.sin_port   = htons((uint16_t)link->drive->DRIVE_PORT_UDP);
+    st->target.sin_addr.s_addr = inet_addr(link->drive->DRIVE_IP_ADDR);
+    link->state = st;
+    return st;
+}
+
+static void UDP_FreeState(MODBUS_Link_t *link)
+{
+    free(link->state);
+    link->state = NULL;
+}
+
+static intptr_t UDP_Handle(MODBUS_Link_t *link, int *buffered)
+{
+    *buffered = 0;
+    return (link->state && UDP(link)->sock != INVALID_SOCKET) ?
+           (intptr_t)UDP(link)->sock : -1;
+}
+
+/*===========================================================
+ *  Windows: one sendto / recvfrom per frame
+ *===========================================================*/
+#ifdef _WIN32
+
+static int UDP_Open(MODBUS_Link_t *link)
+{
+    const DRIVE_CONFIG *drv = link->drive;
+    WSADATA wsa;
+
+    if (WSAStartup(MAKEWORD(2,2), &wsa) != 0)
+    {
+        printf("[ERROR] WSAStartup failed\n");
+        return -1;
+    }
+
+    UDP_State_t *st = UDP_NewState(link);
+    if (!st)
+    {
+        WSACleanup();
+        return -1;
+    }
+
+    st->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (st->sock == INVALID_SOCKET)
+    {
+        printf("[ERROR] Failed to create UDP socket! WSAErr=%d\n", WSAGetLastError());
+        UDP_FreeState(link);
+        WSACleanup();
+        return -1;
+    }
+
+    /* non-blocking: the engine waits in select() against a deadline */
+    u_long nonblocking = 1;
+    if (ioctlsocket(st->sock, FIONBIO, &nonblocking) != 0)
+    {
+        printf("[WARN] ioctlsocket FIONBIO failed (WSAErr=%d)\n", WSAGetLastError());
+    }
+
+    /* Bind LOCAL PC IP + PORT */
+    struct sockaddr_in local = {0};
+    local.sin_family = AF_INET;
+    local.sin_port   = htons((uint16_t)drv->LOCAL_BIND_PORT);
+    local.sin_addr.s_addr = inet_addr(drv->LOCAL_BIND_IP);
+
+    if (bind(st->sock, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        printf("[ERROR] Failed local bind! %s:%u (WSAErr=%d)\n",
+               drv->LOCAL_BIND_IP, drv->LOCAL_BIND_PORT, WSAGetLastError());
+        closesocket(st->sock);
+        UDP_FreeState(link);
+        WSACleanup();
+        return -1;
+    }
+    printf("[OK] %s: bound to local %s:%u\n",
+           drv->NAME, drv->LOCAL_BIND_IP, drv->LOCAL_BIND_PORT);
+
+    printf("[OK] %s: target drive set -> %s:%u\n",
+           drv->NAME, drv->DRIVE_IP_ADDR, drv->DRIVE_PORT_UDP);
+    link->stats->connects++;
+    return 0;
+}
+
+static void UDP_Close(MODBUS_Link_t *link)
+{
+    if (link->state)
+    {
+        if (UDP(link)->sock != INVALID_SOCKET)
+            closesocket(UDP(link)->sock);
+        UDP_FreeState(link);
+        WSACleanup();
+    }
+}
+
+static int UDP_Send(MODBUS_Link_t *link, MODBUS_Txn_t *const *txns, uint8_t count)
+{
+    UDP_State_t *st = UDP(link);
+    int done = 0;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        const MODBUS_Txn_t *txn = txns[i];
+        int sent = sendto(st->sock, (const char*)txn->tx, txn->tx_len, 0,
+                          (struct sockaddr*)&st->target, sizeof(st->target));
+        link->stats->syscalls++;
+        if (sent != txn->tx_len)
+        {
+            printf("[WARN] sendto sent=%d expected=%d (WSAErr=%d)\n", sent, txn->tx_len, WSAGetLastError());
+            continue;
+        }
+        done++;
+    }
+    return done;
+}
+
+static int UDP_Recv(MODBUS_Link_t *link, MODBUS_Frame_t *frames, int max)
+{
+    UDP_State_t *st = UDP(link);
+    int n = 0;
+
+    while (n < max)
+    {
+        struct sockaddr_in from;
+        int from_len = sizeof(from);
+        int res = recvfrom(st->sock, (char*)frames[n].data, sizeof(frames[n].data), 0,
+                           (struct sockaddr*)&from, &from_len);
+        link->stats->syscalls++;
+        if (res <= 0)
+        {
+            int err = WSAGetLastError();
+            if (res < 0 && err != WSAEWOULDBLOCK && err != WSAETIMEDOUT)
+            {
+                printf("[WARN] recvfrom failed (WSAErr=%d)\n", err);
+            }
+            break;
+        }
+        link->stats->rx_frames++;
+
+        /* the socket is not connected: filter other senders here */
+        if (from.sin_addr.s_addr != st->target.sin_addr.s_addr ||
+            from.sin_port != st->target.sin_port)
+        {
+            link->stats->foreign++;
+            continue;
+        }
+
+        frames[n++].len = res;
+    }
+    return n;
+}
+
+/*===========================================================
+ *  Linux: connected socket, one sendmmsg per window fill and
+ *  one recvmmsg per wake-up
+ *===========================================================*/
+#else
+
+static int UDP_Open(MODBUS_Link_t *link)
+{
+    const DRIVE_CONFIG *drv = link->drive;
+    UDP_State_t *st = UDP_NewState(link);
+    if (!st)
+        return -1;
+
+    st->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (st->sock < 0)
+    {
+        printf("[ERROR] Failed to create UDP socket! errno=%d\n", errno);
+        UDP_FreeState(link);
+        return -1;
+    }
+
+    /* non-blocking: the engine waits in ppoll() against a deadline */
+    int flags = fcntl(st->sock, F_GETFL, 0);
+    if (flags < 0 || fcntl(st->sock, F_SETFL, flags | O_NONBLOCK) != 0)
+    {
+        printf("[WARN] fcntl O_NONBLOCK failed (errno=%d)\n", errno);
+    }
+
+    /* Bind LOCAL PC IP + PORT */
+    struct sockaddr_in local = {0};
+    local.sin_family = AF_INET;
+    local.sin_port   = htons((uint16_t)drv->LOCAL_BIND_PORT);
+    local.sin_addr.s_addr = inet_addr(drv->LOCAL_BIND_IP);
+
+    if (bind(st->sock, (struct sockaddr*)&local, sizeof(local)) != 0)
+    {
+        printf("[ERROR] Failed local bind! %s:%u (errno=%d)\n",
+               drv->LOCAL_BIND_IP, drv->LOCAL_BIND_PORT, errno);
+        close(st->sock);
+        UDP_FreeState(link);
+        return -1;
+    }
+    printf("[OK] %s: bound to local %s:%u\n",
+           drv->NAME, drv->LOCAL_BIND_IP, drv->LOCAL_BIND_PORT);
+
+    /* DRIVE IP + PORT: connecting makes the kernel drop other senders */
+    if (connect(st->sock, (struct sockaddr*)&st->target, sizeof(st->target)) != 0)
+    {
+        printf("[ERROR] Failed to connect UDP socket to %s:%u (errno=%d)\n",
+               drv->DRIVE_IP_ADDR, drv->DRIVE_PORT_UDP, errno);
+        close(st->sock);
+        UDP_FreeState(link);
+        return -1;
+    }
+
+    printf("[OK] %s: target drive set -> %s:%u\n",
+           drv->NAME, drv->DRIVE_IP_ADDR, drv->DRIVE_PORT_UDP);
+    link->stats->connects++;
+    return 0;
+}
+
+static void UDP_Close(MODBUS_Link_t *link)
+{
+    if (link->state)
+    {
+        if (UDP(link)->sock >= 0)
+            close(UDP(link)->sock);
+        UDP_FreeState(link);
+    }
+}
+
+static int UDP_Send(MODBUS_Link_t *link, MODBUS_Txn_t *const *txns, uint8_t count)
+{
+    struct mmsghdr msgs[MODBUS_MAX_INFLIGHT];
+    struct iovec   iov[MODBUS_MAX_INFLIGHT];
+    int done = 0;
+
+    if (count > MODBUS_MAX_INFLIGHT)
+        count = MODBUS_MAX_INFLIGHT;
+
+    memset(msgs, 0, sizeof(msgs[0]) * count);
+    for (uint8_t i = 0; i < count; i++)
+    {
+        iov[i].iov_base = txns[i]->tx;
+        iov[i].iov_len  = txns[i]->tx_len;
+        msgs[i].msg_hdr.msg_iov    = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    while (done < count)
+    {
+        int res = sendmmsg(UDP(link)->sock, &msgs[done], (unsigned int)(count - done), 0);
+        link->stats->syscalls++;
+        if (res <= 0)
+        {
+            if (res < 0 && errno == EINTR)
+                continue;
+            printf("[WARN] sendmmsg sent=%d of %u (errno=%d)\n", done, count, errno);
+            break;
+        }
+        done += res;
+    }
+    return done;
+}
+
+static int UDP_Recv(MODBUS_Link_t *link, MODBUS_Frame_t *frames, int max)
+{
+    struct mmsghdr msgs[MODBUS_RX_BATCH];
+    struct iovec   iov[MODBUS_RX_BATCH];
+
+    if (max > (int)MODBUS_RX_BATCH)
+        max = (int)MODBUS_RX_BATCH;
+
+    memset(msgs, 0, sizeof(msgs[0]) * (size_t)max);
+    for (int i = 0; i < max; i++)
+    {
+        iov[i].iov_base = frames[i].data;
+        iov[i].iov_len  = sizeof(frames[i].data);
+        msgs[i].msg_hdr.msg_iov    = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    int res = recvmmsg(UDP(link)->sock, msgs, (unsigned int)max, MSG_DONTWAIT, NULL);
+    link->stats->syscalls++;
+    if (res < 0)
+    {
+        /* ECONNREFUSED: ICMP port unreachable from an earlier send */
+        if (errno != EAGAIN && errno != EWOULDBLOCK &&
+            errno != EINTR && errno != ECONNREFUSED)
+        {
+            printf("[WARN] recvmmsg failed (errno=%d)\n", errno);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < res; i++)
+    {
+        /* oversize datagram: hand over an impossible length so the
+         * frame check drops it */
+        frames[i].len = (msgs[i].msg_hdr.msg_flags & MSG_TRUNC) ?
+                        (int)MODBUS_MAX_ADU + 1 : (int)msgs[i].msg_len;
+    }
+    link->stats->rx_frames += (uint32_t)res;
+    return res;
+}
+
+#endif /* _WIN32 */
+
+const MODBUS_Transport_t MODBUS_TransportUdp =
+{
+    "udp",
+    1,          /* RTU CRC on the wire          */
+    0,          /* replies matched by shape     */
+    UDP_Open,
+    UDP_Close,
+    UDP_Send,
+    UDP_Handle,
+    UDP_Recv,
+};
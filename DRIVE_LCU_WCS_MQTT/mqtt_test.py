@@ -1,4 +1,8 @@
 import configparser
+import json
+import os
+import re
+import struct
 import time
 import sys
 import paho.mqtt.client as mqtt
@@ -15,6 +19,209 @@ MQTT_CLIENT_ID   = "WCS_TEST_CLIENT"
 
 TOPIC_HEARTBEAT  = cfg.get("MQTT", "MQTT_TOPIC_HEARTBEAT")
 TOPIC_TELEMETRY  = cfg.get("MQTT", "MQTT_TOPIC_TELEMETRY")
+TOPIC_TELEMETRY_CBOR = cfg.get("MQTT", "MQTT_TOPIC_TELEMETRY_CBOR",
+                               fallback="server/telemetry/cbor")
+
+# -------------------------------------------------------
+# CBOR telemetry ([TELEMETRY] ENCODING = CBOR / BOTH)
+# Python copy of the key map in telemetry_bin.h. The names are
+# the JSON telemetry keys: meta and fault names from
+# telemetry_bin.c, signal names from signal_codec.c, in enum
+# order. check_key_map() compares them with those files.
+# -------------------------------------------------------
+TLM_VERSION = 1
+
+TLM_KEY = {
+    "VERSION":   0,
+    "KIND":      1,
+    "DRIVE":     2,
+    "AXIS":      3,
+    "SEQ":       4,
+    "KEYFRAME":  5,
+    "CHANGED":   6,
+    "CONNECTED": 7,
+    "FAULTS":    8,
+    "T0":        9,
+    "DT":        10,
+    "META":      16,
+    "SIGNAL":    32,
+}
+
+TLM_KINDS = ["once", "periodic", "continuous", "batch"]
+
+TLM_META_NAMES = [
+    "modbus_cycles", "syscalls_per_cycle", "frames_per_cycle",
+    "srtt_us", "rttvar_us", "rto_us", "retries", "recovered",
+    "timeouts", "shadow_hits", "shadow_misses", "batch_drops",
+    "json_drops",
+]
+
+TLM_FAULT_NAMES = [
+    "short_circuit", "system_ok", "rated_current", "over_temp",
+    "over_volt", "under_volt", "motion_error", "drive_disable",
+    "eeprom_error", "commutation_err", "lock_rotor", "emergency_err",
+    "command_error", "motion_complete",
+]
+
+TLM_SIGNAL_NAMES = [
+    "actual_pos_mm", "pos_deg", "pos_mm", "rpm", "motor_current",
+    "io_status", "system_status", "dc_bus", "fault_raw", "version",
+    "revision", "release",
+]
+
+
+def cbor_item(buf, pos):
+    """Decode the CBOR item at buf[pos]; returns (value, next pos)"""
+    if pos >= len(buf):
+        raise ValueError("truncated CBOR")
+    major, info = buf[pos] >> 5, buf[pos] & 0x1F
+    pos += 1
+
+    if major == 7:
+        if info in (20, 21):
+            return info == 21, pos
+        if info in (22, 23):
+            return None, pos
+        fmt = {25: ">e", 26: ">f", 27: ">d"}.get(info)
+        if fmt is None:
+            raise ValueError("unsupported CBOR simple value %d" % info)
+        end = pos + struct.calcsize(fmt)
+        if end > len(buf):
+            raise ValueError("truncated CBOR")
+        value = struct.unpack(fmt, buf[pos:end])[0]
+        # the LCU sends 0.01-step values as float32: drop the float noise
+        return (float("%.7g" % value) if info == 26 else value), end
+
+    if info < 24:
+        arg = info
+    elif info <= 27:
+        end = pos + (1 << (info - 24))
+        if end > len(buf):
+            raise ValueError("truncated CBOR")
+        arg, pos = int.from_bytes(buf[pos:end], "big"), end
+    else:
+        raise ValueError("indefinite-length CBOR is not used by the LCU")
+
+    if major == 0:
+        return arg, pos
+    if major == 1:
+        return -1 - arg, pos
+    if major in (2, 3):
+        if pos + arg > len(buf):
+            raise ValueError("truncated CBOR")
+        raw = bytes(buf[pos:pos + arg])
+        return (raw if major == 2 else raw.decode("utf-8")), pos + arg
+    if major == 4:
+        items = []
+        for _ in range(arg):
+            item, pos = cbor_item(buf, pos)
+            items.append(item)
+        return items, pos
+    if major == 5:
+        pairs = {}
+        for _ in range(arg):
+            key, pos = cbor_item(buf, pos)
+            pairs[key], pos = cbor_item(buf, pos)
+        return pairs, pos
+    return cbor_item(buf, pos)      # tag: the tagged item
+
+
+def decode_cbor_telemetry(payload):
+    """One CBOR telemetry message as a dict with the JSON names;
+    keys this side does not know are skipped, as TLM_Decode does"""
+    msg, end = cbor_item(payload, 0)
+    if not isinstance(msg, dict) or end != len(payload):
+        raise ValueError("not a CBOR telemetry map")
+
+    kind = msg.get(TLM_KEY["KIND"])
+    out = {
+        "v":     msg.get(TLM_KEY["VERSION"]),
+        "kind":  TLM_KINDS[kind] if kind in range(len(TLM_KINDS)) else kind,
+        "drive": msg.get(TLM_KEY["DRIVE"]),
+        "axis":  msg.get(TLM_KEY["AXIS"]),
+    }
+    if out["v"] != TLM_VERSION:
+        print("[WCS] CBOR telemetry version %s, decoder knows %d" % (out["v"], TLM_VERSION))
+
+    if TLM_KEY["SEQ"] in msg:
+        out["seq"] = msg[TLM_KEY["SEQ"]]
+    if TLM_KEY["KEYFRAME"] in msg:
+        out["keyframe"] = msg[TLM_KEY["KEYFRAME"]]
+    if TLM_KEY["CHANGED"] in msg:
+        bits = msg[TLM_KEY["CHANGED"]]
+        out["changed"] = [n for i, n in enumerate(TLM_SIGNAL_NAMES) if bits >> i & 1]
+    if TLM_KEY["CONNECTED"] in msg:
+        out["drive_connected"] = msg[TLM_KEY["CONNECTED"]]
+    if TLM_KEY["FAULTS"] in msg:
+        bits = msg[TLM_KEY["FAULTS"]]
+        out["fault_bits"] = {n: bool(bits >> i & 1) for i, n in enumerate(TLM_FAULT_NAMES)}
+    if TLM_KEY["T0"] in msg:
+        out["t0_us"] = msg[TLM_KEY["T0"]]
+    if TLM_KEY["DT"] in msg:
+        out["dt_us"] = msg[TLM_KEY["DT"]]
+
+    meta, values = {}, {}
+    for key, value in msg.items():
+        if not isinstance(key, int):
+            continue
+        if key >= TLM_KEY["SIGNAL"]:
+            if key - TLM_KEY["SIGNAL"] < len(TLM_SIGNAL_NAMES):
+                values[TLM_SIGNAL_NAMES[key - TLM_KEY["SIGNAL"]]] = value
+        elif key >= TLM_KEY["META"]:
+            if key - TLM_KEY["META"] < len(TLM_META_NAMES):
+                meta[TLM_META_NAMES[key - TLM_KEY["META"]]] = value
+    out["values"] = values
+    if meta:
+        out["meta"] = meta
+    return out
+
+
+def check_key_map(src_dir):
+    """Compare the tables above with the LCU sources in 'src_dir',
+    if they are there; returns the differences found"""
+    def read(name):
+        with open(os.path.join(src_dir, name), encoding="utf-8") as f:
+            return re.sub(r"/\*.*?\*/", "", f.read(), flags=re.S)
+
+    def enum(text, first):
+        body = re.search(r"typedef enum\s*\{([^}]*\b%s\b[^}]*)\}" % first, text).group(1)
+        members, value = {}, 0
+        for item in filter(None, (i.strip() for i in body.split(","))):
+            name, _, init = item.partition("=")
+            value = int(init, 0) if init.strip() else value
+            members[name.strip()] = value
+            value += 1
+        return members
+
+    def names(members, table, prefix):
+        order = sorted((v, k) for k, v in members.items() if not k.endswith("_COUNT"))
+        by_enum = dict(re.findall(r"\[(%s\w+)\]\s*=\s*\{?\s*\"([^\"]*)\"" % prefix, table))
+        return [by_enum.get(k) for _, k in order]
+
+    try:
+        bin_h, bin_c = read("telemetry_bin.h"), read("telemetry_bin.c")
+        sig_h, sig_c = read("read_planner.h"), read("signal_codec.c")
+    except OSError:
+        return []
+
+    found = []
+    version = int(re.search(r"#define\s+TLM_VERSION\s+(\d+)", bin_h).group(1))
+    if version != TLM_VERSION:
+        found.append("TLM_VERSION %d, here %d" % (version, TLM_VERSION))
+    keys = {k[len("TLM_KEY_"):]: v for k, v in enum(bin_h, "TLM_KEY_VERSION").items()}
+    if keys != TLM_KEY:
+        found.append("TLM_KEY_*")
+    kinds = [k[len("TLM_KIND_"):].lower()
+             for _, k in sorted((v, k) for k, v in enum(bin_h, "TLM_KIND_ONCE").items())]
+    if kinds != TLM_KINDS:
+        found.append("TLM_KIND_*")
+    if names(enum(bin_h, "TLM_META_CYCLES"), bin_c, "TLM_META_") != TLM_META_NAMES:
+        found.append("TLM_META_* names")
+    if names(enum(bin_h, "TLM_FAULT_SHORT_CIRCUIT"), bin_c, "TLM_FAULT_") != TLM_FAULT_NAMES:
+        found.append("TLM_FAULT_* names")
+    if names(enum(sig_h, "SIG_ABS_POSITION"), sig_c, "SIG_") != TLM_SIGNAL_NAMES:
+        found.append("Signal_t names")
+    return found
 
 # -------------------------------------------------------
 # MQTT Callbacks
@@ -24,10 +231,12 @@ def on_connect(client, userdata, flags, reason_code, properties):
         print("[WCS] Connected to MQTT broker")
         client.subscribe(TOPIC_HEARTBEAT, qos=1)
         client.subscribe(TOPIC_TELEMETRY, qos=1)
+        client.subscribe(TOPIC_TELEMETRY_CBOR, qos=1)
         client.subscribe("lcu/ack", qos=1)
         print("[WCS] Subscribed to:")
         print(f"      {TOPIC_HEARTBEAT}")
         print(f"      {TOPIC_TELEMETRY}")
+        print(f"      {TOPIC_TELEMETRY_CBOR}")
     else:
         print("[WCS] Connection failed, reason:", reason_code)
 
@@ -38,6 +247,12 @@ def on_message(client, userdata, msg):
     print("\n[WCS] Message received")
     print(" Topic   :", msg.topic)
     print(" QoS     :", msg.qos)
+    if msg.topic == TOPIC_TELEMETRY_CBOR:
+        try:
+            print(" Payload :", json.dumps(decode_cbor_telemetry(msg.payload)))
+        except ValueError as e:
+            print(" Payload : <bad CBOR:", e, ">")
+        return
     try:
         print(" Payload :", msg.payload.decode())
     except Exception:
@@ -46,6 +261,9 @@ def on_message(client, userdata, msg):
 # -------------------------------------------------------
 # MQTT Client Setup
 # -------------------------------------------------------
+for diff in check_key_map(os.path.dirname(os.path.abspath(__file__))):
+    print("[WCS] WARNING: CBOR key map differs from the LCU sources:", diff)
+
 #client = mqtt.Client(client_id=MQTT_CLIENT_ID, clean_session=True)
 client = mqtt.Client(
     client_id=MQTT_CLIENT_ID,
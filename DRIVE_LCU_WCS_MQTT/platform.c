@@ -0,0 +1,328 @@
+#ifndef _WIN32
+#define _GNU_SOURCE             /* ppoll */
+#endif
+
+#include "platform.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <windows.h>
+#else
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <poll.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#endif
+
+/*----------------------------------------------------------
+ * Monotonic clock
+ *----------------------------------------------------------*/
+uint64_t PLAT_TimeUs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((now.QuadPart / freq.QuadPart) * 1000000ULL +
+                      ((now.QuadPart % freq.QuadPart) * 1000000ULL) / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+#endif
+}
+
+uint32_t PLAT_TimeMs(void)
+{
+    return (uint32_t)(PLAT_TimeUs() / 1000ULL);
+}
+
+/*----------------------------------------------------------
+ * Sleep
+ *----------------------------------------------------------*/
+void PLAT_SleepMs(uint32_t ms)
+{
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    usleep((useconds_t)ms * 1000U);
+#endif
+}
+
+void PLAT_SleepUntilUs(uint64_t deadline_us)
+{
+#ifdef _WIN32
+    uint64_t now_us = PLAT_TimeUs();
+    if (deadline_us > now_us)
+        Sleep((DWORD)((deadline_us - now_us + 999ULL) / 1000ULL));
+#else
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(deadline_us / 1000000ULL);
+    ts.tv_nsec = (long)(deadline_us % 1000000ULL) * 1000L;
+
+    /* absolute: a late wake-up does not push the next one back */
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+#endif
+}
+
+/*----------------------------------------------------------
+ * Socket readiness
+ *----------------------------------------------------------*/
+int PLAT_WaitReadable(const intptr_t *socks, uint8_t *ready, int count,
+                      uint64_t wait_us)
+{
+    if (count > PLAT_MAX_WAIT)
+        count = PLAT_MAX_WAIT;
+    for (int i = 0; i < count; i++)
+        ready[i] = 0;
+
+#ifdef _WIN32
+    if (count <= 0)
+    {
+        /* select() refuses an empty set */
+        Sleep((DWORD)((wait_us + 999ULL) / 1000ULL));
+        return 0;
+    }
+
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    for (int i = 0; i < count; i++)
+        FD_SET((SOCKET)socks[i], &rfds);
+
+    struct timeval tv;
+    tv.tv_sec  = (long)(wait_us / 1000000ULL);
+    tv.tv_usec = (long)(wait_us % 1000000ULL);
+
+    int n = select(0, &rfds, NULL, NULL, &tv);
+    if (n <= 0)
+        return n;
+    for (int i = 0; i < count; i++)
+        ready[i] = (uint8_t)(FD_ISSET((SOCKET)socks[i], &rfds) != 0);
+    return n;
+#else
+    struct pollfd pfd[PLAT_MAX_WAIT];
+    for (int i = 0; i < count; i++)
+    {
+        pfd[i].fd      = (int)socks[i];
+        pfd[i].events  = POLLIN;
+        pfd[i].revents = 0;
+    }
+
+    struct timespec ts;
+    ts.tv_sec  = (time_t)(wait_us / 1000000ULL);
+    ts.tv_nsec = (long)(wait_us % 1000000ULL) * 1000L;
+
+    int n = ppoll(pfd, (nfds_t)((count > 0) ? count : 0), &ts, NULL);
+    if (n < 0)
+        return (errno == EINTR) ? 0 : -1;
+
+    n = 0;
+    for (int i = 0; i < count; i++)
+    {
+        /* errors and hang-ups count as readable: recv reports them */
+        ready[i] = (uint8_t)(pfd[i].revents != 0);
+        n += ready[i];
+    }
+    return n;
+#endif
+}
+
+/*----------------------------------------------------------
+ * Wake-up socket
+ *----------------------------------------------------------*/
+#ifdef _WIN32
+typedef SOCKET plat_sock_t;
+#define PLAT_BAD_SOCK       INVALID_SOCKET
+#define plat_closesocket    closesocket
+#else
+typedef int plat_sock_t;
+#define PLAT_BAD_SOCK       (-1)
+#define plat_closesocket    close
+#endif
+
+struct PLAT_Waker
+{
+    plat_sock_t sock;       /* bound to 127.0.0.1 and connected to itself */
+};
+
+PLAT_Waker_t *PLAT_WakerCreate(void)
+{
+    PLAT_Waker_t *w = malloc(sizeof(*w));
+    if (!w)
+        return NULL;
+
+    w->sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (w->sock == PLAT_BAD_SOCK)
+    {
+        free(w);
+        return NULL;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family      = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port        = 0;
+
+#ifdef _WIN32
+    int len = sizeof(addr);
+    u_long nonblocking = 1;
+    int nb = ioctlsocket(w->sock, FIONBIO, &nonblocking);
+#else
+    socklen_t len = sizeof(addr);
+    int flags = fcntl(w->sock, F_GETFL, 0);
+    int nb = (flags < 0) ? -1 : fcntl(w->sock, F_SETFL, flags | O_NONBLOCK);
+#endif
+
+    /* the kernel picks the port; connecting to it makes send() loop back */
+    if (nb != 0 ||
+        bind(w->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        getsockname(w->sock, (struct sockaddr *)&addr, &len) != 0 ||
+        connect(w->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0)
+    {
+        plat_closesocket(w->sock);
+        free(w);
+        return NULL;
+    }
+    return w;
+}
+
+void PLAT_WakerDestroy(PLAT_Waker_t *w)
+{
+    if (!w)
+        return;
+    plat_closesocket(w->sock);
+    free(w);
+}
+
+intptr_t PLAT_WakerHandle(const PLAT_Waker_t *w)
+{
+    return (intptr_t)w->sock;
+}
+
+void PLAT_WakerSignal(PLAT_Waker_t *w)
+{
+    /* a full buffer already means "readable": dropping is fine */
+    char b = 0;
+    (void)send(w->sock, &b, 1, 0);
+}
+
+void PLAT_WakerDrain(PLAT_Waker_t *w)
+{
+    char buf[64];
+    while (recv(w->sock, buf, sizeof(buf), 0) > 0)
+        ;
+}
+
+/*----------------------------------------------------------
+ * Threads
+ *----------------------------------------------------------*/
+typedef struct
+{
+    PLAT_ThreadFn_t fn;
+    void           *arg;
+} PLAT_ThreadStart_t;
+
+#ifdef _WIN32
+static DWORD WINAPI PLAT_ThreadEntry(LPVOID param)
+#else
+static void *PLAT_ThreadEntry(void *param)
+#endif
+{
+    PLAT_ThreadStart_t start = *(PLAT_ThreadStart_t *)param;
+    free(param);
+    start.fn(start.arg);
+    return 0;
+}
+
+int PLAT_ThreadStart(PLAT_ThreadFn_t fn, void *arg)
+{
+    PLAT_ThreadStart_t *start = malloc(sizeof(*start));
+    if (!fn || !start)
+    {
+        free(start);
+        return -1;
+    }
+    start->fn  = fn;
+    start->arg = arg;
+
+#ifdef _WIN32
+    HANDLE h = CreateThread(NULL, 0, PLAT_ThreadEntry, start, 0, NULL);
+    if (h == NULL)
+    {
+        free(start);
+        return -1;
+    }
+    CloseHandle(h);
+#else
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, PLAT_ThreadEntry, start) != 0)
+    {
+        free(start);
+        return -1;
+    }
+    pthread_detach(tid);
+#endif
+    return 0;
+}
+
+/*----------------------------------------------------------
+ * Mutex
+ *----------------------------------------------------------*/
+struct PLAT_Mutex
+{
+#ifdef _WIN32
+    CRITICAL_SECTION cs;
+#else
+    pthread_mutex_t  mtx;
+#endif
+};
+
+PLAT_Mutex_t *PLAT_MutexCreate(void)
+{
+    PLAT_Mutex_t *m = malloc(sizeof(*m));
+    if (!m)
+        return NULL;
+
+#ifdef _WIN32
+    InitializeCriticalSection(&m->cs);
+#else
+    if (pthread_mutex_init(&m->mtx, NULL) != 0)
+    {
+        free(m);
+        return NULL;
+    }
+#endif
+    return m;
+}
+
+void PLAT_MutexLock(PLAT_Mutex_t *m)
+{
+#ifdef _WIN32
+    EnterCriticalSection(&m->cs);
+#else
+    pthread_mutex_lock(&m->mtx);
+#endif
+}
+
+void PLAT_MutexUnlock(PLAT_Mutex_t *m)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(&m->cs);
+#else
+    pthread_mutex_unlock(&m->mtx);
+#endif
+}
@@ -0,0 +1,94 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <stdint.h>
+
+/*===========================================================
+ * Small OS abstraction shared by the LCU modules
+ *===========================================================*/
+
+/**
+ * @brief Monotonic time in microseconds (arbitrary epoch)
+ */
+uint64_t PLAT_TimeUs(void);
+
+/**
+ * @brief Monotonic time in milliseconds (arbitrary epoch)
+ */
+uint32_t PLAT_TimeMs(void);
+
+/**
+ * @brief Sleep the calling thread
+ */
+void PLAT_SleepMs(uint32_t ms);
+
+/**
+ * @brief Sleep until PLAT_TimeUs() reaches 'deadline_us'; returns
+ *        at once if it already has
+ */
+void PLAT_SleepUntilUs(uint64_t deadline_us);
+
+/**
+ * @brief Wait until one of 'count' sockets is readable or 'wait_us'
+ *        passes; with no sockets this is a plain sleep
+ * @param socks OS socket handles (SOCKET on Windows, fd elsewhere)
+ * @param ready Set to 1 for each readable socket, else 0
+ * @return Number of readable sockets, 0 on timeout, -1 on error
+ */
+#define PLAT_MAX_WAIT  16
+int PLAT_WaitReadable(const intptr_t *socks, uint8_t *ready, int count,
+                      uint64_t wait_us);
+
+/**
+ * @brief Wake-up socket: lets another thread end a PLAT_WaitReadable
+ *        early. A loopback UDP socket that sends to itself, so the
+ *        same handle works with poll() and with select() on Windows
+ *        (create it after WSAStartup).
+ */
+typedef struct PLAT_Waker PLAT_Waker_t;
+
+/**
+ * @return New waker, or NULL on error
+ */
+PLAT_Waker_t *PLAT_WakerCreate(void);
+void PLAT_WakerDestroy(PLAT_Waker_t *w);
+
+/**
+ * @brief Socket handle to pass to PLAT_WaitReadable
+ */
+intptr_t PLAT_WakerHandle(const PLAT_Waker_t *w);
+
+/**
+ * @brief Make the handle readable; safe from any thread
+ */
+void PLAT_WakerSignal(PLAT_Waker_t *w);
+
+/**
+ * @brief Consume pending signals once the handle was readable
+ */
+void PLAT_WakerDrain(PLAT_Waker_t *w);
+
+/**
+ * @brief Thread entry point
+ */
+typedef void (*PLAT_ThreadFn_t)(void *arg);
+
+/**
+ * @brief Start a detached background thread
+ * @return 0 on success, -1 on error
+ */
+int PLAT_ThreadStart(PLAT_ThreadFn_t fn, void *arg);
+
+/**
+ * @brief Non-recursive mutex
+ */
+typedef struct PLAT_Mutex PLAT_Mutex_t;
+
+/**
+ * @return New unlocked mutex, or NULL on error
+ */
+PLAT_Mutex_t *PLAT_MutexCreate(void);
+void PLAT_MutexLock(PLAT_Mutex_t *m);
+void PLAT_MutexUnlock(PLAT_Mutex_t *m);
+
+#endif /* PLATFORM_H */
@@ -0,0 +1,101 @@
+#include "read_planner.h"
+#include "signal_codec.h"
+#include "axis_helper.h"
+#include "ini.h"
+#include <stddef.h>
+#include <string.h>
+
+int PLAN_SignalAddr(Axis_t axis, Signal_t sig, uint8_t *func, uint16_t *addr)
+{
+    AXIS_CONFIG *cfg = GetAxisCfg(axis);
+    const CODEC_Desc_t *d = CODEC_Describe(sig);
+    if (!cfg || !d)
+        return -1;
+
+    const int *field = (const int *)((const char *)cfg + d->addr_field);
+    *func = d->func;
+    *addr = (uint16_t)(*field);
+    return 0;
+}
+
+uint16_t PLAN_SignalRegs(Signal_t sig)
+{
+    const CODEC_Desc_t *d = CODEC_Describe(sig);
+    return d ? d->regs : 0U;
+}
+
+/*----------------------------------------------------------
+ * Build: sort the wanted spans by (func, addr) and merge any
+ * span that starts within PLAN_MAX_GAP of the current block,
+ * as long as the block stays within PLAN_MAX_REGS.
+ *----------------------------------------------------------*/
+int PLAN_Build(ReadPlan_t *plan, Axis_t axis, uint32_t signals)
+{
+    ReadBlock_t spans[SIG_COUNT];
+    uint8_t     sigs[SIG_COUNT];
+    uint8_t n = 0;
+
+    if (!plan || !GetAxisCfg(axis))
+        return -1;
+
+    memset(plan, 0, sizeof(*plan));
+    plan->axis    = axis;
+    plan->signals = signals;
+
+    for (int s = 0; s < SIG_COUNT; s++)
+    {
+        if (!(signals & SIG_MASK(s)))
+            continue;
+
+        ReadBlock_t span;
+        if (PLAN_SignalAddr(axis, (Signal_t)s, &span.func, &span.start) != 0)
+            return -1;
+        span.count = PLAN_SignalRegs((Signal_t)s);
+
+        /* insertion sort, n <= SIG_COUNT */
+        uint8_t i = n;
+        while (i > 0 &&
+               (spans[i - 1].func > span.func ||
+                (spans[i - 1].func == span.func && spans[i - 1].start > span.start)))
+        {
+            spans[i] = spans[i - 1];
+            sigs[i]  = sigs[i - 1];
+            i--;
+        }
+        spans[i] = span;
+        sigs[i]  = (uint8_t)s;
+        n++;
+    }
+
+    if (n == 0)
+        return -1;
+
+    uint16_t max_gap = (modbus_cfg.PLAN_MAX_GAP > 0) ? (uint16_t)modbus_cfg.PLAN_MAX_GAP : 0U;
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        ReadBlock_t *cur = (plan->block_count > 0) ? &plan->blocks[plan->block_count - 1] : NULL;
+
+        if (cur && cur->func == spans[i].func)
+        {
+            uint32_t cur_end  = (uint32_t)cur->start + cur->count;      /* exclusive */
+            uint32_t span_end = (uint32_t)spans[i].start + spans[i].count;
+            uint32_t new_end  = (span_end > cur_end) ? span_end : cur_end;
+
+            if ((uint32_t)spans[i].start <= cur_end + max_gap &&
+                new_end - cur->start <= PLAN_MAX_REGS)
+            {
+                cur->count = (uint16_t)(new_end - cur->start);
+                plan->sig_block[sigs[i]]  = (uint8_t)(plan->block_count - 1U);
+                plan->sig_offset[sigs[i]] = (uint16_t)(spans[i].start - cur->start);
+                continue;
+            }
+        }
+
+        plan->sig_block[sigs[i]]  = plan->block_count;
+        plan->sig_offset[sigs[i]] = 0U;
+        plan->blocks[plan->block_count++] = spans[i];
+    }
+
+    return 0;
+}
@@ -0,0 +1,83 @@
+#ifndef READ_PLANNER_H
+#define READ_PLANNER_H
+
+#include <stdint.h>
+#include "axis_helper.h"
+
+/*===========================================================
+ * Feedback signals the planner knows how to fetch
+ *===========================================================*/
+typedef enum
+{
+    SIG_ABS_POSITION = 0,
+    SIG_POS_DEG,
+    SIG_POS_MM,
+    SIG_RPM,
+    SIG_CURRENT,
+    SIG_IO_STATUS,
+    SIG_SYSTEM_STATUS,
+    SIG_DCBUS_VOLT,
+    SIG_FAULT_STATUS,
+    SIG_VERSION,
+    SIG_REVISION,
+    SIG_RELEASE_DATE,
+    SIG_COUNT
+} Signal_t;
+
+#define SIG_MASK(sig)   (1UL << (sig))
+
+/* Signal sets used by the telemetry classes */
+#define SIGSET_CONTINUOUS  (SIG_MASK(SIG_ABS_POSITION) | SIG_MASK(SIG_POS_DEG) | \
+                            SIG_MASK(SIG_POS_MM) | SIG_MASK(SIG_RPM) |          \
+                            SIG_MASK(SIG_IO_STATUS))
+#define SIGSET_PERIODIC    (SIG_MASK(SIG_CURRENT) | SIG_MASK(SIG_DCBUS_VOLT) |  \
+                            SIG_MASK(SIG_FAULT_STATUS))
+#define SIGSET_ONCE        (SIG_MASK(SIG_VERSION) | SIG_MASK(SIG_REVISION) |    \
+                            SIG_MASK(SIG_RELEASE_DATE))
+
+#define PLAN_MAX_REGS      125U   /* Modbus limit for one 0x03/0x04 read */
+#define PLAN_MAX_BLOCKS    SIG_COUNT
+
+/**
+ * @brief One contiguous register read
+ */
+typedef struct
+{
+    uint8_t  func;          /**< 0x03 holding or 0x04 input */
+    uint16_t start;
+    uint16_t count;
+} ReadBlock_t;
+
+/**
+ * @brief Coalesced read plan for one axis and one signal set
+ */
+typedef struct
+{
+    Axis_t      axis;
+    uint32_t    signals;     /**< SIG_MASK() set the plan covers */
+    uint8_t     block_count;
+    ReadBlock_t blocks[PLAN_MAX_BLOCKS];
+    uint8_t     sig_block[SIG_COUNT];   /**< Block holding each signal    */
+    uint16_t    sig_offset[SIG_COUNT];  /**< Its first register in the block */
+} ReadPlan_t;
+
+/**
+ * @brief  Merge the registers behind 'signals' into the fewest block
+ *         reads. Addresses closer than [MODBUS] PLAN_MAX_GAP share a block.
+ *         Also records where each signal lands, for CODEC_Decode.
+ * @return 0 on success, -1 on invalid axis or empty set
+ */
+int PLAN_Build(ReadPlan_t *plan, Axis_t axis, uint32_t signals);
+
+/**
+ * @brief  Register address and function code of one signal on an axis
+ * @return 0 on success, -1 on invalid axis/signal
+ */
+int PLAN_SignalAddr(Axis_t axis, Signal_t sig, uint8_t *func, uint16_t *addr);
+
+/**
+ * @brief  Number of registers a signal occupies
+ */
+uint16_t PLAN_SignalRegs(Signal_t sig);
+
+#endif /* READ_PLANNER_H */
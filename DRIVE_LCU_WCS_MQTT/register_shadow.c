@@ -0,0 +1,161 @@
+#include "register_shadow.h"
+#include "modbus_functions.h"
+#include <string.h>
+
+/*===========================================================
+ *  Per-drive, per-axis shadow
+ *  regs    : confirmed register values, insertion order
+ *  connects, losses: MODBUS_Stats_t.connects / .contact_losses
+ *            the values belong to
+ *===========================================================*/
+typedef struct
+{
+    uint16_t addr;
+    uint16_t value;
+} ShadowReg_t;
+
+typedef struct
+{
+    ShadowReg_t regs[SHADOW_MAX_REGS];
+    uint8_t     count;
+    uint32_t    connects;
+    uint32_t    losses;
+} AxisShadow_t;
+
+static AxisShadow_t   shadow_tilt[MAX_DRIVES];
+static AxisShadow_t   shadow_pan[MAX_DRIVES];
+static SHADOW_Stats_t shadow_stats;
+
+/* Shadow of 'axis' on the selected drive */
+static AxisShadow_t *SHADOW_Axis(Axis_t axis)
+{
+    int drv = POOL_Selected();
+
+    switch (axis)
+    {
+        case AXIS_TILT: return &shadow_tilt[drv];
+        case AXIS_PAN:  return &shadow_pan[drv];
+        default:        return NULL;
+    }
+}
+
+static void SHADOW_Clear(AxisShadow_t *sh)
+{
+    if (sh->count > 0)
+        shadow_stats.invalidations++;
+    sh->count = 0;
+}
+
+/* Axis shadow, emptied first if the link reconnected or contact was
+ * lost since it was filled */
+static AxisShadow_t *SHADOW_Current(Axis_t axis)
+{
+    AxisShadow_t *sh = SHADOW_Axis(axis);
+    if (!sh)
+        return NULL;
+
+    MODBUS_Stats_t st;
+    MODBUS_GetStats(&st);
+    if (sh->connects != st.connects || sh->losses != st.contact_losses)
+    {
+        SHADOW_Clear(sh);
+        sh->connects = st.connects;
+        sh->losses   = st.contact_losses;
+    }
+    return sh;
+}
+
+static int SHADOW_Find(const AxisShadow_t *sh, uint16_t addr)
+{
+    for (uint8_t i = 0; i < sh->count; i++)
+    {
+        if (sh->regs[i].addr == addr)
+            return i;
+    }
+    return -1;
+}
+
+static void SHADOW_Remove(AxisShadow_t *sh, int idx)
+{
+    memmove(&sh->regs[idx], &sh->regs[idx + 1],
+            (size_t)(sh->count - idx - 1) * sizeof(sh->regs[0]));
+    sh->count--;
+}
+
+int SHADOW_Matches(Axis_t axis, uint16_t addr,
+                   const uint16_t *data, uint16_t count)
+{
+    AxisShadow_t *sh = SHADOW_Current(axis);
+    int hit = (sh != NULL && data != NULL && count > 0);
+
+    for (uint16_t i = 0; hit && i < count; i++)
+    {
+        int idx = SHADOW_Find(sh, (uint16_t)(addr + i));
+        if (idx < 0 || sh->regs[idx].value != data[i])
+            hit = 0;
+    }
+
+    if (hit)
+        shadow_stats.hits++;
+    else
+        shadow_stats.misses++;
+    return hit;
+}
+
+void SHADOW_Store(Axis_t axis, uint16_t addr,
+                  const uint16_t *data, uint16_t count)
+{
+    AxisShadow_t *sh = SHADOW_Current(axis);
+    if (!sh || !data)
+        return;
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        uint16_t reg = (uint16_t)(addr + i);
+        int idx = SHADOW_Find(sh, reg);
+
+        if (idx < 0)
+        {
+            /* full: the oldest entry makes room */
+            if (sh->count == SHADOW_MAX_REGS)
+                SHADOW_Remove(sh, 0);
+            idx = sh->count++;
+            sh->regs[idx].addr = reg;
+        }
+        sh->regs[idx].value = data[i];
+    }
+}
+
+void SHADOW_Forget(Axis_t axis, uint16_t addr, uint16_t count)
+{
+    AxisShadow_t *sh = SHADOW_Axis(axis);
+    if (!sh)
+        return;
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        int idx = SHADOW_Find(sh, (uint16_t)(addr + i));
+        if (idx >= 0)
+            SHADOW_Remove(sh, idx);
+    }
+}
+
+void SHADOW_Invalidate(Axis_t axis)
+{
+    if (axis == AXIS_BOTH)
+    {
+        SHADOW_Clear(SHADOW_Axis(AXIS_TILT));
+        SHADOW_Clear(SHADOW_Axis(AXIS_PAN));
+        return;
+    }
+
+    AxisShadow_t *sh = SHADOW_Axis(axis);
+    if (sh)
+        SHADOW_Clear(sh);
+}
+
+void SHADOW_GetStats(SHADOW_Stats_t *out)
+{
+    if (out)
+        *out = shadow_stats;
+}
@@ -0,0 +1,63 @@
+#ifndef REGISTER_SHADOW_H
+#define REGISTER_SHADOW_H
+
+#include <stdint.h>
+#include "axis_helper.h"
+
+/*===========================================================
+ * Write-through shadow of the drive's holding registers
+ *
+ * Holds, per drive and axis, the last value each parameter
+ * register was confirmed to hold (written, then read back equal).
+ * A write whose registers all match the shadow can be skipped.
+ * Calls act on the selected drive (POOL_Select). The shadow is
+ * dropped on drive reset, whenever the drive's Modbus link
+ * (re)connects and whenever contact with the drive is lost (see
+ * MODBUS_Stats_t.contact_losses), since the drive may have lost
+ * or changed state, e.g. power-cycled behind a UDP link.
+ *===========================================================*/
+#define SHADOW_MAX_REGS   16U   /* registers remembered per axis */
+
+/**
+ * @brief Shadow counters since start-up
+ */
+typedef struct
+{
+    uint32_t hits;          /**< Writes skipped: drive already holds them */
+    uint32_t misses;        /**< Writes that had to go to the drive       */
+    uint32_t invalidations; /**< Axis shadows dropped (reset / reconnect /
+                                 contact lost)                            */
+} SHADOW_Stats_t;
+
+/**
+ * @brief  Check whether the drive is known to hold 'data' at
+ *         'addr'..'addr'+'count'-1; counts a hit or a miss
+ * @return 1 if the write can be skipped, 0 otherwise
+ */
+int SHADOW_Matches(Axis_t axis, uint16_t addr,
+                   const uint16_t *data, uint16_t count);
+
+/**
+ * @brief  Record registers the drive has confirmed
+ */
+void SHADOW_Store(Axis_t axis, uint16_t addr,
+                  const uint16_t *data, uint16_t count);
+
+/**
+ * @brief  Forget registers whose drive value is no longer known
+ *         (write in progress, unverified or failed)
+ */
+void SHADOW_Forget(Axis_t axis, uint16_t addr, uint16_t count);
+
+/**
+ * @brief  Drop everything known about one axis of the selected
+ *         drive (AXIS_BOTH: both axes)
+ */
+void SHADOW_Invalidate(Axis_t axis);
+
+/**
+ * @brief  Copy the shadow counters
+ */
+void SHADOW_GetStats(SHADOW_Stats_t *out);
+
+#endif /* REGISTER_SHADOW_H */
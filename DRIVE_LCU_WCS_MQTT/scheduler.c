@@ -0,0 +1,203 @@
+#include "scheduler.h"
+#include <stdio.h>
+#include <string.h>
+
+static SCHED_t   *sched_list[SCHED_MAX_SCHEDULERS];
+static atomic_int sched_count;
+
+/*----------------------------------------------------------
+ * Min-heap of task indices ordered by next_us, then by the
+ * order the tasks were added
+ *----------------------------------------------------------*/
+static int SCHED_Before(const SCHED_t *s, uint8_t a, uint8_t b)
+{
+    if (s->tasks[a].next_us != s->tasks[b].next_us)
+        return s->tasks[a].next_us < s->tasks[b].next_us;
+    return a < b;
+}
+
+static void SCHED_Swap(SCHED_t *s, uint8_t i, uint8_t j)
+{
+    uint8_t t = s->heap[i];
+    s->heap[i] = s->heap[j];
+    s->heap[j] = t;
+}
+
+static void SCHED_SiftUp(SCHED_t *s, uint8_t i)
+{
+    while (i > 0)
+    {
+        uint8_t parent = (uint8_t)((i - 1U) / 2U);
+        if (!SCHED_Before(s, s->heap[i], s->heap[parent]))
+            break;
+        SCHED_Swap(s, i, parent);
+        i = parent;
+    }
+}
+
+static void SCHED_SiftDown(SCHED_t *s, uint8_t i)
+{
+    for (;;)
+    {
+        uint8_t l = (uint8_t)(2U * i + 1U);
+        uint8_t r = (uint8_t)(l + 1U);
+        uint8_t m = i;
+
+        if (l < s->heap_len && SCHED_Before(s, s->heap[l], s->heap[m]))
+            m = l;
+        if (r < s->heap_len && SCHED_Before(s, s->heap[r], s->heap[m]))
+            m = r;
+        if (m == i)
+            return;
+        SCHED_Swap(s, i, m);
+        i = m;
+    }
+}
+
+static void SCHED_Push(SCHED_t *s, uint8_t task)
+{
+    s->heap[s->heap_len] = task;
+    SCHED_SiftUp(s, s->heap_len++);
+}
+
+static uint8_t SCHED_Pop(SCHED_t *s)
+{
+    uint8_t top = s->heap[0];
+    s->heap[0] = s->heap[--s->heap_len];
+    SCHED_SiftDown(s, 0);
+    return top;
+}
+
+/*----------------------------------------------------------
+ * Public API
+ *----------------------------------------------------------*/
+int SCHED_Init(SCHED_t *s, const char *name)
+{
+    if (!s)
+        return -1;
+
+    memset(s, 0, sizeof(*s));
+    snprintf(s->name, sizeof(s->name), "%s", name ? name : "");
+    s->lock = PLAT_MutexCreate();
+    if (!s->lock)
+        return -1;
+
+    int slot = atomic_fetch_add(&sched_count, 1);
+    if (slot >= (int)SCHED_MAX_SCHEDULERS)
+    {
+        atomic_fetch_sub(&sched_count, 1);
+        return -1;
+    }
+    sched_list[slot] = s;
+    return 0;
+}
+
+int SCHED_Add(SCHED_t *s, const char *name, uint32_t period_ms,
+              SCHED_Fn_t fn, void *arg)
+{
+    if (!s || !fn || s->count >= SCHED_MAX_TASKS)
+        return -1;
+
+    SCHED_Task_t *t = &s->tasks[s->count];
+    memset(t, 0, sizeof(*t));
+    t->fn        = fn;
+    t->arg       = arg;
+    t->period_us = (uint64_t)period_ms * 1000ULL;
+    /* both SCHED_NAME_LEN; s->name is terminated by SCHED_Init */
+    memcpy(t->stats.sched, s->name, sizeof(t->stats.sched));
+    t->stats.sched[sizeof(t->stats.sched) - 1] = '\0';
+    snprintf(t->stats.task,  sizeof(t->stats.task),  "%s", name ? name : "");
+    t->stats.period_us = (uint32_t)t->period_us;
+
+    s->count++;
+    return 0;
+}
+
+void SCHED_Run(SCHED_t *s)
+{
+    uint64_t start_us = PLAT_TimeUs();
+
+    /* every grid starts now, in the order the tasks were added */
+    s->heap_len = 0;
+    for (uint8_t i = 0; i < s->count; i++)
+    {
+        s->tasks[i].next_us = start_us;
+        SCHED_Push(s, i);
+    }
+
+    while (s->heap_len > 0 && !atomic_load(&s->stop))
+    {
+        SCHED_Task_t *t = &s->tasks[s->heap[0]];
+
+        PLAT_SleepUntilUs(t->next_us);
+        if (atomic_load(&s->stop))
+            break;
+
+        uint8_t  idx      = SCHED_Pop(s);
+        uint64_t begin_us = PLAT_TimeUs();
+        uint64_t late_us  = (begin_us > t->next_us) ? begin_us - t->next_us : 0U;
+
+        t->fn(t->arg);
+
+        uint64_t end_us  = PLAT_TimeUs();
+        uint32_t skipped = 0;
+
+        if (t->period_us > 0)
+        {
+            /* stay on the grid; skip the points this run overran */
+            t->next_us += t->period_us;
+            if (t->next_us <= end_us)
+            {
+                uint64_t behind = (end_us - t->next_us) / t->period_us + 1U;
+                t->next_us += behind * t->period_us;
+                skipped = (uint32_t)behind;
+            }
+            SCHED_Push(s, idx);
+        }
+
+        PLAT_MutexLock(s->lock);
+        t->stats.runs++;
+        t->stats.overruns += skipped;
+        if (end_us - begin_us > t->stats.max_exec_us)
+            t->stats.max_exec_us = (uint32_t)(end_us - begin_us);
+        HIST_Add(&t->stats.late, (uint32_t)late_us);
+        PLAT_MutexUnlock(s->lock);
+    }
+}
+
+void SCHED_Stop(SCHED_t *s)
+{
+    if (s)
+        atomic_store(&s->stop, 1);
+}
+
+int SCHED_Snapshot(SCHED_Report_t *out, int max)
+{
+    int n = 0;
+    int count = atomic_load(&sched_count);
+
+    if (count > (int)SCHED_MAX_SCHEDULERS)
+        count = (int)SCHED_MAX_SCHEDULERS;
+
+    for (int i = 0; i < count && out; i++)
+    {
+        SCHED_t *s = sched_list[i];
+        if (!s)
+            continue;
+
+        PLAT_MutexLock(s->lock);
+        for (uint8_t k = 0; k < s->count && n < max; k++)
+        {
+            SCHED_Report_t *st = &s->tasks[k].stats;
+            out[n++] = *st;
+
+            /* new interval: keep the names, clear the counters */
+            st->runs        = 0;
+            st->overruns    = 0;
+            st->max_exec_us = 0;
+            memset(&st->late, 0, sizeof(st->late));
+        }
+        PLAT_MutexUnlock(s->lock);
+    }
+    return n;
+}
@@ -0,0 +1,99 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "latency_hist.h"
+#include "platform.h"
+
+/*===========================================================
+ * Multi-rate task scheduler
+ *
+ * Each task runs on a fixed grid of absolute deadlines
+ * (start + k * period, PLAT_TimeUs microseconds), kept in a
+ * min-heap. A late run does not shift the grid: the next
+ * deadline is the next grid point, and grid points a run
+ * overran are skipped and counted instead of being run back
+ * to back. The thread sleeps until the earliest deadline;
+ * tasks due at the same time run in the order they were added.
+ *
+ * Per task the scheduler records runs, overruns, the longest
+ * run and a histogram of start lateness (jitter) since the
+ * previous SCHED_Snapshot.
+ *===========================================================*/
+#define SCHED_MAX_TASKS       8U    /* per scheduler                   */
+#define SCHED_MAX_SCHEDULERS  4U    /* registered for SCHED_Snapshot   */
+#define SCHED_NAME_LEN        16U
+
+typedef void (*SCHED_Fn_t)(void *arg);
+
+/**
+ * @brief Counters of one task since the previous snapshot
+ */
+typedef struct
+{
+    char     sched[SCHED_NAME_LEN];
+    char     task[SCHED_NAME_LEN];
+    uint32_t period_us;
+    uint32_t runs;
+    uint32_t overruns;      /**< Deadlines skipped: a run ended past them */
+    uint32_t max_exec_us;   /**< Longest run                              */
+    HIST_t   late;          /**< Start minus deadline, us                 */
+} SCHED_Report_t;
+
+typedef struct
+{
+    SCHED_Fn_t     fn;
+    void          *arg;
+    uint64_t       period_us;   /* 0 = run once */
+    uint64_t       next_us;
+    SCHED_Report_t stats;
+} SCHED_Task_t;
+
+/**
+ * @brief One scheduler, run by one thread
+ */
+typedef struct
+{
+    char          name[SCHED_NAME_LEN];
+    SCHED_Task_t  tasks[SCHED_MAX_TASKS];
+    uint8_t       count;
+    uint8_t       heap[SCHED_MAX_TASKS];   /* task indices, earliest first */
+    uint8_t       heap_len;
+    PLAT_Mutex_t *lock;                    /* guards the stats */
+    atomic_int    stop;
+} SCHED_t;
+
+/**
+ * @brief  Prepare an empty scheduler and register it for reports
+ * @return 0 on success, -1 on error
+ */
+int SCHED_Init(SCHED_t *s, const char *name);
+
+/**
+ * @brief  Add a task; the first run is due when SCHED_Run starts,
+ *         after the tasks added before it
+ * @param period_ms Run every 'period_ms'; 0 runs it once
+ * @return 0 on success, -1 when full
+ */
+int SCHED_Add(SCHED_t *s, const char *name, uint32_t period_ms,
+              SCHED_Fn_t fn, void *arg);
+
+/**
+ * @brief  Run tasks on the calling thread until SCHED_Stop
+ */
+void SCHED_Run(SCHED_t *s);
+
+/**
+ * @brief  Make SCHED_Run return after the task in progress
+ */
+void SCHED_Stop(SCHED_t *s);
+
+/**
+ * @brief  Copy the counters of every task of every registered
+ *         scheduler and start a new interval
+ * @return Number of reports written
+ */
+int SCHED_Snapshot(SCHED_Report_t *out, int max);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,190 @@
+#include "signal_codec.h"
+#include "ini.h"
+#include <stddef.h>
+#include <string.h>
+
+/*----------------------------------------------------------
+ * Signal table
+ * Names follow the telemetry JSON keys. Every register is read
+ * as a pair (the drive answers 2-register reads); the value is
+ * the first register unless the format says 32-bit.
+ *----------------------------------------------------------*/
+#define AXIS_REG(m)   offsetof(AXIS_CONFIG, m)
+#define SNAP(m)       offsetof(DriveSnapshot_t, m)
+
+#define CODEC_MAX_DECIMALS  6U
+
+static const CODEC_Desc_t codec_table[SIG_COUNT] =
+{
+    [SIG_ABS_POSITION]  = { "actual_pos_mm", 0x04, AXIS_REG(ABS_POSITION),   2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 0.01F, CODEC_OUT_F32,   SNAP(actual_pos_mm) },
+    [SIG_POS_DEG]       = { "pos_deg",       0x04, AXIS_REG(POS_DEG),        2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 0.01F, CODEC_OUT_F32,   SNAP(pos_deg) },
+    [SIG_POS_MM]        = { "pos_mm",        0x04, AXIS_REG(POS_MM),         2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 0.01F, CODEC_OUT_F32,   SNAP(pos_mm) },
+    [SIG_RPM]           = { "rpm",           0x04, AXIS_REG(RPM),            2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_F32,   SNAP(rpm) },
+    [SIG_CURRENT]       = { "motor_current", 0x04, AXIS_REG(ACTUAL_CURRENT), 2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 0.01F, CODEC_OUT_F32,   SNAP(current) },
+    [SIG_IO_STATUS]     = { "io_status",     0x04, AXIS_REG(IO_STATUS),      2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_U16,   SNAP(io_status) },
+    [SIG_SYSTEM_STATUS] = { "system_status", 0x04, AXIS_REG(SYSTEM_STATUS),  2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_F32,   SNAP(system_status) },
+    [SIG_DCBUS_VOLT]    = { "dc_bus",        0x04, AXIS_REG(DCBUS_VOLT_CMD), 2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_F32,   SNAP(dcbus) },
+    [SIG_FAULT_STATUS]  = { "fault_raw",     0x04, AXIS_REG(FAULT_STATUS),   2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_FAULT, SNAP(fault) },
+    [SIG_VERSION]       = { "version",       0x04, AXIS_REG(VERSION),        2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_U16,   SNAP(version) },
+    [SIG_REVISION]      = { "revision",      0x04, AXIS_REG(REVISION),       2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_U16,   SNAP(revision) },
+    [SIG_RELEASE_DATE]  = { "release",       0x04, AXIS_REG(RELEASE_DATE),   2U,
+                            CODEC_U16, CODEC_WORDS_HI_FIRST, 1.0F,  CODEC_OUT_U16,   SNAP(release) },
+};
+
+const CODEC_Desc_t *CODEC_Describe(Signal_t sig)
+{
+    return ((unsigned)sig < SIG_COUNT) ? &codec_table[sig] : NULL;
+}
+
+/* Decode fault register bits using [FAULT_BITS] masks */
+static void CODEC_Fault(uint16_t raw, FaultStatus_t *status)
+{
+    status->raw_code = raw;
+
+    status->short_circuit    = (uint8_t)((raw & fault_cfg.SHORT_CKT) != 0U);
+    status->system_ok        = (uint8_t)((raw & fault_cfg.SYSTEM_HEALTHY) != 0U);
+    status->rated_current    = (uint8_t)((raw & fault_cfg.RATED_CURRENT_FAULT) != 0U);
+    status->over_temp        = (uint8_t)((raw & fault_cfg.OVER_TEMP) != 0U);
+    status->over_volt        = (uint8_t)((raw & fault_cfg.OVER_VOLT) != 0U);
+    status->under_volt       = (uint8_t)((raw & fault_cfg.UNDER_VOLT) != 0U);
+    status->motion_error     = (uint8_t)((raw & fault_cfg.MOTION_ERROR) != 0U);
+    status->drive_disable    = (uint8_t)((raw & fault_cfg.DRIVE_DISABLE) != 0U);
+    status->eeprom_error     = (uint8_t)((raw & fault_cfg.EEPROM_ERROR) != 0U);
+    status->commutation_err  = (uint8_t)((raw & fault_cfg.COMMUTATION_ERROR) != 0U);
+    status->lock_rotor       = (uint8_t)((raw & fault_cfg.LOCK_ROTOR) != 0U);
+    status->emergency_err    = (uint8_t)((raw & fault_cfg.EMERGENCY_ERROR) != 0U);
+    status->command_error    = (uint8_t)((raw & fault_cfg.COMMUTATION_ERROR) != 0U);
+    status->motion_complete  = (uint8_t)((raw & fault_cfg.MOTION_COMPLETE) != 0U);
+}
+
+int32_t CODEC_Raw(const CODEC_Desc_t *d, const uint8_t *regs)
+{
+    uint16_t w0 = (uint16_t)((regs[0] << 8) | regs[1]);
+
+    switch (d->format)
+    {
+        case CODEC_S16:
+            return (int16_t)w0;
+
+        case CODEC_U32:
+        case CODEC_S32:
+        {
+            uint16_t w1  = (uint16_t)((regs[2] << 8) | regs[3]);
+            uint32_t u32 = (d->words == CODEC_WORDS_LO_FIRST) ?
+                           ((uint32_t)w1 << 16) | w0 : ((uint32_t)w0 << 16) | w1;
+            /* U32 above 2^31 wraps; no drive counter gets there */
+            return (int32_t)u32;
+        }
+
+        case CODEC_U16:
+        default:
+            return w0;
+    }
+}
+
+void CODEC_Decode(const ReadPlan_t *plan, const uint8_t *const *data,
+                  DriveSnapshot_t *snap)
+{
+    uint32_t todo = plan->signals;
+
+    while (todo)
+    {
+        int s = __builtin_ctz(todo);
+        todo &= todo - 1U;
+
+        const uint8_t *blk = data[plan->sig_block[s]];
+        if (!blk)
+            continue;
+
+        const CODEC_Desc_t *d = &codec_table[s];
+        int32_t raw = CODEC_Raw(d, blk + plan->sig_offset[s] * 2U);
+        char   *out = (char *)snap + d->out_field;
+
+        switch (d->output)
+        {
+            case CODEC_OUT_F32:   *(float *)out    = (float)raw * d->scale;        break;
+            case CODEC_OUT_U16:   *(uint16_t *)out = (uint16_t)raw;                break;
+            case CODEC_OUT_FAULT: CODEC_Fault((uint16_t)raw, (FaultStatus_t *)out); break;
+            default:                                                               break;
+        }
+        snap->valid |= SIG_MASK(s);
+    }
+}
+
+static size_t CODEC_OutSize(const CODEC_Desc_t *d)
+{
+    switch (d->output)
+    {
+        case CODEC_OUT_F32:   return sizeof(float);
+        case CODEC_OUT_U16:   return sizeof(uint16_t);
+        case CODEC_OUT_FAULT: return sizeof(FaultStatus_t);
+        default:              return 0;
+    }
+}
+
+void CODEC_Copy(DriveSnapshot_t *dst, const DriveSnapshot_t *src,
+                uint32_t signals)
+{
+    uint32_t todo = signals & src->valid;
+
+    dst->valid &= ~signals;
+    dst->valid |= todo;
+
+    while (todo)
+    {
+        int s = __builtin_ctz(todo);
+        todo &= todo - 1U;
+
+        const CODEC_Desc_t *d = &codec_table[s];
+        memcpy((char *)dst + d->out_field, (const char *)src + d->out_field,
+               CODEC_OutSize(d));
+    }
+}
+
+double CODEC_Value(const DriveSnapshot_t *snap, Signal_t sig)
+{
+    const CODEC_Desc_t *d = CODEC_Describe(sig);
+    if (!d)
+        return 0.0;
+
+    const char *in = (const char *)snap + d->out_field;
+
+    switch (d->output)
+    {
+        case CODEC_OUT_F32:   return *(const float *)in;
+        case CODEC_OUT_U16:   return *(const uint16_t *)in;
+        case CODEC_OUT_FAULT: return ((const FaultStatus_t *)in)->raw_code;
+        default:              return 0.0;
+    }
+}
+
+uint8_t CODEC_Decimals(Signal_t sig)
+{
+    const CODEC_Desc_t *d = CODEC_Describe(sig);
+    if (!d || d->output != CODEC_OUT_F32)
+        return 0;
+
+    /* smallest power of ten that makes one count a whole number */
+    float   step = d->scale;
+    uint8_t dec  = 0;
+    while (dec < CODEC_MAX_DECIMALS)
+    {
+        float frac = step - (float)(int32_t)(step + 0.5F);
+        if (frac < 1e-3F && frac > -1e-3F)
+            break;
+        step *= 10.0F;
+        dec++;
+    }
+    return dec;
+}
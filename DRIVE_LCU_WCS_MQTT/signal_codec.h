@@ -0,0 +1,98 @@
+#ifndef SIGNAL_CODEC_H
+#define SIGNAL_CODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "read_planner.h"
+#include "drive_feedback.h"
+
+/*===========================================================
+ * Descriptor-driven feedback decoding
+ *
+ * Every feedback signal is one row of a table: where its address
+ * lives in AXIS_CONFIG, which register kind holds it, how its
+ * registers form a value and where the scaled value goes in
+ * DriveSnapshot_t. The planner reads the table to build block
+ * reads, CODEC_Decode reads it to turn the replies into a
+ * snapshot. A new signal is a new Signal_t and a new row.
+ *===========================================================*/
+typedef enum
+{
+    CODEC_U16 = 0,
+    CODEC_S16,
+    CODEC_U32,
+    CODEC_S32
+} CODEC_Format_t;
+
+typedef enum
+{
+    CODEC_WORDS_HI_FIRST = 0,   /* Modbus convention            */
+    CODEC_WORDS_LO_FIRST        /* 32-bit values, low word first */
+} CODEC_WordOrder_t;
+
+typedef enum
+{
+    CODEC_OUT_F32 = 0,          /* float, raw * scale            */
+    CODEC_OUT_U16,              /* raw register, scale ignored   */
+    CODEC_OUT_FAULT             /* FaultStatus_t via [FAULT_BITS] */
+} CODEC_Output_t;
+
+/**
+ * @brief One feedback signal
+ */
+typedef struct
+{
+    const char *name;       /**< Telemetry / log name            */
+    uint8_t     func;       /**< 0x03 holding or 0x04 input      */
+    size_t      addr_field; /**< AXIS_CONFIG member holding the address */
+    uint8_t     regs;       /**< Registers read; the drive answers in pairs */
+    uint8_t     format;     /**< CODEC_Format_t                  */
+    uint8_t     words;      /**< CODEC_WordOrder_t (32-bit only) */
+    float       scale;      /**< Engineering units per count     */
+    uint8_t     output;     /**< CODEC_Output_t                  */
+    size_t      out_field;  /**< DriveSnapshot_t member written  */
+} CODEC_Desc_t;
+
+/**
+ * @brief  Descriptor of one signal
+ * @return NULL for an unknown signal
+ */
+const CODEC_Desc_t *CODEC_Describe(Signal_t sig);
+
+/**
+ * @brief  Raw value of a signal from its first register's bytes
+ *         (big-endian, as in the reply)
+ */
+int32_t CODEC_Raw(const CODEC_Desc_t *d, const uint8_t *regs);
+
+/**
+ * @brief  Decode every signal of a plan in one pass
+ * @param data One pointer per plan block to its first register's
+ *             bytes in the reply, NULL for a block that failed
+ * @param snap Fields of the decoded signals are set and marked in
+ *             snap->valid; others are left untouched
+ */
+void CODEC_Decode(const ReadPlan_t *plan, const uint8_t *const *data,
+                  DriveSnapshot_t *snap);
+
+/**
+ * @brief  Copy the fields of 'signals' from one snapshot to another;
+ *         fields not valid in 'src' become invalid in 'dst'
+ */
+void CODEC_Copy(DriveSnapshot_t *dst, const DriveSnapshot_t *src,
+                uint32_t signals);
+
+/**
+ * @brief  Decoded value of one signal, whatever its output type
+ *         (the raw code for the fault word)
+ * @return 0 for an unknown signal
+ */
+double CODEC_Value(const DriveSnapshot_t *snap, Signal_t sig);
+
+/**
+ * @brief  Fraction digits a signal's register resolution supports
+ *         (scale 0.01 -> 2, scale 1 -> 0); 0 for an unknown signal
+ */
+uint8_t CODEC_Decimals(Signal_t sig);
+
+#endif /* SIGNAL_CODEC_H */
@@ -3,170 +3,547 @@
 #include "ini.h"
 #include "drive_feedback.h"
 #include "modbus_functions.h"
-#include "cJSON.h"
+#include "register_shadow.h"
+#include "drive_pool.h"
+#include "telemetry_acq.h"
+#include "telemetry_bin.h"
+#include "signal_codec.h"
+#include "platform.h"
+#include "json_writer.h"
+#include "lcu_log.h"
+#include <math.h>
 #include <stdio.h>
 #include <string.h>
 
 /* -------------------------------------------------------
- * TELEMETRY: SEND ONCE (BOOT / STATIC INFO)
+ * Every message is built from the acquisition thread's latest
+ * sample (telemetry_acq.c); nothing here talks to a drive.
+ * Continuous and periodic samples are first gathered into a
+ * TLM_Msg_t, then written as JSON and/or CBOR ([TELEMETRY]
+ * ENCODING), each on its own topic. In batch mode continuous
+ * samples collect in a TLM_Batch_t per axis instead.
  * ------------------------------------------------------- */
-static void send_once_telemetry(Axis_t axis)
+#define ENC_JSON  0x01U
+#define ENC_CBOR  0x02U
+
+static uint8_t telemetry_encodings(void)
 {
-    uint16_t version = 0, revision = 0, release = 0;
+    const char *e = telemetry_cfg.ENCODING;
 
-    Read_Version(axis, &version);
-    Read_Revision(axis, &revision);
-    Read_ReleaseDate(axis, &release);
+    if (strcmp(e, "CBOR") == 0 || strcmp(e, "cbor") == 0)
+        return ENC_CBOR;
+    if (strcmp(e, "BOTH") == 0 || strcmp(e, "both") == 0)
+        return ENC_JSON | ENC_CBOR;
+    return ENC_JSON;
+}
 
-    cJSON *root = cJSON_CreateObject();
-    if (!root) return;
+#define TELEMETRY_JSON_MAX  1024U    /* periodic with full meta: ~700 */
+#define TELEMETRY_BATCH_MAX 4096U    /* 32 motion samples: ~2700 */
 
-    cJSON_AddStringToObject(root, "type", "once");
-    cJSON_AddNumberToObject(root, "axis", axis);
-    cJSON_AddNumberToObject(root, "version", version);
-    cJSON_AddNumberToObject(root, "revision", revision);
-    cJSON_AddNumberToObject(root, "release", release);
+static void publish_json(JSONW_t *w)
+{
+    if (JSONW_Finish(w))
+        mqtt_publish(net_cfg.MQTT_TOPIC_TELEMETRY, w->buf, w->len);
+    else
+        LOG_WARN("[TLM] JSON telemetry over %zu bytes dropped (%u so far)\n",
+                 w->cap, JSONW_Dropped());
+}
+
+static void publish_cbor(const TLM_Msg_t *msg)
+{
+    uint8_t buf[TLM_MAX_BYTES];
+    size_t  len = TLM_Encode(msg, buf, sizeof(buf));
+
+    if (len > 0)
+        mqtt_publish(net_cfg.MQTT_TOPIC_TELEMETRY_CBOR, buf, len);
+}
 
-    char *json = cJSON_PrintUnformatted(root);
-    if (json)
+/* Signal values of 'signals' into the message, as decoded */
+static void msg_values(TLM_Msg_t *msg, const DriveSnapshot_t *snap,
+                       uint32_t signals)
+{
+    for (uint32_t todo = signals; todo; todo &= todo - 1U)
     {
-        mqtt_publish(net_cfg.MQTT_TOPIC_TELEMETRY,
-                     json,
-                     strlen(json));
-        cJSON_free(json);
+        int sig = __builtin_ctz(todo);
+        msg->values[sig] = CODEC_Value(snap, (Signal_t)sig);
     }
+    msg->present |= signals;
+}
+
+static void msg_init(TLM_Msg_t *msg, TLM_Kind_t kind, Axis_t axis, int drive)
+{
+    memset(msg, 0, sizeof(*msg));
+    msg->kind = (uint8_t)kind;
+    msg->axis = (uint8_t)axis;
+    snprintf(msg->drive, sizeof(msg->drive), "%s", POOL_Drive(drive)->NAME);
+}
+
+static void msg_meta(TLM_Msg_t *msg, TLM_Meta_t m, double v)
+{
+    msg->meta[m]        = v;
+    msg->meta_present  |= 1U << m;
+}
+
+/* Modbus cost of the continuous cycles since the drive's last
+ * periodic message (reported in its "meta" block) */
+static void add_cycle_meta(TLM_Msg_t *msg, int drive, const ACQ_Sample_t *s)
+{
+    static uint32_t last_cycles[MAX_DRIVES];
+    static uint32_t last_syscalls[MAX_DRIVES];
+    static uint32_t last_frames[MAX_DRIVES];
+
+    uint32_t cycles = s->cycles - last_cycles[drive];
+    if (cycles == 0)
+        return;
+
+    msg_meta(msg, TLM_META_CYCLES, cycles);
+    msg_meta(msg, TLM_META_SYSCALLS_PER_CYCLE,
+             (double)(s->syscalls - last_syscalls[drive]) / cycles);
+    msg_meta(msg, TLM_META_FRAMES_PER_CYCLE,
+             (double)(s->frames - last_frames[drive]) / cycles);
+
+    last_cycles[drive]   = s->cycles;
+    last_syscalls[drive] = s->syscalls;
+    last_frames[drive]   = s->frames;
+}
+
+/* Drive link timing (RTT estimate, retry totals) and shadow savings */
+static void add_link_meta(TLM_Msg_t *msg, const ACQ_Sample_t *s)
+{
+    const MODBUS_Stats_t *st = &s->link;
+
+    msg_meta(msg, TLM_META_SRTT_US,   st->srtt_us);
+    msg_meta(msg, TLM_META_RTTVAR_US, st->rttvar_us);
+    msg_meta(msg, TLM_META_RTO_US,    st->rto_us);
+    msg_meta(msg, TLM_META_RETRIES,   st->retries);
+    msg_meta(msg, TLM_META_RECOVERED, st->recovered);
+    msg_meta(msg, TLM_META_TIMEOUTS,  st->timeouts);
+
+    /* each shadow hit saved a write and its read-back */
+    msg_meta(msg, TLM_META_SHADOW_HITS,   s->shadow.hits);
+    msg_meta(msg, TLM_META_SHADOW_MISSES, s->shadow.misses);
+
+    /* batch mode: motion samples the publisher fell too far behind for */
+    if (telemetry_cfg.BATCH_SAMPLES > 1)
+        msg_meta(msg, TLM_META_BATCH_DROPS, s->motion_drops);
+
+    /* JSON messages (telemetry, ACKs) too big for their buffer */
+    msg_meta(msg, TLM_META_JSON_DROPS, JSONW_Dropped());
+}
+
+/* -------------------------------------------------------
+ * TELEMETRY: SEND ONCE (BOOT / STATIC INFO)
+ * ------------------------------------------------------- */
+static void send_once_telemetry(Axis_t axis, const char *drive,
+                                const ACQ_Sample_t *s)
+{
+    const DriveSnapshot_t *snap = &s->axis[ACQ_AXIS_INDEX(axis)].snap;
+    char    json[TELEMETRY_JSON_MAX];
+    JSONW_t w;
+
+    JSONW_Init(&w, json, sizeof(json));
+    JSONW_ObjectBegin(&w, NULL);
+    JSONW_Str(&w, "type", "once");
+    JSONW_Str(&w, "drive", drive);
+    JSONW_Num(&w, "axis", axis);
+    JSONW_Num(&w, "version", snap->version);
+    JSONW_Num(&w, "revision", snap->revision);
+    JSONW_Num(&w, "release", snap->release);
+    JSONW_ObjectEnd(&w);
 
-    cJSON_Delete(root);
+    publish_json(&w);
 }
 
 /* -------------------------------------------------------
  * TELEMETRY: PERIODIC (HEALTH / STATUS)
  * ------------------------------------------------------- */
-static void send_periodic_telemetry(Axis_t axis)
+static uint16_t fault_bits(const FaultStatus_t *f)
 {
-    float motor_current = 0.0f;
-    float dcbus         = 0.0f;
-    FaultStatus_t fault = {0};
+    const uint8_t flags[TLM_FAULT_COUNT] =
+    {
+        [TLM_FAULT_SHORT_CIRCUIT]   = f->short_circuit,
+        [TLM_FAULT_SYSTEM_OK]       = f->system_ok,
+        [TLM_FAULT_RATED_CURRENT]   = f->rated_current,
+        [TLM_FAULT_OVER_TEMP]       = f->over_temp,
+        [TLM_FAULT_OVER_VOLT]       = f->over_volt,
+        [TLM_FAULT_UNDER_VOLT]      = f->under_volt,
+        [TLM_FAULT_MOTION_ERROR]    = f->motion_error,
+        [TLM_FAULT_DRIVE_DISABLE]   = f->drive_disable,
+        [TLM_FAULT_EEPROM_ERROR]    = f->eeprom_error,
+        [TLM_FAULT_COMMUTATION_ERR] = f->commutation_err,
+        [TLM_FAULT_LOCK_ROTOR]      = f->lock_rotor,
+        [TLM_FAULT_EMERGENCY_ERR]   = f->emergency_err,
+        [TLM_FAULT_COMMAND_ERROR]   = f->command_error,
+        [TLM_FAULT_MOTION_COMPLETE] = f->motion_complete,
+    };
+    uint16_t bits = 0;
 
-    int32_t drive_status = MODBUS_CheckConnection();
-    uint8_t drive_connected = (drive_status == 0);
+    for (uint8_t i = 0; i < TLM_FAULT_COUNT; i++)
+        bits |= (uint16_t)((flags[i] != 0U) << i);
+    return bits;
+}
 
-    if (drive_connected)
+/* Envelope and "body":{ of every periodic message, written once */
+static const JSONW_t *periodic_envelope(void)
+{
+    static char    prefix[128];
+    static JSONW_t tmpl;
+
+    if (tmpl.len == 0)
     {
-        Read_Current(axis, &motor_current);
-        Read_DCBusVoltage(axis, &dcbus);
-        Read_FaultStatus(axis, &fault);
+        JSONW_Init(&tmpl, prefix, sizeof(prefix));
+        JSONW_ObjectBegin(&tmpl, NULL);
+        JSONW_Num(&tmpl, "v", 1);
+        JSONW_Str(&tmpl, "id", "periodic");
+        JSONW_Str(&tmpl, "type", "Event");
+        JSONW_Str(&tmpl, "name", "TelemetryPeriodic");
+        JSONW_Str(&tmpl, "src", "middleware");
+        JSONW_ObjectBegin(&tmpl, "body");
     }
+    return &tmpl;
+}
 
-    cJSON *root = cJSON_CreateObject();
-    cJSON *body = cJSON_CreateObject();
-    cJSON *fault_bits = cJSON_CreateObject();
-
-    if (!root || !body || !fault_bits)
-        goto cleanup;
-
-    cJSON_AddNumberToObject(root, "v", 1);
-    cJSON_AddStringToObject(root, "id", "periodic");
-    cJSON_AddStringToObject(root, "type", "Event");
-    cJSON_AddStringToObject(root, "name", "TelemetryPeriodic");
-    cJSON_AddStringToObject(root, "src", "middleware");
-
-    cJSON_AddNumberToObject(body, "axis", axis);
-    cJSON_AddBoolToObject(body, "drive_connected", drive_connected);
-    cJSON_AddNumberToObject(body, "motor_current", motor_current);
-    cJSON_AddNumberToObject(body, "dc_bus", dcbus);
-    cJSON_AddNumberToObject(body, "fault_raw", fault.raw_code);
-
-    cJSON_AddBoolToObject(fault_bits, "short_circuit",   fault.short_circuit);
-    cJSON_AddBoolToObject(fault_bits, "system_ok",       fault.system_ok);
-    cJSON_AddBoolToObject(fault_bits, "rated_current",   fault.rated_current);
-    cJSON_AddBoolToObject(fault_bits, "over_temp",       fault.over_temp);
-    cJSON_AddBoolToObject(fault_bits, "over_volt",       fault.over_volt);
-    cJSON_AddBoolToObject(fault_bits, "under_volt",      fault.under_volt);
-    cJSON_AddBoolToObject(fault_bits, "motion_error",    fault.motion_error);
-    cJSON_AddBoolToObject(fault_bits, "drive_disable",   fault.drive_disable);
-    cJSON_AddBoolToObject(fault_bits, "eeprom_error",    fault.eeprom_error);
-    cJSON_AddBoolToObject(fault_bits, "commutation_err", fault.commutation_err);
-    cJSON_AddBoolToObject(fault_bits, "lock_rotor",      fault.lock_rotor);
-    cJSON_AddBoolToObject(fault_bits, "emergency_err",   fault.emergency_err);
-    cJSON_AddBoolToObject(fault_bits, "command_error",   fault.command_error);
-    cJSON_AddBoolToObject(fault_bits, "motion_complete", fault.motion_complete);
-
-    cJSON_AddItemToObject(body, "fault_bits", fault_bits);
-    cJSON_AddItemToObject(root, "body", body);
-    cJSON_AddItemToObject(root, "meta", cJSON_CreateObject());
-
-    char *json = cJSON_PrintUnformatted(root);
-    if (json)
+static void publish_periodic_json(const TLM_Msg_t *msg)
+{
+    char    json[TELEMETRY_JSON_MAX];
+    JSONW_t w;
+
+    JSONW_From(&w, periodic_envelope(), json, sizeof(json));
+
+    JSONW_Str(&w, "drive", msg->drive);
+    JSONW_Num(&w, "axis", msg->axis);
+    JSONW_Bool(&w, "drive_connected", msg->connected);
+
+    /* motor_current, dc_bus, fault_raw */
+    for (uint32_t todo = msg->present; todo; todo &= todo - 1U)
+    {
+        int sig = __builtin_ctz(todo);
+        JSONW_Fixed(&w, CODEC_Describe((Signal_t)sig)->name, msg->values[sig],
+                    CODEC_Decimals((Signal_t)sig));
+    }
+
+    JSONW_ObjectBegin(&w, "fault_bits");
+    for (uint8_t i = 0; i < TLM_FAULT_COUNT; i++)
+        JSONW_Bool(&w, TLM_FaultName((TLM_Fault_t)i), (msg->faults >> i) & 1U);
+    JSONW_ObjectEnd(&w);
+    JSONW_ObjectEnd(&w);    /* body */
+
+    JSONW_ObjectBegin(&w, "meta");
+    for (uint8_t m = 0; m < TLM_META_COUNT; m++)
     {
-        mqtt_publish(net_cfg.MQTT_TOPIC_TELEMETRY,
-                     json,
-                     strlen(json));
-        cJSON_free(json);
+        if (msg->meta_present & (1U << m))
+            JSONW_Num(&w, TLM_MetaName((TLM_Meta_t)m), msg->meta[m]);
     }
+    JSONW_ObjectEnd(&w);
+    JSONW_ObjectEnd(&w);
 
-cleanup:
-    cJSON_Delete(root);
+    publish_json(&w);
 }
+
+static void send_periodic_telemetry(Axis_t axis, int drive,
+                                    const ACQ_Sample_t *s, uint8_t enc)
+{
+    const DriveSnapshot_t *snap = &s->axis[ACQ_AXIS_INDEX(axis)].snap;
+    TLM_Msg_t msg;
+
+    msg_init(&msg, TLM_KIND_PERIODIC, axis, drive);
+    msg.has      |= TLM_HAS_CONNECTED | TLM_HAS_FAULTS;
+    msg.connected = s->connected;
+    msg.faults    = fault_bits(&snap->fault);
+    msg_values(&msg, snap, SIGSET_PERIODIC);
+    add_cycle_meta(&msg, drive, s);
+    add_link_meta(&msg, s);
+
+    if (enc & ENC_JSON)
+        publish_periodic_json(&msg);
+    if (enc & ENC_CBOR)
+        publish_cbor(&msg);
+}
+
 /* -------------------------------------------------------
  * TELEMETRY: CONTINUOUS (MOTION FEEDBACK)
  * ------------------------------------------------------- */
-static void send_continuous_telemetry(Axis_t axis)
-{
-    float actual_pos_mm = 0.0f;
-    float pos_deg = 0.0f;
-    float pos_mm  = 0.0f;
-    float rpm     = 0.0f;
-    uint16_t io_status = 0;
-
-    Read_Actual_Absolute_Pos_MM(axis, &actual_pos_mm);
-    Read_Position_Deg(axis, &pos_deg);
-    Read_Position_MM(axis, &pos_mm);
-    Read_RPM(axis, &rpm);
-    Read_IO_Status(axis, &io_status);
-
-    cJSON *root = cJSON_CreateObject();
-    if (!root) return;
-
-    cJSON_AddStringToObject(root, "type", "continuous");
-    cJSON_AddNumberToObject(root, "axis", axis);
-    cJSON_AddNumberToObject(root, "actual_pos_mm", actual_pos_mm);
-    cJSON_AddNumberToObject(root, "pos_deg", pos_deg);
-    cJSON_AddNumberToObject(root, "pos_mm", pos_mm);
-    cJSON_AddNumberToObject(root, "rpm", rpm);
-    cJSON_AddNumberToObject(root, "io_status", io_status);
-
-    char *json = cJSON_PrintUnformatted(root);
-    if (json)
+typedef struct
+{
+    Signal_t     sig;
+    const float *band;      /* [TELEMETRY] DB_* deadband */
+} DeltaField_t;
+
+static const DeltaField_t delta_fields[] =
+{
+    { SIG_ABS_POSITION, &telemetry_cfg.DB_ACTUAL_POS_MM },
+    { SIG_POS_DEG,      &telemetry_cfg.DB_POS_DEG       },
+    { SIG_POS_MM,       &telemetry_cfg.DB_POS_MM        },
+    { SIG_RPM,          &telemetry_cfg.DB_RPM           },
+    { SIG_IO_STATUS,    &telemetry_cfg.DB_IO_STATUS     },
+};
+#define DELTA_FIELDS  (sizeof(delta_fields) / sizeof(delta_fields[0]))
+
+/* What one drive axis last sent (publisher thread only) */
+typedef struct
+{
+    uint32_t seq;                   /* messages sent          */
+    uint64_t sent_us;               /* last message           */
+    uint64_t key_us;                /* last keyframe          */
+    double   last[SIG_COUNT];       /* values as last sent    */
+} DeltaState_t;
+
+static DeltaState_t delta_state[MAX_DRIVES][ACQ_AXES];
+
+static void publish_continuous_json(const TLM_Msg_t *msg)
+{
+    char    json[TELEMETRY_JSON_MAX];
+    JSONW_t w;
+
+    JSONW_Init(&w, json, sizeof(json));
+    JSONW_ObjectBegin(&w, NULL);
+    JSONW_Str(&w, "type", "continuous");
+    JSONW_Str(&w, "drive", msg->drive);
+    JSONW_Num(&w, "axis", msg->axis);
+
+    /* delta mode: a sequence number, and which fields moved */
+    if (msg->has & TLM_HAS_SEQ)
+    {
+        JSONW_Num(&w, "seq", msg->seq);
+        JSONW_Bool(&w, "key", msg->keyframe);
+
+        JSONW_ArrayBegin(&w, "changed");
+        for (uint32_t todo = msg->changed; todo; todo &= todo - 1U)
+            JSONW_Str(&w, NULL, CODEC_Describe((Signal_t)__builtin_ctz(todo))->name);
+        JSONW_ArrayEnd(&w);
+    }
+
+    for (uint32_t todo = msg->present; todo; todo &= todo - 1U)
+    {
+        int sig = __builtin_ctz(todo);
+        JSONW_Fixed(&w, CODEC_Describe((Signal_t)sig)->name, msg->values[sig],
+                    CODEC_Decimals((Signal_t)sig));
+    }
+    JSONW_ObjectEnd(&w);
+
+    publish_json(&w);
+}
+
+static void publish_continuous(const TLM_Msg_t *msg, uint8_t enc)
+{
+    if (enc & ENC_JSON)
+        publish_continuous_json(msg);
+    if (enc & ENC_CBOR)
+        publish_cbor(msg);
+}
+
+/* Delta mode: send the fields that left their deadband, or
+ * everything when a keyframe or the silence limit is due */
+static void send_continuous_delta(Axis_t axis, int drive,
+                                  const DriveSnapshot_t *snap, uint8_t enc)
+{
+    DeltaState_t *st  = &delta_state[drive][ACQ_AXIS_INDEX(axis)];
+    uint64_t      now = PLAT_TimeUs();
+    uint32_t changed  = 0;
+    uint32_t valid    = 0;
+
+    for (uint8_t i = 0; i < DELTA_FIELDS; i++)
+    {
+        Signal_t sig = delta_fields[i].sig;
+
+        if (!(snap->valid & SIG_MASK(sig)))
+            continue;   /* read failed: neither sent nor compared */
+
+        valid |= (uint32_t)SIG_MASK(sig);
+        if (fabs(CODEC_Value(snap, sig) - st->last[sig]) > *delta_fields[i].band)
+            changed |= (uint32_t)SIG_MASK(sig);
+    }
+
+    int key = (st->seq == 0) ||
+              (telemetry_cfg.KEYFRAME_MS > 0 &&
+               now - st->key_us >= (uint64_t)telemetry_cfg.KEYFRAME_MS * 1000U) ||
+              (telemetry_cfg.MAX_SILENCE_MS > 0 &&
+               now - st->sent_us >= (uint64_t)telemetry_cfg.MAX_SILENCE_MS * 1000U);
+
+    if (!key && !changed)
+        return;
+
+    TLM_Msg_t msg;
+    msg_init(&msg, TLM_KIND_CONTINUOUS, axis, drive);
+    msg_values(&msg, snap, key ? valid : changed);
+    msg.has     |= TLM_HAS_SEQ;
+    msg.seq      = ++st->seq;
+    msg.keyframe = (uint8_t)key;
+    msg.changed  = changed;
+
+    publish_continuous(&msg, enc);
+
+    for (uint32_t todo = msg.present; todo; todo &= todo - 1U)
+    {
+        int sig = __builtin_ctz(todo);
+        st->last[sig] = msg.values[sig];
+    }
+    st->sent_us = now;
+    if (key)
+        st->key_us = now;
+}
+
+/* Batch mode: one axis' samples since its last batch (publisher
+ * thread only) */
+static TLM_Batch_t batch_state[MAX_DRIVES][ACQ_AXES];
+
+/* Samples per batch, 0 when batching is off */
+static uint8_t batch_limit(void)
+{
+    int n = telemetry_cfg.BATCH_SAMPLES;
+
+    if (n <= 1)
+        return 0;
+    return (n < (int)TLM_BATCH_MAX) ? (uint8_t)n : (uint8_t)TLM_BATCH_MAX;
+}
+
+static void publish_batch_json(const TLM_Batch_t *b)
+{
+    static char json[TELEMETRY_BATCH_MAX];
+    JSONW_t w;
+
+    JSONW_Init(&w, json, sizeof(json));
+    JSONW_ObjectBegin(&w, NULL);
+    JSONW_Str(&w, "type", "continuous_batch");
+    JSONW_Str(&w, "drive", b->drive);
+    JSONW_Num(&w, "axis", b->axis);
+    JSONW_Num(&w, "seq", b->seq);
+    JSONW_Num(&w, "n", b->count);
+    JSONW_Num(&w, "t0_us", (double)b->t0_us);
+
+    JSONW_ArrayBegin(&w, "dt_us");
+    for (uint8_t i = 0; i < b->count; i++)
+        JSONW_Num(&w, NULL, b->dt_us[i]);
+    JSONW_ArrayEnd(&w);
+
+    /* one array per signal; null where that read failed */
+    for (uint32_t todo = b->present; todo; todo &= todo - 1U)
     {
-        mqtt_publish(net_cfg.MQTT_TOPIC_TELEMETRY,
-                     json,
-                     strlen(json));
-        cJSON_free(json);
+        int     sig = __builtin_ctz(todo);
+        uint8_t dec = CODEC_Decimals((Signal_t)sig);
+
+        JSONW_ArrayBegin(&w, CODEC_Describe((Signal_t)sig)->name);
+        for (uint8_t i = 0; i < b->count; i++)
+            JSONW_Fixed(&w, NULL, b->values[sig][i], dec);
+        JSONW_ArrayEnd(&w);
     }
+    JSONW_ObjectEnd(&w);
 
-    cJSON_Delete(root);
+    publish_json(&w);
 }
+
+static void flush_batch(TLM_Batch_t *b, uint8_t enc)
+{
+    b->seq++;
+
+    if (enc & ENC_JSON)
+        publish_batch_json(b);
+    if (enc & ENC_CBOR)
+    {
+        static uint8_t buf[TLM_BATCH_MAX_BYTES];
+        size_t len = TLM_EncodeBatch(b, buf, sizeof(buf));
+
+        if (len > 0)
+            mqtt_publish(net_cfg.MQTT_TOPIC_TELEMETRY_CBOR, buf, len);
+    }
+    b->count = 0;
+}
+
+/* Batch mode: add every sample the acquisition thread queued for
+ * the axis, send the batch once it is full or its first sample is
+ * BATCH_MS old */
+static void send_continuous_batch(Axis_t axis, int drive, uint8_t limit, uint8_t enc)
+{
+    TLM_Batch_t *b = &batch_state[drive][ACQ_AXIS_INDEX(axis)];
+    ACQ_Motion_t m;
+
+    while (ACQ_TakeMotion(drive, axis, &m))
+    {
+        /* dt_us is 32-bit: a batch spans at most ~71 minutes */
+        if (b->count > 0 && m.t_us - b->t0_us > UINT32_MAX)
+            flush_batch(b, enc);
+
+        if (b->count == 0)
+        {
+            b->axis    = (uint8_t)axis;
+            b->t0_us   = m.t_us;
+            b->present = SIGSET_CONTINUOUS;
+            snprintf(b->drive, sizeof(b->drive), "%s", POOL_Drive(drive)->NAME);
+        }
+
+        uint8_t i = b->count++;
+        b->dt_us[i] = (uint32_t)(m.t_us - b->t0_us);
+        for (uint32_t todo = SIGSET_CONTINUOUS; todo; todo &= todo - 1U)
+        {
+            int sig = __builtin_ctz(todo);
+            b->values[sig][i] = (m.snap.valid & SIG_MASK(sig))
+                              ? CODEC_Value(&m.snap, (Signal_t)sig) : NAN;
+        }
+
+        if (b->count >= limit)
+            flush_batch(b, enc);
+    }
+
+    if (b->count > 0 && telemetry_cfg.BATCH_MS > 0 &&
+        PLAT_TimeUs() - b->t0_us >= (uint64_t)telemetry_cfg.BATCH_MS * 1000U)
+        flush_batch(b, enc);
+}
+
+static void send_continuous_telemetry(Axis_t axis, int drive,
+                                      const ACQ_Axis_t *ax, uint8_t enc)
+{
+    const DriveSnapshot_t *snap = &ax->snap;
+    uint8_t   limit = batch_limit();
+    TLM_Msg_t msg;
+
+    if (limit > 0)
+    {
+        send_continuous_batch(axis, drive, limit, enc);
+        return;
+    }
+    if (telemetry_cfg.DELTA)
+    {
+        send_continuous_delta(axis, drive, snap, enc);
+        return;
+    }
+
+    msg_init(&msg, TLM_KIND_CONTINUOUS, axis, drive);
+    msg_values(&msg, snap, SIGSET_CONTINUOUS);
+    publish_continuous(&msg, enc);
+}
+
 /* -------------------------------------------------------
  * PUBLIC TELEMETRY API
  * ------------------------------------------------------- */
 void Task_Send_Telemetry(Axis_t axis, TelemetryMode_t mode)
 {
-    switch (mode)
+    if (ACQ_AXIS_INDEX(axis) < 0 || ACQ_AXIS_INDEX(axis) >= (int)ACQ_AXES)
+        return;
+
+    uint8_t enc = telemetry_encodings();
+
+    for (int d = 0; d < POOL_Count(); d++)
     {
-        case TELEMETRY_ONCE:
-            send_once_telemetry(axis);
-            break;
+        ACQ_Sample_t s;
+        if (ACQ_Read(d, &s) != 0)
+            continue;
+
+        switch (mode)
+        {
+            case TELEMETRY_ONCE:
+                send_once_telemetry(axis, POOL_Drive(d)->NAME, &s);
+                break;
 
-        case TELEMETRY_PERIODIC:
-            send_periodic_telemetry(axis);
-            break;
+            case TELEMETRY_PERIODIC:
+                send_periodic_telemetry(axis, d, &s, enc);
+                break;
 
-        case TELEMETRY_CONTINUOUS:
-            send_continuous_telemetry(axis);
-            break;
+            case TELEMETRY_CONTINUOUS:
+                send_continuous_telemetry(axis, d, &s.axis[ACQ_AXIS_INDEX(axis)], enc);
+                break;
 
-        default:
-            break;
+            default:
+                break;
+        }
     }
 }
@@ -0,0 +1,317 @@
+#include "telemetry_acq.h"
+#include "drive_pool.h"
+#include "signal_codec.h"
+#include "platform.h"
+#include "scheduler.h"
+#include "flight_recorder.h"
+#include "lcu_log.h"
+#include "ini.h"
+#include <stdatomic.h>
+#include <string.h>
+
+#define ACQ_STOP_POLL_MS  10U
+
+static const Axis_t acq_axes[ACQ_AXES] = { AXIS_TILT, AXIS_PAN };
+
+/*===========================================================
+ *  Published samples
+ *  seq even: readers use buf[0], odd: buf[1]. The writer bumps
+ *  seq, fills the copy readers just left, bumps seq again and
+ *  fills the other, so a reader always has a finished copy.
+ *===========================================================*/
+typedef struct
+{
+    atomic_uint  seq;
+    ACQ_Sample_t buf[2];
+} ACQ_Slot_t;
+
+static ACQ_Slot_t   acq_slots[MAX_DRIVES];
+static ACQ_Sample_t acq_work[MAX_DRIVES];   /* writer's private copy */
+
+/*===========================================================
+ *  Motion queues (batch mode)
+ *  Single producer (this thread), single consumer (publisher).
+ *  head and tail only grow; the producer never overwrites a
+ *  sample the consumer has not released.
+ *===========================================================*/
+typedef struct
+{
+    atomic_uint  head;              /* next sample to write */
+    atomic_uint  tail;              /* next sample to take  */
+    ACQ_Motion_t buf[ACQ_QUEUE_SIZE];
+} ACQ_Queue_t;
+
+static ACQ_Queue_t acq_queues[MAX_DRIVES][ACQ_AXES];
+static int         acq_queueing;    /* batch mode: fill the queues */
+
+static SCHED_t    acq_sched;
+static atomic_int acq_running;
+static atomic_int acq_done;
+static atomic_int acq_ready;
+static uint8_t    acq_have;    /* ACQ_HAVE_* bits sampled so far */
+
+#define ACQ_HAVE_CONTINUOUS  0x01U
+#define ACQ_HAVE_PERIODIC    0x02U
+
+static void ACQ_Publish(int d)
+{
+    ACQ_Slot_t *slot = &acq_slots[d];
+    unsigned    seq  = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+
+    acq_work[d].seq++;
+
+    atomic_store_explicit(&slot->seq, seq + 1U, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    slot->buf[seq & 1U] = acq_work[d];
+
+    atomic_store_explicit(&slot->seq, seq + 2U, memory_order_release);
+    slot->buf[(seq + 1U) & 1U] = acq_work[d];
+}
+
+int ACQ_Read(int drive, ACQ_Sample_t *out)
+{
+    if (!out || drive < 0 || drive >= POOL_Count())
+        return -1;
+
+    const ACQ_Slot_t *slot = &acq_slots[drive];
+    unsigned seq;
+
+    do
+    {
+        seq  = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        *out = slot->buf[seq & 1U];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&slot->seq, memory_order_relaxed) != seq);
+
+    return (out->seq > 0) ? 0 : -1;
+}
+
+static void ACQ_QueueMotion(int d, uint8_t a, const DriveSnapshot_t *snap, uint64_t t_us)
+{
+    ACQ_Queue_t *q    = &acq_queues[d][a];
+    unsigned     head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    unsigned     tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+
+    if (head - tail >= ACQ_QUEUE_SIZE)
+    {
+        acq_work[d].motion_drops++;
+        return;
+    }
+
+    ACQ_Motion_t *m = &q->buf[head & (ACQ_QUEUE_SIZE - 1U)];
+    m->t_us = t_us;
+    CODEC_Copy(&m->snap, snap, SIGSET_CONTINUOUS);
+    atomic_store_explicit(&q->head, head + 1U, memory_order_release);
+}
+
+int ACQ_TakeMotion(int drive, Axis_t axis, ACQ_Motion_t *out)
+{
+    int a = ACQ_AXIS_INDEX(axis);
+
+    if (!out || drive < 0 || drive >= POOL_Count() || a < 0 || a >= (int)ACQ_AXES)
+        return 0;
+
+    ACQ_Queue_t *q    = &acq_queues[drive][a];
+    unsigned     tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    unsigned     head = atomic_load_explicit(&q->head, memory_order_acquire);
+
+    if (tail == head)
+        return 0;
+
+    *out = q->buf[tail & (ACQ_QUEUE_SIZE - 1U)];
+    atomic_store_explicit(&q->tail, tail + 1U, memory_order_release);
+    return 1;
+}
+
+/*===========================================================
+ *  Acquisition
+ *  The pool is locked per read, so a command waits for at most
+ *  one read, not for a whole cycle.
+ *===========================================================*/
+
+/* Syscalls and frames sent so far, summed over every drive link */
+static void ACQ_LinkCost(uint32_t *syscalls, uint32_t *frames)
+{
+    *syscalls = 0;
+    *frames   = 0;
+    for (int d = 0; d < POOL_Count(); d++)
+    {
+        MODBUS_Stats_t st;
+        (void)POOL_Select(d);
+        MODBUS_GetStats(&st);
+        *syscalls += st.syscalls;
+        *frames   += st.tx_frames;
+    }
+}
+
+/* Publish every drive; ready once both rates have run */
+static void ACQ_PublishAll(uint8_t have)
+{
+    for (int d = 0; d < POOL_Count(); d++)
+        ACQ_Publish(d);
+
+    acq_have |= have;
+    if (acq_have == (ACQ_HAVE_CONTINUOUS | ACQ_HAVE_PERIODIC))
+        atomic_store(&acq_ready, 1);
+}
+
+static void ACQ_ReadOnce(void *arg)
+{
+    (void)arg;
+
+    for (int d = 0; d < POOL_Count(); d++)
+    {
+        for (uint8_t a = 0; a < ACQ_AXES; a++)
+        {
+            DriveSnapshot_t snap;
+
+            POOL_Lock();
+            (void)POOL_Select(d);
+            (void)Read_Snapshot(acq_axes[a], SIGSET_ONCE, &snap);
+            POOL_Unlock();
+
+            CODEC_Copy(&acq_work[d].axis[a].snap, &snap, SIGSET_ONCE);
+        }
+    }
+    ACQ_PublishAll(0);
+}
+
+static void ACQ_ReadContinuous(void *arg)
+{
+    static DriveSnapshot_t snaps[MAX_DRIVES];
+    uint32_t sys_before, frames_before, sys_after, frames_after;
+    (void)arg;
+
+    for (uint8_t a = 0; a < ACQ_AXES; a++)
+    {
+        /* every drive's blocks in flight together */
+        POOL_Lock();
+        ACQ_LinkCost(&sys_before, &frames_before);
+        (void)Read_SnapshotAll(acq_axes[a], SIGSET_CONTINUOUS, snaps, MAX_DRIVES);
+        ACQ_LinkCost(&sys_after, &frames_after);
+        POOL_Unlock();
+
+        uint64_t now_us = PLAT_TimeUs();
+        for (int d = 0; d < POOL_Count(); d++)
+        {
+            ACQ_Axis_t *ax = &acq_work[d].axis[a];
+            CODEC_Copy(&ax->snap, &snaps[d], SIGSET_CONTINUOUS);
+            ax->continuous_us = now_us;
+            REC_Record(d, acq_axes[a], &snaps[d], now_us);
+            if (acq_queueing)
+                ACQ_QueueMotion(d, a, &snaps[d], now_us);
+
+            acq_work[d].cycles++;
+            acq_work[d].syscalls += sys_after - sys_before;
+            acq_work[d].frames   += frames_after - frames_before;
+        }
+    }
+    ACQ_PublishAll(ACQ_HAVE_CONTINUOUS);
+}
+
+static void ACQ_ReadPeriodic(void *arg)
+{
+    (void)arg;
+
+    for (int d = 0; d < POOL_Count(); d++)
+    {
+        ACQ_Sample_t *s = &acq_work[d];
+
+        POOL_Lock();
+        (void)POOL_Select(d);
+        s->connected = (uint8_t)(MODBUS_CheckConnection() == 0);
+        POOL_Unlock();
+
+        for (uint8_t a = 0; a < ACQ_AXES; a++)
+        {
+            DriveSnapshot_t snap;
+            memset(&snap, 0, sizeof(snap));
+
+            /* current, DC bus and fault word in one coalesced read */
+            if (s->connected)
+            {
+                POOL_Lock();
+                (void)POOL_Select(d);
+                (void)Read_Snapshot(acq_axes[a], SIGSET_PERIODIC, &snap);
+                POOL_Unlock();
+            }
+
+            CODEC_Copy(&s->axis[a].snap, &snap, SIGSET_PERIODIC);
+            s->axis[a].periodic_us = PLAT_TimeUs();
+            REC_Record(d, acq_axes[a], &snap, s->axis[a].periodic_us);
+        }
+
+        POOL_Lock();
+        (void)POOL_Select(d);
+        MODBUS_GetStats(&s->link);
+        SHADOW_GetStats(&s->shadow);
+        POOL_Unlock();
+    }
+    ACQ_PublishAll(ACQ_HAVE_PERIODIC);
+}
+
+static void ACQ_Thread(void *arg)
+{
+    (void)arg;
+
+    SCHED_Run(&acq_sched);
+    atomic_store(&acq_done, 1);
+}
+
+/*===========================================================
+ *  Public API
+ *===========================================================*/
+int ACQ_Start(void)
+{
+    if (atomic_load(&acq_running))
+        return 0;
+
+    memset(acq_work, 0, sizeof(acq_work));
+    acq_have = 0;
+    acq_queueing = (telemetry_cfg.BATCH_SAMPLES > 1);
+    for (int d = 0; d < MAX_DRIVES; d++)
+        for (uint8_t a = 0; a < ACQ_AXES; a++)
+        {
+            atomic_store(&acq_queues[d][a].head, 0U);
+            atomic_store(&acq_queues[d][a].tail, 0U);
+        }
+    atomic_store(&acq_done, 0);
+    atomic_store(&acq_ready, 0);
+
+    /* drive info first, then motion and health on their own grids */
+    if (SCHED_Init(&acq_sched, "acq") != 0 ||
+        SCHED_Add(&acq_sched, "once",       0U, ACQ_ReadOnce, NULL) != 0 ||
+        SCHED_Add(&acq_sched, "continuous", (uint32_t)telemetry_cfg.CONTINUOUS_MS,
+                  ACQ_ReadContinuous, NULL) != 0 ||
+        SCHED_Add(&acq_sched, "periodic",   (uint32_t)telemetry_cfg.PERIODIC_MS,
+                  ACQ_ReadPeriodic, NULL) != 0)
+    {
+        LOG_ERROR("[ERROR] Telemetry acquisition schedule could not be set up\n");
+        return -1;
+    }
+    atomic_store(&acq_running, 1);
+
+    if (PLAT_ThreadStart(ACQ_Thread, NULL) != 0)
+    {
+        atomic_store(&acq_running, 0);
+        LOG_ERROR("[ERROR] Telemetry acquisition thread failed to start\n");
+        return -1;
+    }
+    return 0;
+}
+
+void ACQ_Stop(void)
+{
+    if (!atomic_load(&acq_running))
+        return;
+
+    SCHED_Stop(&acq_sched);
+    while (!atomic_load(&acq_done))
+        PLAT_SleepMs(ACQ_STOP_POLL_MS);
+    atomic_store(&acq_running, 0);
+}
+
+int ACQ_Ready(void)
+{
+    return atomic_load(&acq_ready);
+}
@@ -0,0 +1,107 @@
+#ifndef TELEMETRY_ACQ_H
+#define TELEMETRY_ACQ_H
+
+#include <stdint.h>
+#include "axis_helper.h"
+#include "drive_feedback.h"
+#include "modbus_functions.h"
+#include "register_shadow.h"
+
+/*===========================================================
+ * Telemetry acquisition thread
+ *
+ * One thread owns the periodic drive traffic: every [TELEMETRY]
+ * CONTINUOUS_MS it reads motion feedback of both axes of every
+ * drive, every PERIODIC_MS the health registers, and the drive
+ * info once at start-up. Each rate keeps its own SCHED grid: a
+ * slow health read can delay one motion sample but not shift
+ * the ones after it.
+ * Limit switches are checked on each sample, whether or not the
+ * WCS is connected, and every sample also goes to the flight
+ * recorder (flight_recorder.h).
+ * In batch mode ([TELEMETRY] BATCH_SAMPLES > 1) every motion
+ * sample is also queued per drive axis for the publisher
+ * (ACQ_TakeMotion), so a late publisher cycle batches the samples
+ * it missed instead of skipping them. A queue holds
+ * ACQ_QUEUE_SIZE samples; when the publisher falls further behind
+ * the newest sample is dropped and counted in motion_drops.
+ *
+ * Each drive's latest sample is published through a two-copy
+ * seqlock: the writer fills one copy while readers use the other,
+ * so ACQ_Read never blocks, never waits on the drive and only
+ * retries if it raced a publish. Publishers and the command
+ * thread read it instead of polling the drive themselves.
+ *===========================================================*/
+#define ACQ_AXES        2U      /* AXIS_TILT (1) and AXIS_PAN (2) */
+#define ACQ_QUEUE_SIZE  256U    /* queued motion samples per axis; power of two */
+
+#define ACQ_AXIS_INDEX(axis)  ((int)(axis) - 1)
+
+/**
+ * @brief Latest state of one axis
+ */
+typedef struct
+{
+    DriveSnapshot_t snap;           /**< snap.valid marks current fields   */
+    uint64_t        continuous_us;  /**< Time of the last motion read      */
+    uint64_t        periodic_us;    /**< Time of the last health read      */
+} ACQ_Axis_t;
+
+/**
+ * @brief Latest state of one drive
+ */
+typedef struct
+{
+    uint32_t       seq;             /**< Samples published, 0 = none yet   */
+    uint8_t        connected;       /**< Last connection check passed      */
+    ACQ_Axis_t     axis[ACQ_AXES];  /**< Indexed by ACQ_AXIS_INDEX()       */
+    MODBUS_Stats_t link;            /**< Link counters at the health read  */
+    SHADOW_Stats_t shadow;          /**< Shadow counters at the health read */
+
+    /* Modbus cost of the motion cycles, all links, since start-up */
+    uint32_t       cycles;
+    uint32_t       syscalls;
+    uint32_t       frames;
+    uint32_t       motion_drops;    /**< Samples lost to a full queue      */
+} ACQ_Sample_t;
+
+/**
+ * @brief One queued motion sample (batch mode)
+ */
+typedef struct
+{
+    uint64_t        t_us;           /**< Time of the read (PLAT_TimeUs)    */
+    DriveSnapshot_t snap;           /**< SIGSET_CONTINUOUS fields          */
+} ACQ_Motion_t;
+
+/**
+ * @brief  Start the acquisition thread (after POOL_Init)
+ * @return 0 on success, -1 if the thread could not start
+ */
+int ACQ_Start(void);
+
+/**
+ * @brief  Stop the thread after its current cycle
+ */
+void ACQ_Stop(void);
+
+/**
+ * @brief  1 once every drive has been sampled at least once
+ */
+int ACQ_Ready(void);
+
+/**
+ * @brief  Copy the latest sample of drive 'drive'; lock-free
+ * @return 0 on success, -1 for a bad index or no sample yet
+ */
+int ACQ_Read(int drive, ACQ_Sample_t *out);
+
+/**
+ * @brief  Take the oldest queued motion sample of one drive axis;
+ *         publisher thread only
+ * @return 1 if a sample was taken, 0 if the queue is empty (or
+ *         batch mode is off)
+ */
+int ACQ_TakeMotion(int drive, Axis_t axis, ACQ_Motion_t *out);
+
+#endif /* TELEMETRY_ACQ_H */
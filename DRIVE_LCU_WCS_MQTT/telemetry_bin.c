@@ -0,0 +1,353 @@
+#include "telemetry_bin.h"
+#include "cbor.h"
+#include <math.h>
+#include <string.h>
+
+static const char *const tlm_meta_names[TLM_META_COUNT] =
+{
+    [TLM_META_CYCLES]             = "modbus_cycles",
+    [TLM_META_SYSCALLS_PER_CYCLE] = "syscalls_per_cycle",
+    [TLM_META_FRAMES_PER_CYCLE]   = "frames_per_cycle",
+    [TLM_META_SRTT_US]            = "srtt_us",
+    [TLM_META_RTTVAR_US]          = "rttvar_us",
+    [TLM_META_RTO_US]             = "rto_us",
+    [TLM_META_RETRIES]            = "retries",
+    [TLM_META_RECOVERED]          = "recovered",
+    [TLM_META_TIMEOUTS]           = "timeouts",
+    [TLM_META_SHADOW_HITS]        = "shadow_hits",
+    [TLM_META_SHADOW_MISSES]      = "shadow_misses",
+    [TLM_META_BATCH_DROPS]        = "batch_drops",
+    [TLM_META_JSON_DROPS]         = "json_drops",
+};
+
+static const char *const tlm_fault_names[TLM_FAULT_COUNT] =
+{
+    [TLM_FAULT_SHORT_CIRCUIT]   = "short_circuit",
+    [TLM_FAULT_SYSTEM_OK]       = "system_ok",
+    [TLM_FAULT_RATED_CURRENT]   = "rated_current",
+    [TLM_FAULT_OVER_TEMP]       = "over_temp",
+    [TLM_FAULT_OVER_VOLT]       = "over_volt",
+    [TLM_FAULT_UNDER_VOLT]      = "under_volt",
+    [TLM_FAULT_MOTION_ERROR]    = "motion_error",
+    [TLM_FAULT_DRIVE_DISABLE]   = "drive_disable",
+    [TLM_FAULT_EEPROM_ERROR]    = "eeprom_error",
+    [TLM_FAULT_COMMUTATION_ERR] = "commutation_err",
+    [TLM_FAULT_LOCK_ROTOR]      = "lock_rotor",
+    [TLM_FAULT_EMERGENCY_ERR]   = "emergency_err",
+    [TLM_FAULT_COMMAND_ERROR]   = "command_error",
+    [TLM_FAULT_MOTION_COMPLETE] = "motion_complete",
+};
+
+const char *TLM_MetaName(TLM_Meta_t m)
+{
+    return ((unsigned)m < TLM_META_COUNT) ? tlm_meta_names[m] : NULL;
+}
+
+const char *TLM_FaultName(TLM_Fault_t f)
+{
+    return ((unsigned)f < TLM_FAULT_COUNT) ? tlm_fault_names[f] : NULL;
+}
+
+/*----------------------------------------------------------
+ * Encode
+ *----------------------------------------------------------*/
+size_t TLM_Encode(const TLM_Msg_t *msg, uint8_t *buf, size_t cap)
+{
+    CBOR_Writer_t w;
+    uint32_t pairs = 4U;    /* version, kind, drive, axis */
+
+    if (msg->has & TLM_HAS_SEQ)
+        pairs += 3U;
+    if (msg->has & TLM_HAS_CONNECTED)
+        pairs++;
+    if (msg->has & TLM_HAS_FAULTS)
+        pairs++;
+    pairs += (uint32_t)__builtin_popcount(msg->meta_present);
+    pairs += (uint32_t)__builtin_popcount(msg->present);
+
+    CBOR_WriterInit(&w, buf, cap);
+    CBOR_Map(&w, pairs);
+
+    CBOR_Uint(&w, TLM_KEY_VERSION);  CBOR_Uint(&w, TLM_VERSION);
+    CBOR_Uint(&w, TLM_KEY_KIND);     CBOR_Uint(&w, msg->kind);
+    CBOR_Uint(&w, TLM_KEY_DRIVE);    CBOR_Text(&w, msg->drive);
+    CBOR_Uint(&w, TLM_KEY_AXIS);     CBOR_Uint(&w, msg->axis);
+
+    if (msg->has & TLM_HAS_SEQ)
+    {
+        CBOR_Uint(&w, TLM_KEY_SEQ);      CBOR_Uint(&w, msg->seq);
+        CBOR_Uint(&w, TLM_KEY_KEYFRAME); CBOR_Bool(&w, msg->keyframe);
+        CBOR_Uint(&w, TLM_KEY_CHANGED);  CBOR_Uint(&w, msg->changed);
+    }
+    if (msg->has & TLM_HAS_CONNECTED)
+    {
+        CBOR_Uint(&w, TLM_KEY_CONNECTED);
+        CBOR_Bool(&w, msg->connected);
+    }
+    if (msg->has & TLM_HAS_FAULTS)
+    {
+        CBOR_Uint(&w, TLM_KEY_FAULTS);
+        CBOR_Uint(&w, msg->faults);
+    }
+
+    for (uint32_t todo = msg->meta_present; todo; todo &= todo - 1U)
+    {
+        int m = __builtin_ctz(todo);
+        CBOR_Uint(&w, TLM_KEY_META + (unsigned)m);
+        CBOR_Number(&w, msg->meta[m]);
+    }
+    for (uint32_t todo = msg->present; todo; todo &= todo - 1U)
+    {
+        int s = __builtin_ctz(todo);
+        CBOR_Uint(&w, TLM_KEY_SIGNAL + (unsigned)s);
+        CBOR_Number(&w, msg->values[s]);
+    }
+
+    return w.overflow ? 0U : w.len;
+}
+
+size_t TLM_EncodeBatch(const TLM_Batch_t *b, uint8_t *buf, size_t cap)
+{
+    CBOR_Writer_t w;
+    uint8_t  count = (b->count < TLM_BATCH_MAX) ? b->count : TLM_BATCH_MAX;
+    uint32_t pairs = 7U;    /* version, kind, drive, axis, seq, t0, dt */
+
+    pairs += (uint32_t)__builtin_popcount(b->present);
+
+    CBOR_WriterInit(&w, buf, cap);
+    CBOR_Map(&w, pairs);
+
+    CBOR_Uint(&w, TLM_KEY_VERSION);  CBOR_Uint(&w, TLM_VERSION);
+    CBOR_Uint(&w, TLM_KEY_KIND);     CBOR_Uint(&w, TLM_KIND_BATCH);
+    CBOR_Uint(&w, TLM_KEY_DRIVE);    CBOR_Text(&w, b->drive);
+    CBOR_Uint(&w, TLM_KEY_AXIS);     CBOR_Uint(&w, b->axis);
+    CBOR_Uint(&w, TLM_KEY_SEQ);      CBOR_Uint(&w, b->seq);
+    CBOR_Uint(&w, TLM_KEY_T0);       CBOR_Uint(&w, b->t0_us);
+
+    CBOR_Uint(&w, TLM_KEY_DT);
+    CBOR_Array(&w, count);
+    for (uint8_t i = 0; i < count; i++)
+        CBOR_Uint(&w, b->dt_us[i]);
+
+    for (uint32_t todo = b->present; todo; todo &= todo - 1U)
+    {
+        int s = __builtin_ctz(todo);
+        CBOR_Uint(&w, TLM_KEY_SIGNAL + (unsigned)s);
+        CBOR_Array(&w, count);
+        for (uint8_t i = 0; i < count; i++)
+        {
+            if (isnan(b->values[s][i]))
+                CBOR_Null(&w);
+            else
+                CBOR_Number(&w, b->values[s][i]);
+        }
+    }
+
+    return w.overflow ? 0U : w.len;
+}
+
+/*----------------------------------------------------------
+ * Decode (WCS side)
+ *----------------------------------------------------------*/
+static int TLM_Number(const CBOR_Item_t *it, double *v)
+{
+    switch (it->type)
+    {
+        case CBOR_UINT:   *v = (double)it->u;              return 0;
+        case CBOR_NEGINT: *v = -1.0 - (double)it->u;       return 0;
+        case CBOR_FLOAT:  *v = it->f;                      return 0;
+        case CBOR_BOOL:   *v = (double)it->u;              return 0;
+        default:                                           return -1;
+    }
+}
+
+int TLM_Decode(const uint8_t *buf, size_t len, TLM_Msg_t *msg)
+{
+    CBOR_Reader_t r;
+    CBOR_Item_t   it;
+
+    memset(msg, 0, sizeof(*msg));
+    CBOR_ReaderInit(&r, buf, len);
+
+    if (CBOR_Next(&r, &it) != 0 || it.type != CBOR_MAP)
+        return -1;
+
+    for (uint64_t pairs = it.u; pairs > 0; pairs--)
+    {
+        CBOR_Item_t key;
+        double      v = 0.0;
+
+        if (CBOR_Next(&r, &key) != 0 || key.type != CBOR_UINT)
+            return -1;
+
+        /* drive name is the only text value */
+        if (key.u == TLM_KEY_DRIVE)
+        {
+            if (CBOR_Next(&r, &it) != 0 || it.type != CBOR_TEXT)
+                return -1;
+            size_t n = (it.u < TLM_NAME_LEN) ? (size_t)it.u : TLM_NAME_LEN - 1U;
+            memcpy(msg->drive, it.text, n);
+            msg->drive[n] = '\0';
+            continue;
+        }
+
+        size_t at = r.pos;
+        if (CBOR_Next(&r, &it) != 0)
+            return -1;
+        if (TLM_Number(&it, &v) != 0)
+        {
+            /* a structured value under a key this side does not know */
+            r.pos = at;
+            if (CBOR_Skip(&r) != 0)
+                return -1;
+            continue;
+        }
+
+        if (key.u >= TLM_KEY_SIGNAL)
+        {
+            uint64_t s = key.u - TLM_KEY_SIGNAL;
+            if (s < SIG_COUNT)
+            {
+                msg->values[s] = v;
+                msg->present  |= (uint32_t)SIG_MASK(s);
+            }
+            continue;
+        }
+        if (key.u >= TLM_KEY_META)
+        {
+            uint64_t m = key.u - TLM_KEY_META;
+            if (m < TLM_META_COUNT)
+            {
+                msg->meta[m]        = v;
+                msg->meta_present  |= 1U << m;
+            }
+            continue;
+        }
+
+        switch (key.u)
+        {
+            case TLM_KEY_VERSION:   msg->version   = (uint8_t)v;   break;
+            case TLM_KEY_KIND:      msg->kind      = (uint8_t)v;   break;
+            case TLM_KEY_AXIS:      msg->axis      = (uint8_t)v;   break;
+            case TLM_KEY_SEQ:       msg->seq       = (uint32_t)v;
+                                    msg->has      |= TLM_HAS_SEQ;  break;
+            case TLM_KEY_KEYFRAME:  msg->keyframe  = (uint8_t)v;   break;
+            case TLM_KEY_CHANGED:   msg->changed   = (uint32_t)v;  break;
+            case TLM_KEY_CONNECTED: msg->connected = (uint8_t)v;
+                                    msg->has      |= TLM_HAS_CONNECTED; break;
+            case TLM_KEY_FAULTS:    msg->faults    = (uint16_t)v;
+                                    msg->has      |= TLM_HAS_FAULTS;    break;
+            default:                                               break;
+        }
+    }
+    return 0;
+}
+
+/* Array of 'n' numbers or nulls (NaN) */
+static int TLM_Column(CBOR_Reader_t *r, uint64_t n, double *out, uint32_t *dt)
+{
+    CBOR_Item_t it;
+
+    for (uint64_t i = 0; i < n; i++)
+    {
+        double v;
+
+        if (CBOR_Next(r, &it) != 0)
+            return -1;
+        if (dt)
+        {
+            if (it.type != CBOR_UINT || it.u > UINT32_MAX)
+                return -1;
+            dt[i] = (uint32_t)it.u;
+        }
+        else if (it.type == CBOR_NULL)
+            out[i] = NAN;
+        else if (TLM_Number(&it, &v) == 0)
+            out[i] = v;
+        else
+            return -1;
+    }
+    return 0;
+}
+
+int TLM_DecodeBatch(const uint8_t *buf, size_t len, TLM_Batch_t *b)
+{
+    CBOR_Reader_t r;
+    CBOR_Item_t   it;
+    int           columns = -1;     /* length every column must have */
+
+    memset(b, 0, sizeof(*b));
+    CBOR_ReaderInit(&r, buf, len);
+
+    if (CBOR_Next(&r, &it) != 0 || it.type != CBOR_MAP)
+        return -1;
+
+    uint8_t kind = 0xFFU;
+    for (uint64_t pairs = it.u; pairs > 0; pairs--)
+    {
+        CBOR_Item_t key;
+        double      v = 0.0;
+
+        if (CBOR_Next(&r, &key) != 0 || key.type != CBOR_UINT)
+            return -1;
+
+        size_t at = r.pos;
+        if (CBOR_Next(&r, &it) != 0)
+            return -1;
+
+        if (key.u == TLM_KEY_DRIVE && it.type == CBOR_TEXT)
+        {
+            size_t n = (it.u < TLM_NAME_LEN) ? (size_t)it.u : TLM_NAME_LEN - 1U;
+            memcpy(b->drive, it.text, n);
+            b->drive[n] = '\0';
+            continue;
+        }
+
+        if (it.type == CBOR_ARRAY &&
+            (key.u == TLM_KEY_DT ||
+             (key.u >= TLM_KEY_SIGNAL && key.u - TLM_KEY_SIGNAL < SIG_COUNT)))
+        {
+            if (it.u > TLM_BATCH_MAX || (columns >= 0 && it.u != (uint64_t)columns))
+                return -1;
+            columns = (int)it.u;
+
+            if (key.u == TLM_KEY_DT)
+            {
+                if (TLM_Column(&r, it.u, NULL, b->dt_us) != 0)
+                    return -1;
+                continue;
+            }
+
+            uint64_t s = key.u - TLM_KEY_SIGNAL;
+            if (TLM_Column(&r, it.u, b->values[s], NULL) != 0)
+                return -1;
+            b->present |= (uint32_t)SIG_MASK(s);
+            continue;
+        }
+
+        if (TLM_Number(&it, &v) != 0)
+        {
+            /* a structured value under a key this side does not know */
+            r.pos = at;
+            if (CBOR_Skip(&r) != 0)
+                return -1;
+            continue;
+        }
+
+        switch (key.u)
+        {
+            case TLM_KEY_VERSION: b->version = (uint8_t)v;  break;
+            case TLM_KEY_KIND:    kind       = (uint8_t)v;  break;
+            case TLM_KEY_AXIS:    b->axis    = (uint8_t)v;  break;
+            case TLM_KEY_SEQ:     b->seq     = (uint32_t)v; break;
+            case TLM_KEY_T0:      b->t0_us   = (it.type == CBOR_UINT) ? it.u : 0U;
+                                  break;
+            default:                                        break;
+        }
+    }
+
+    if (kind != TLM_KIND_BATCH || columns < 0)
+        return -1;
+    b->count = (uint8_t)columns;
+    return 0;
+}
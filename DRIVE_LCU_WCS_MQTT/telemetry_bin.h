@@ -0,0 +1,182 @@
+#ifndef TELEMETRY_BIN_H
+#define TELEMETRY_BIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "read_planner.h"
+
+/*===========================================================
+ * Binary telemetry (CBOR with integer keys)
+ *
+ * Continuous and periodic telemetry can also go out as one CBOR
+ * map per message on [MQTT] MQTT_TOPIC_TELEMETRY_CBOR; a WCS picks
+ * the encoding by the topic it subscribes to ([TELEMETRY]
+ * ENCODING says which topics are fed). Keys are small integers
+ * instead of names, so most keys and values take one byte:
+ *
+ *   TLM_KEY_*                     envelope and status
+ *   TLM_KEY_META  + TLM_META_*    link / cycle counters (periodic)
+ *   TLM_KEY_SIGNAL + Signal_t     feedback values
+ *
+ * Keys are only ever added; a decoder skips keys it does not
+ * know, so an older WCS keeps working when fields are added.
+ * TLM_VERSION changes only if the meaning of a key changes.
+ * The Python subscriber (mqtt_test.py) carries a copy of this
+ * key map and of the meta, fault and signal names, and warns at
+ * start-up when it no longer matches these sources: change both.
+ *
+ * Both sides share TLM_Msg_t: the LCU fills it and calls
+ * TLM_Encode, the WCS calls TLM_Decode (this file and cbor.c
+ * need nothing else from the LCU).
+ *
+ * In batch mode ([TELEMETRY] BATCH_SAMPLES) continuous samples
+ * of one axis go out together as a TLM_Batch_t: the same map,
+ * but each signal key holds an array with one value per sample
+ * (null where that read failed) and TLM_KEY_DT the sample times.
+ * TLM_Decode skips those arrays, so a batch never passes for a
+ * single sample.
+ *===========================================================*/
+#define TLM_VERSION     1U
+#define TLM_NAME_LEN    32U
+#define TLM_MAX_BYTES   256U    /* worst case of one encoded message */
+
+#define TLM_BATCH_MAX        32U    /* samples per batch */
+#define TLM_BATCH_MAX_BYTES  2560U  /* worst case: every signal, full batch */
+
+typedef enum
+{
+    TLM_KIND_ONCE = 0,
+    TLM_KIND_PERIODIC,
+    TLM_KIND_CONTINUOUS,
+    TLM_KIND_BATCH
+} TLM_Kind_t;
+
+typedef enum
+{
+    TLM_KEY_VERSION   = 0,
+    TLM_KEY_KIND      = 1,
+    TLM_KEY_DRIVE     = 2,
+    TLM_KEY_AXIS      = 3,
+    TLM_KEY_SEQ       = 4,      /* change-only mode */
+    TLM_KEY_KEYFRAME  = 5,
+    TLM_KEY_CHANGED   = 6,      /* SIG_MASK() of fields that moved */
+    TLM_KEY_CONNECTED = 7,
+    TLM_KEY_FAULTS    = 8,      /* TLM_FAULT_* bits */
+    TLM_KEY_T0        = 9,      /* batch: first sample time, us */
+    TLM_KEY_DT        = 10,     /* batch: sample times after T0, us */
+    TLM_KEY_META      = 16,
+    TLM_KEY_SIGNAL    = 32
+} TLM_Key_t;
+
+typedef enum
+{
+    TLM_META_CYCLES = 0,
+    TLM_META_SYSCALLS_PER_CYCLE,
+    TLM_META_FRAMES_PER_CYCLE,
+    TLM_META_SRTT_US,
+    TLM_META_RTTVAR_US,
+    TLM_META_RTO_US,
+    TLM_META_RETRIES,
+    TLM_META_RECOVERED,
+    TLM_META_TIMEOUTS,
+    TLM_META_SHADOW_HITS,
+    TLM_META_SHADOW_MISSES,
+    TLM_META_BATCH_DROPS,
+    TLM_META_JSON_DROPS,
+    TLM_META_COUNT
+} TLM_Meta_t;
+
+/* FaultStatus_t flags, in declaration order */
+typedef enum
+{
+    TLM_FAULT_SHORT_CIRCUIT = 0,
+    TLM_FAULT_SYSTEM_OK,
+    TLM_FAULT_RATED_CURRENT,
+    TLM_FAULT_OVER_TEMP,
+    TLM_FAULT_OVER_VOLT,
+    TLM_FAULT_UNDER_VOLT,
+    TLM_FAULT_MOTION_ERROR,
+    TLM_FAULT_DRIVE_DISABLE,
+    TLM_FAULT_EEPROM_ERROR,
+    TLM_FAULT_COMMUTATION_ERR,
+    TLM_FAULT_LOCK_ROTOR,
+    TLM_FAULT_EMERGENCY_ERR,
+    TLM_FAULT_COMMAND_ERROR,
+    TLM_FAULT_MOTION_COMPLETE,
+    TLM_FAULT_COUNT
+} TLM_Fault_t;
+
+#define TLM_HAS_SEQ        0x01U
+#define TLM_HAS_CONNECTED  0x02U
+#define TLM_HAS_FAULTS     0x04U
+
+/**
+ * @brief One telemetry message, encoding-independent
+ */
+typedef struct
+{
+    uint8_t  version;               /**< Set by TLM_Decode               */
+    uint8_t  kind;                  /**< TLM_Kind_t                      */
+    uint8_t  axis;
+    uint8_t  has;                   /**< TLM_HAS_* of the fields below   */
+    char     drive[TLM_NAME_LEN];
+
+    uint32_t seq;                   /**< TLM_HAS_SEQ                     */
+    uint8_t  keyframe;              /**< TLM_HAS_SEQ                     */
+    uint32_t changed;               /**< TLM_HAS_SEQ, SIG_MASK() set     */
+    uint8_t  connected;             /**< TLM_HAS_CONNECTED               */
+    uint16_t faults;                /**< TLM_HAS_FAULTS, TLM_FAULT_* bits */
+
+    uint32_t meta_present;          /**< Bit per TLM_Meta_t              */
+    double   meta[TLM_META_COUNT];
+    uint32_t present;               /**< SIG_MASK() of values[] sent     */
+    double   values[SIG_COUNT];     /**< Indexed by Signal_t             */
+} TLM_Msg_t;
+
+/**
+ * @brief Continuous samples of one axis, as columns
+ *
+ * Sample i was read at t0_us + dt_us[i] (acquisition thread's
+ * monotonic clock). values[sig][i] is NaN where that read failed.
+ */
+typedef struct
+{
+    uint8_t  version;               /**< Set by TLM_DecodeBatch          */
+    uint8_t  axis;
+    uint8_t  count;                 /**< Samples, at most TLM_BATCH_MAX  */
+    char     drive[TLM_NAME_LEN];
+    uint32_t seq;                   /**< Batches sent for this axis      */
+    uint64_t t0_us;
+    uint32_t dt_us[TLM_BATCH_MAX];
+    uint32_t present;               /**< SIG_MASK() of columns sent      */
+    double   values[SIG_COUNT][TLM_BATCH_MAX];
+} TLM_Batch_t;
+
+/**
+ * @brief  Encode a message as one CBOR map
+ * @return Bytes written, 0 if 'cap' was too small
+ */
+size_t TLM_Encode(const TLM_Msg_t *msg, uint8_t *buf, size_t cap);
+
+/**
+ * @brief  Decode one CBOR message; unknown keys are skipped
+ * @return 0 on success, -1 on malformed input
+ */
+int TLM_Decode(const uint8_t *buf, size_t len, TLM_Msg_t *msg);
+
+/**
+ * @brief  Encode / decode a batch (TLM_KIND_BATCH)
+ * @return As TLM_Encode / TLM_Decode; TLM_DecodeBatch also fails
+ *         on a message that is not a batch or on ragged columns
+ */
+size_t TLM_EncodeBatch(const TLM_Batch_t *b, uint8_t *buf, size_t cap);
+int    TLM_DecodeBatch(const uint8_t *buf, size_t len, TLM_Batch_t *b);
+
+/**
+ * @brief  JSON key of a meta counter / fault flag (as in the
+ *         text telemetry), NULL when out of range
+ */
+const char *TLM_MetaName(TLM_Meta_t m);
+const char *TLM_FaultName(TLM_Fault_t f);
+
+#endif /* TELEMETRY_BIN_H */